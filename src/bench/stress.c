@@ -0,0 +1,783 @@
+// src/bench/stress.c
+// Scaling stress harness: spawns real processes, threads and fork/exit
+// churn on the local machine and measures what a collection costs as the
+// load grows. Prints one JSON object per step (JSON Lines) to stdout.
+#include "../core/process.h"
+#include "../core/system.h"
+#include "../util/util.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/ptrace.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef TOPLITE_VERSION
+#define TOPLITE_VERSION "unknown"
+#endif
+
+// Most steps (--procs entries) and frames per step
+#define STRESS_MAX_STEPS 32
+#define STRESS_MAX_FRAMES 10000
+// Time the spawned processes get to settle before a step is measured
+#define STRESS_SETTLE_MS 200
+
+// Argument that turns the executable into one of the idle processes
+#define IDLE_CHILD_ARG "--idle-child"
+
+/**
+ * Holds the settings given on the command line.
+ */
+typedef struct {
+    unsigned steps[STRESS_MAX_STEPS]; // Idle processes per step
+    size_t step_count;                // Entries in steps
+    unsigned threads;                 // Threads per idle process
+    unsigned churn;                   // Short-lived processes per second
+    unsigned cmdline_len;             // Extra bytes of command line
+    unsigned frames;                  // Measured collections per step
+    unsigned fields;                  // Optional fields (proc_field_t)
+    proc_collector_t collector;       // How /proc/[pid] files are read
+    bool reads;                       // Compare status with statm + fstat
+} stress_options_t;
+
+/**
+ * The processes the harness started.
+ */
+typedef struct {
+    pid_t *pids;     // Idle processes
+    size_t count;    // Entries in pids
+    size_t capacity; // Allocated entries
+    pid_t churner;   // Process that forks the short-lived ones (-1: none)
+} stress_load_t;
+
+/**
+ * What one step measured.
+ */
+typedef struct {
+    size_t procs;        // Processes the collection saw
+    double wall_ms[4];   // min, p50, p95, max of the frame latency
+    double cpu_ms;       // Mean CPU time (user + system) per frame
+    long syscalls;       // System calls of one frame (-1: unknown)
+    long rss_kib;        // Resident memory after the step
+    long hwm_kib;        // Peak resident memory so far
+} stress_result_t;
+
+/**
+ * What one step of --reads measured.
+ */
+typedef struct {
+    size_t pids;      // Processes read per round
+    double status_us; // Mean time per process: status + fgets/sscanf
+    double statm_us;  // Mean time per process: fstat(dir) + statm
+} reads_result_t;
+
+static void print_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --procs N[,N...]    idle processes to measure with, one step\n"
+            "                      per entry (default 0,250,500,1000)\n"
+            "  --threads N         threads per idle process (default 1)\n"
+            "  --churn N           processes forked and reaped per second\n"
+            "                      while measuring (default 0)\n"
+            "  --cmdline-len N     bytes added to the command line of every\n"
+            "                      idle process (default 0)\n"
+            "  --frames N          collections measured per step (default\n"
+            "                      20)\n"
+            "  --collector sync|io_uring\n"
+            "                      how /proc/[pid] is read (default sync)\n"
+            "  --io                also read /proc/[pid]/io\n"
+            "  --details           also read user names and command lines\n"
+            "  --reads             instead of collecting, time reading the\n"
+            "                      owner and memory sizes of every process\n"
+            "                      from status and from fstat + statm\n"
+            "  -h, --help          show this help\n"
+            "\n"
+            "Prints one JSON object per step to stdout.\n",
+            prog);
+}
+
+/**
+ * Parses a non-negative integer.
+ *
+ * @return 0 on success, -1 on conversion errors or negative input.
+ */
+static int parse_count(const char *s, unsigned *out) {
+    char *endptr;
+    long val = strtol(s, &endptr, 10);
+    if (endptr == s || *endptr != '\0' || val < 0) {
+        return -1;
+    }
+    *out = (unsigned)val;
+    return 0;
+}
+
+/**
+ * Parses a comma separated list of counts.
+ *
+ * @return 0 on success, -1 on errors.
+ */
+static int parse_steps(char *s, stress_options_t *opts) {
+    opts->step_count = 0;
+    char *save, *tok = strtok_r(s, ",", &save);
+    while (tok) {
+        if (opts->step_count == STRESS_MAX_STEPS ||
+            parse_count(tok, &opts->steps[opts->step_count]) != 0) {
+            return -1;
+        }
+        opts->step_count++;
+        tok = strtok_r(NULL, ",", &save);
+    }
+    return opts->step_count > 0 ? 0 : -1;
+}
+
+static int parse_stress_options(int argc, char **argv,
+                                stress_options_t *opts) {
+    enum {
+        OPT_PROCS = 256,
+        OPT_THREADS,
+        OPT_CHURN,
+        OPT_CMDLINE_LEN,
+        OPT_FRAMES,
+        OPT_COLLECTOR,
+        OPT_IO,
+        OPT_DETAILS,
+        OPT_READS,
+    };
+    static const struct option long_opts[] = {
+        {"procs", required_argument, NULL, OPT_PROCS},
+        {"threads", required_argument, NULL, OPT_THREADS},
+        {"churn", required_argument, NULL, OPT_CHURN},
+        {"cmdline-len", required_argument, NULL, OPT_CMDLINE_LEN},
+        {"frames", required_argument, NULL, OPT_FRAMES},
+        {"collector", required_argument, NULL, OPT_COLLECTOR},
+        {"io", no_argument, NULL, OPT_IO},
+        {"details", no_argument, NULL, OPT_DETAILS},
+        {"reads", no_argument, NULL, OPT_READS},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    static const unsigned default_steps[] = {0, 250, 500, 1000};
+    memcpy(opts->steps, default_steps, sizeof(default_steps));
+    opts->step_count = sizeof(default_steps) / sizeof(default_steps[0]);
+    opts->threads = 1;
+    opts->churn = 0;
+    opts->cmdline_len = 0;
+    opts->frames = 20;
+    opts->fields = 0;
+    opts->collector = PROC_COLLECTOR_SYNC;
+    opts->reads = false;
+
+    int c;
+    while ((c = getopt_long(argc, argv, "h", long_opts, NULL)) != -1) {
+        int err = 0;
+        switch (c) {
+        case OPT_PROCS:
+            err = parse_steps(optarg, opts);
+            break;
+        case OPT_THREADS:
+            err = parse_count(optarg, &opts->threads) != 0 ||
+                  opts->threads == 0;
+            break;
+        case OPT_CHURN:
+            err = parse_count(optarg, &opts->churn);
+            break;
+        case OPT_CMDLINE_LEN:
+            err = parse_count(optarg, &opts->cmdline_len);
+            break;
+        case OPT_FRAMES:
+            err = parse_count(optarg, &opts->frames) != 0 ||
+                  opts->frames == 0 || opts->frames > STRESS_MAX_FRAMES;
+            break;
+        case OPT_COLLECTOR:
+            if (strcmp(optarg, "sync") == 0) {
+                opts->collector = PROC_COLLECTOR_SYNC;
+            } else if (strcmp(optarg, "io_uring") == 0) {
+                opts->collector = PROC_COLLECTOR_URING;
+            } else {
+                err = 1;
+            }
+            break;
+        case OPT_IO:
+            opts->fields |= PROC_FIELD_IO;
+            break;
+        case OPT_DETAILS:
+            opts->fields |= PROC_FIELD_DETAILS;
+            break;
+        case OPT_READS:
+            opts->reads = true;
+            break;
+        case 'h':
+        default:
+            err = 1;
+            break;
+        }
+        if (err) {
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+    if (optind < argc) {
+        print_usage(argv[0]);
+        return -1;
+    }
+    return 0;
+}
+
+static void *idle_thread(void *arg) {
+    (void)arg;
+    while (true) {
+        pause();
+    }
+    return NULL;
+}
+
+/**
+ * Body of an idle process: starts its threads, reports that it is ready
+ * and sleeps until it is killed.
+ * argv: IDLE_CHILD_ARG THREADS READY_FD [PADDING]
+ */
+static int idle_child_main(int argc, char **argv) {
+    if (argc < 4) {
+        return 1;
+    }
+    unsigned threads = (unsigned)strtoul(argv[2], NULL, 10);
+    int ready_fd = (int)strtol(argv[3], NULL, 10);
+    for (unsigned i = 1; i < threads; i++) {
+        pthread_t t;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize(&attr, 64 * 1024); // They only sleep
+        if (pthread_create(&t, &attr, idle_thread, NULL) != 0) {
+            return 1;
+        }
+        pthread_attr_destroy(&attr);
+    }
+    if (write(ready_fd, "x", 1) != 1) {
+        return 1;
+    }
+    close(ready_fd);
+    while (true) {
+        pause();
+    }
+}
+
+/**
+ * Body of the churner: forks and reaps a process 'rate' times a second.
+ */
+static void churn_main(unsigned rate) {
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    long step_ns = 1000000000L / rate;
+    while (true) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            _exit(0);
+        }
+        if (pid > 0) {
+            waitpid(pid, NULL, 0);
+        }
+        next.tv_nsec += step_ns;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+}
+
+/**
+ * Starts idle processes until there are 'count' of them, or stops the
+ * newest ones if there are more.
+ *
+ * @return 0 on success, -1 if a process could not be started.
+ */
+static int resize_load(stress_load_t *load, size_t count,
+                       const stress_options_t *opts, const char *padding) {
+    while (load->count > count) {
+        pid_t pid = load->pids[--load->count];
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+    }
+    if (load->count == count) {
+        return 0;
+    }
+
+    if (count > load->capacity) {
+        pid_t *pids = realloc(load->pids, count * sizeof(pid_t));
+        if (!pids) {
+            perror("Failed to allocate memory for the load");
+            return -1;
+        }
+        load->pids = pids;
+        load->capacity = count;
+    }
+
+    int ready[2];
+    if (pipe(ready) != 0) {
+        perror("pipe");
+        return -1;
+    }
+    char threads[16], fd[16];
+    snprintf(threads, sizeof(threads), "%u", opts->threads);
+    snprintf(fd, sizeof(fd), "%d", ready[1]);
+    char *child_argv[] = {"toplite-stress", IDLE_CHILD_ARG, threads, fd,
+                          (char *)padding, NULL};
+
+    size_t started = 0;
+    while (load->count < count) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(ready[0]);
+            prctl(PR_SET_PDEATHSIG, SIGKILL); // Don't outlive the harness
+            execv("/proc/self/exe", child_argv);
+            _exit(127);
+        }
+        if (pid < 0) {
+            perror("fork");
+            break;
+        }
+        load->pids[load->count++] = pid;
+        started++;
+    }
+    close(ready[1]);
+
+    // Every process writes one byte once its threads run
+    size_t ready_count = 0;
+    char buf[256];
+    while (ready_count < started) {
+        ssize_t n = read(ready[0], buf, sizeof(buf));
+        if (n <= 0) {
+            break; // A child failed (EOF once all of them closed the pipe)
+        }
+        ready_count += (size_t)n;
+    }
+    close(ready[0]);
+    if (load->count < count || ready_count < started) {
+        fprintf(stderr, "Only %zu of %zu processes started.\n",
+                load->count - (started - ready_count), count);
+        return -1;
+    }
+    return 0;
+}
+
+static int start_churn(stress_load_t *load, unsigned rate) {
+    load->churner = -1;
+    if (rate == 0) {
+        return 0;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        churn_main(rate);
+        _exit(0);
+    }
+    if (pid < 0) {
+        perror("fork");
+        return -1;
+    }
+    load->churner = pid;
+    return 0;
+}
+
+static void stop_load(stress_load_t *load) {
+    if (load->churner > 0) {
+        kill(load->churner, SIGKILL);
+        waitpid(load->churner, NULL, 0);
+        load->churner = -1;
+    }
+    while (load->count > 0) {
+        pid_t pid = load->pids[--load->count];
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+    }
+    free(load->pids);
+    load->pids = NULL;
+    load->capacity = 0;
+}
+
+static double cpu_seconds(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (double)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+           (double)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+/**
+ * Reads a "Name: N kB" line of /proc/self/status.
+ */
+static long self_status_kib(const char *name) {
+    char *buf;
+    if (!read_text_file("/proc/self/status", &buf, NULL)) {
+        return -1;
+    }
+    long value = -1;
+    size_t len = strlen(name);
+    for (char *line = buf; line; line = strchr(line, '\n')) {
+        line += line != buf; // Skip the newline
+        if (strncmp(line, name, len) == 0 && line[len] == ':') {
+            value = strtol(line + len + 1, NULL, 10);
+            break;
+        }
+    }
+    free(buf);
+    return value;
+}
+
+/**
+ * Runs a forked copy of the harness (with the same per-process state) under
+ * ptrace and counts the system call stops between two SIGSTOPs, with or
+ * without a collection in between.
+ *
+ * @return The number of stops, or -1 if ptrace is not permitted.
+ */
+static long traced_stops(proc_list_t *list, unsigned long long mem_total,
+                         bool collect) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (ptrace(PTRACE_TRACEME, 0, NULL, NULL) != 0) {
+            _exit(1);
+        }
+        raise(SIGSTOP);
+        if (collect && collect_all_processes(list, mem_total) != 0) {
+            _exit(1); // Reported as unknown
+        }
+        raise(SIGSTOP);
+        _exit(0);
+    }
+    if (pid < 0) {
+        return -1;
+    }
+
+    int status;
+    if (waitpid(pid, &status, 0) != pid || !WIFSTOPPED(status)) {
+        return -1; // PTRACE_TRACEME failed
+    }
+    ptrace(PTRACE_SETOPTIONS, pid, NULL,
+           (void *)(PTRACE_O_TRACESYSGOOD | PTRACE_O_EXITKILL));
+
+    long stops = 0;
+    bool done = false;
+    ptrace(PTRACE_SYSCALL, pid, NULL, NULL);
+    while (waitpid(pid, &status, 0) == pid && WIFSTOPPED(status)) {
+        if (WSTOPSIG(status) == (SIGTRAP | 0x80)) {
+            stops++;
+        } else if (WSTOPSIG(status) == SIGSTOP) {
+            done = true;
+            break;
+        }
+        ptrace(PTRACE_SYSCALL, pid, NULL, NULL);
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+    return done ? stops : -1;
+}
+
+/**
+ * Counts the system calls of one collection. Tracing runs apart from the
+ * timed frames, so it doesn't slow them down. System calls io_uring runs
+ * on the process's behalf are not counted.
+ *
+ * @return The number of system calls, or -1 if ptrace is not permitted.
+ */
+static long count_syscalls(proc_list_t *list, unsigned long long mem_total) {
+    long with = traced_stops(list, mem_total, true);
+    long without = traced_stops(list, mem_total, false);
+    if (with < 0 || without < 0) {
+        return -1;
+    }
+    // Every system call stops twice, on entry and on exit; raise() is
+    // counted by both runs
+    return (with - without) / 2;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double da = *(const double *)a, db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+/**
+ * Measures 'frames' collections of the current load.
+ *
+ * @return 0 on success, -1 if a collection fails.
+ */
+static int measure_step(const stress_options_t *opts, proc_list_t *list,
+                        unsigned long long mem_total, stress_result_t *out) {
+    static double wall[STRESS_MAX_FRAMES];
+
+    // The first collection creates the per-process state
+    if (collect_all_processes(list, mem_total) != 0) {
+        return -1;
+    }
+
+    double cpu = cpu_seconds();
+    for (unsigned i = 0; i < opts->frames; i++) {
+        double start = monotonic_seconds();
+        if (collect_all_processes(list, mem_total) != 0) {
+            return -1;
+        }
+        wall[i] = (monotonic_seconds() - start) * 1000.0;
+    }
+    out->cpu_ms = (cpu_seconds() - cpu) * 1000.0 / opts->frames;
+    out->procs = list->count;
+
+    qsort(wall, opts->frames, sizeof(double), compare_double);
+    out->wall_ms[0] = wall[0];
+    out->wall_ms[1] = wall[(opts->frames - 1) / 2];
+    out->wall_ms[2] = wall[(opts->frames - 1) * 95 / 100];
+    out->wall_ms[3] = wall[opts->frames - 1];
+
+    out->syscalls = count_syscalls(list, mem_total);
+    out->rss_kib = self_status_kib("VmRSS");
+    out->hwm_kib = self_status_kib("VmHWM");
+    return 0;
+}
+
+static void print_result(const stress_options_t *opts, unsigned idle,
+                         const stress_result_t *r) {
+    printf("{\"version\":\"%s\",\"collector\":\"%s\",\"io\":%s,"
+           "\"details\":%s,",
+           TOPLITE_VERSION, process_collector_name(),
+           (opts->fields & PROC_FIELD_IO) ? "true" : "false",
+           (opts->fields & PROC_FIELD_DETAILS) ? "true" : "false");
+    printf("\"idle_procs\":%u,\"threads\":%u,\"churn\":%u,"
+           "\"cmdline_len\":%u,\"procs\":%zu,\"frames\":%u,",
+           idle, opts->threads, opts->churn, opts->cmdline_len, r->procs,
+           opts->frames);
+    printf("\"wall_ms\":{\"min\":%.3f,\"p50\":%.3f,\"p95\":%.3f,"
+           "\"max\":%.3f},\"cpu_ms\":%.3f,",
+           r->wall_ms[0], r->wall_ms[1], r->wall_ms[2], r->wall_ms[3],
+           r->cpu_ms);
+    if (r->syscalls >= 0) {
+        printf("\"syscalls\":%ld,", r->syscalls);
+    } else {
+        printf("\"syscalls\":null,");
+    }
+    printf("\"rss_kib\":%ld,\"hwm_kib\":%ld}\n", r->rss_kib, r->hwm_kib);
+    fflush(stdout);
+}
+
+/**
+ * Lists the processes in /proc.
+ *
+ * @return The number of entries in *out, or -1 on failure.
+ */
+static long list_pids(pid_t **out) {
+    DIR *dir = opendir("/proc");
+    if (!dir) {
+        perror("Failed to open /proc");
+        return -1;
+    }
+    pid_t *pids = NULL;
+    size_t count = 0, capacity = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir))) {
+        if (entry->d_name[0] < '1' || entry->d_name[0] > '9') {
+            continue;
+        }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            pid_t *grown = realloc(pids, capacity * sizeof(pid_t));
+            if (!grown) {
+                perror("Failed to allocate memory for the process list");
+                free(pids);
+                closedir(dir);
+                return -1;
+            }
+            pids = grown;
+        }
+        pids[count++] = (pid_t)strtol(entry->d_name, NULL, 10);
+    }
+    closedir(dir);
+    *out = pids;
+    return (long)count;
+}
+
+/**
+ * Reads the owner and memory sizes of a process from /proc/[pid]/status,
+ * line by line.
+ *
+ * @return The sum of the values, so the work can't be dropped.
+ */
+static unsigned long read_from_status(pid_t pid) {
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%d/status", pid);
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return 0;
+    }
+    unsigned uid = 0;
+    unsigned long virt = 0, res = 0, shr = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "Uid:\t%u", &uid) == 1) {
+        } else if (sscanf(line, "VmSize:\t%lu kB", &virt) == 1) {
+        } else if (sscanf(line, "VmRSS:\t%lu kB", &res) == 1) {
+        } else if (sscanf(line, "RssShmem:\t%lu kB", &shr) == 1) {
+        }
+    }
+    fclose(f);
+    return uid + virt + res + shr;
+}
+
+/**
+ * Reads the owner of a process with fstat() on /proc/[pid] and its memory
+ * sizes from /proc/[pid]/statm, the way collect_all_processes() does.
+ *
+ * @return The sum of the values, so the work can't be dropped.
+ */
+static unsigned long read_from_statm(pid_t pid) {
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%d", pid);
+    int dir_fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    unsigned long sum = fstat(dir_fd, &st) == 0 ? st.st_uid : 0;
+    int fd = openat(dir_fd, "statm", O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        char buf[128];
+        ssize_t n = read(fd, buf, sizeof(buf) - 1);
+        if (n > 0) {
+            buf[n] = '\0';
+            const char *p = buf;
+            for (int i = 0; i < 3; i++) {
+                sum += strtoull_safe(&p);
+            }
+        }
+        close(fd);
+    }
+    close(dir_fd);
+    return sum;
+}
+
+/**
+ * Times 'frames' rounds of each way of reading the owner and memory sizes
+ * over every process in /proc.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+static int measure_reads(const stress_options_t *opts, reads_result_t *out) {
+    pid_t *pids;
+    long count = list_pids(&pids);
+    if (count <= 0) {
+        return -1;
+    }
+
+    volatile unsigned long sink = 0;
+    double status_s = 0, statm_s = 0;
+    // Alternate the two, so neither gets a warmer cache than the other
+    for (unsigned i = 0; i < opts->frames; i++) {
+        double start = monotonic_seconds();
+        for (long n = 0; n < count; n++) {
+            sink += read_from_status(pids[n]);
+        }
+        double mid = monotonic_seconds();
+        for (long n = 0; n < count; n++) {
+            sink += read_from_statm(pids[n]);
+        }
+        statm_s += monotonic_seconds() - mid;
+        status_s += mid - start;
+    }
+    (void)sink;
+
+    double reads = (double)count * opts->frames;
+    out->pids = (size_t)count;
+    out->status_us = status_s * 1e6 / reads;
+    out->statm_us = statm_s * 1e6 / reads;
+    free(pids);
+    return 0;
+}
+
+static void print_reads(const stress_options_t *opts, unsigned idle,
+                        const reads_result_t *r) {
+    printf("{\"version\":\"%s\",\"mode\":\"reads\",\"idle_procs\":%u,"
+           "\"threads\":%u,\"churn\":%u,\"pids\":%zu,\"frames\":%u,",
+           TOPLITE_VERSION, idle, opts->threads, opts->churn, r->pids,
+           opts->frames);
+    printf("\"status_us\":%.2f,\"statm_us\":%.2f}\n", r->status_us,
+           r->statm_us);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], IDLE_CHILD_ARG) == 0) {
+        return idle_child_main(argc, argv);
+    }
+
+    stress_options_t opts;
+    if (parse_stress_options(argc, argv, &opts) != 0) {
+        return 1;
+    }
+    if (process_set_collector(opts.collector) != 0) {
+        fprintf(stderr, "io_uring is not available.\n");
+        return 1;
+    }
+    process_set_optional_fields(opts.fields);
+
+    mem_info_t mem;
+    if (read_meminfo(&mem) != 0) {
+        return 1;
+    }
+
+    char *padding = calloc(opts.cmdline_len + 1, 1);
+    if (!padding) {
+        perror("Failed to allocate memory for the command line");
+        return 1;
+    }
+    memset(padding, 'x', opts.cmdline_len);
+
+    stress_load_t load = {0};
+    if (start_churn(&load, opts.churn) != 0) {
+        free(padding);
+        return 1;
+    }
+
+    proc_list_t list;
+    init_process_list(&list);
+    int ret = 0;
+    for (size_t s = 0; s < opts.step_count; s++) {
+        fprintf(stderr, "Step %zu/%zu: %u idle processes\n", s + 1,
+                opts.step_count, opts.steps[s]);
+        if (resize_load(&load, opts.steps[s], &opts, padding) != 0) {
+            ret = 1;
+            break;
+        }
+        usleep(STRESS_SETTLE_MS * 1000);
+
+        if (opts.reads) {
+            reads_result_t reads;
+            if (measure_reads(&opts, &reads) != 0) {
+                ret = 1;
+                break;
+            }
+            print_reads(&opts, opts.steps[s], &reads);
+            continue;
+        }
+
+        stress_result_t result;
+        if (measure_step(&opts, &list, mem.mem_total, &result) != 0) {
+            fprintf(stderr, "Failed to collect the process list.\n");
+            ret = 1;
+            break;
+        }
+        print_result(&opts, opts.steps[s], &result);
+    }
+
+    stop_load(&load);
+    free_process_list(&list);
+    free(padding);
+    return ret;
+}
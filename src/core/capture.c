@@ -0,0 +1,297 @@
+// src/core/capture.c
+#include "capture.h"
+#include "../util/util.h"
+#include "proc_iter.h"
+#include "sorting.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * What one evaluation collected.
+ */
+typedef struct {
+    cpu_percent_t cpu;
+    mem_info_t mem;
+    load_avg_t ld;
+    task_counts_t tc;
+    proc_list_t procs;
+    bool have_procs; // procs is up to date
+} capture_sample_t;
+
+/**
+ * Collects what the rules need (and the system statistics, which are
+ * cheap).
+ *
+ * @return 0 on success, -1 if the process list could not be collected.
+ */
+static int collect_sample(const rule_set_t *set, capture_sample_t *s,
+                          cpu_times_t *prev_cpu) {
+    cpu_times_t now_cpu;
+    read_cpu_times(&now_cpu);
+    cpu_percent(prev_cpu, &now_cpu, &s->cpu);
+    *prev_cpu = now_cpu;
+    read_meminfo(&s->mem);
+    read_loadavg(&s->ld);
+    if (set->need_tasks) {
+        scan_task_states(&s->tc);
+    }
+    s->have_procs = false;
+    if (set->need_procs) {
+        if (collect_all_processes(&s->procs, s->mem.mem_total) != 0) {
+            return -1;
+        }
+        s->have_procs = true;
+    }
+    return 0;
+}
+
+/**
+ * Picks the file to write the next capture to: the first missing one, or
+ * else the oldest.
+ */
+static void next_capture_path(const capture_config_t *cfg, char *out,
+                              size_t size) {
+    unsigned slot = 0;
+    struct timespec oldest = {0};
+    for (unsigned i = 0; i < cfg->keep; i++) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/toplite-capture-%02u.txt", cfg->dir,
+                 i);
+        struct stat st;
+        if (stat(path, &st) != 0) {
+            slot = i;
+            break;
+        }
+        if (i == 0 || st.st_mtim.tv_sec < oldest.tv_sec ||
+            (st.st_mtim.tv_sec == oldest.tv_sec &&
+             st.st_mtim.tv_nsec < oldest.tv_nsec)) {
+            oldest = st.st_mtim;
+            slot = i;
+        }
+    }
+    snprintf(out, size, "%s/toplite-capture-%02u.txt", cfg->dir, slot);
+}
+
+static void write_process_details(FILE *f, proc_info_t *p) {
+    process_load_details(p);
+    fprintf(f, "  PID %d (PPID %d) user %s state %c threads %ld\n", p->pid,
+            p->ppid, p->user, p->state, p->num_threads);
+    fprintf(f, "    cmdline: %s\n", p->command);
+    fprintf(f, "    %%CPU %.1f %%MEM %.1f VIRT %lu KiB RES %lu KiB",
+            p->cpu_percent, p->mem_percent, p->virt_mem, p->res_mem);
+    if (process_load_smaps(p) == 0) {
+        fprintf(f, " PSS %lu KiB USS %lu KiB SWAP %lu KiB", p->pss_mem,
+                p->uss_mem, p->swap_mem);
+    } else {
+        fprintf(f, " (smaps_rollup not readable)");
+    }
+    fprintf(f, "\n");
+    if (p->io_valid) {
+        fprintf(f, "    read %.0f B/s write %.0f B/s\n", p->io_read_rate,
+                p->io_write_rate);
+    }
+    fprintf(f, "    faults %.1f minor/s %.1f major/s\n", p->minflt_rate,
+            p->majflt_rate);
+}
+
+/**
+ * Writes a detailed snapshot for the rules that fired.
+ *
+ * @return 0 on success, -1 if the file could not be written.
+ */
+static int write_capture(const char *path, const rule_set_t *set,
+                         const rule_hit_t *hits, const bool *capture,
+                         capture_sample_t *s) {
+    char tmp[PATH_MAX + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        return -1;
+    }
+
+    char when[64];
+    time_t now = time(NULL);
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S %z", localtime(&now));
+    char host[256] = "";
+    gethostname(host, sizeof(host) - 1);
+    fprintf(f, "toplite capture of %s at %s\n\n", host, when);
+
+    for (size_t r = 0; r < set->count; r++) {
+        if (!capture[r]) {
+            continue;
+        }
+        const rule_t *rule = &set->rules[r];
+        char value[32];
+        rules_format_value(rule, hits[r].value, value, sizeof(value));
+        fprintf(f, "Fired: %s (%s", rule->spec, value);
+        if (hits[r].noffenders > 0) {
+            fprintf(f, ", PID %d",
+                    s->procs.procs[hits[r].offenders[0]].pid);
+        }
+        fprintf(f, ")\n");
+    }
+
+    fprintf(f,
+            "\nCpu(s): %.1f us, %.1f sy, %.1f ni, %.1f id, %.1f wa, "
+            "%.1f hi, %.1f si, %.1f st\n",
+            s->cpu.us, s->cpu.sy, s->cpu.ni, s->cpu.id, s->cpu.wa, s->cpu.hi,
+            s->cpu.si, s->cpu.st);
+    fprintf(f,
+            "Mem: %llu KiB total, %llu KiB free, %llu KiB available\n"
+            "Swap: %llu KiB total, %llu KiB free\n",
+            s->mem.mem_total, s->mem.mem_free, s->mem.mem_available,
+            s->mem.swap_total, s->mem.swap_free);
+    fprintf(f, "Load average: %.2f, %.2f, %.2f\n", s->ld.load1, s->ld.load5,
+            s->ld.load15);
+    fprintf(f,
+            "Tasks: %u total, %u running, %u sleeping, %u stopped, "
+            "%u zombie\n",
+            s->tc.total, s->tc.running, s->tc.sleeping, s->tc.stopped,
+            s->tc.zombie);
+
+    // The offenders first, in full; a process can offend several rules
+    bool any = false;
+    for (size_t r = 0; r < set->count; r++) {
+        if (!capture[r] || hits[r].noffenders == 0) {
+            continue;
+        }
+        if (!any) {
+            fprintf(f, "\nOffending processes:\n");
+            any = true;
+        }
+        fprintf(f, " %s:\n", set->rules[r].spec);
+        for (size_t i = 0; i < hits[r].noffenders; i++) {
+            write_process_details(f, &s->procs.procs[hits[r].offenders[i]]);
+        }
+    }
+
+    // Then every process; sorting invalidates the offender indexes
+    qsort(s->procs.procs, s->procs.count, sizeof(proc_info_t),
+          compare_procs);
+    fprintf(f, "\n%7s %-10s %4s %4s %10s %10s %10s %c %5s %5s %s\n", "PID",
+            "USER", "PR", "NI", "VIRT", "RES", "SHR", 'S', "%CPU", "%MEM",
+            "COMMAND");
+    for (size_t i = 0; i < s->procs.count; i++) {
+        proc_info_t *p = &s->procs.procs[i];
+        process_load_details(p);
+        fprintf(f,
+                "%7d %-10.10s %4s %4ld %10lu %10lu %10lu %c %5.1f %5.1f %s\n",
+                p->pid, p->user, p->priority, p->nice, p->virt_mem, p->res_mem,
+                p->shr_mem, p->state, p->cpu_percent, p->mem_percent,
+                p->command);
+    }
+
+    bool failed = ferror(f);
+    if (fclose(f) != 0 || failed || rename(tmp, path) != 0) {
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+int capture_run(const rule_set_t *set, const capture_config_t *cfg) {
+    struct stat st;
+    if (stat(cfg->dir, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        fprintf(stderr, "%s: not a directory.\n", cfg->dir);
+        return 1;
+    }
+
+    // Only the fields the rules compare; captures read the rest per process
+    process_set_optional_fields(set->fields);
+
+    capture_sample_t s;
+    memset(&s, 0, sizeof(s));
+    init_process_list(&s.procs);
+    rule_hit_t hits[RULES_MAX];
+    bool capture[RULES_MAX];
+    double quiet_until[RULES_MAX] = {0}; // Cooldown end per rule
+
+    cpu_times_t prev_cpu;
+    read_cpu_times(&prev_cpu);
+    bool collected = true;
+    if (set->need_procs) {
+        // Prime the per-process deltas, so the first rates are real
+        mem_info_t mem;
+        read_meminfo(&mem);
+        collected = collect_all_processes(&s.procs, mem.mem_total) == 0;
+    }
+
+    int ret = 0;
+    for (unsigned n = 0;
+         collected && (!cfg->iterations || n < cfg->iterations); n++) {
+        usleep(cfg->interval_ms * 1000);
+        if (collect_sample(set, &s, &prev_cpu) != 0) {
+            collected = false;
+            break;
+        }
+        rule_input_t in = {
+            .cpu = &s.cpu,
+            .mem = &s.mem,
+            .ld = &s.ld,
+            .tc = &s.tc,
+            .procs = s.have_procs ? &s.procs : NULL,
+        };
+        if (rules_eval(set, &in, hits) == 0) {
+            continue;
+        }
+
+        double now = monotonic_seconds();
+        bool any = false;
+        for (size_t r = 0; r < set->count; r++) {
+            capture[r] = hits[r].fired && now >= quiet_until[r];
+            if (capture[r]) {
+                quiet_until[r] = now + cfg->cooldown_sec;
+                any = true;
+            }
+        }
+        if (!any) {
+            continue;
+        }
+
+        // A capture shows everything: every process with its details
+        if (!set->need_tasks) {
+            scan_task_states(&s.tc);
+        }
+        if (!s.have_procs) {
+            if (collect_all_processes(&s.procs, s.mem.mem_total) != 0) {
+                collected = false;
+                break;
+            }
+            usleep(CAPTURE_SAMPLE_MS * 1000);
+            if (collect_all_processes(&s.procs, s.mem.mem_total) != 0) {
+                collected = false;
+                break;
+            }
+        }
+
+        char path[PATH_MAX];
+        next_capture_path(cfg, path, sizeof(path));
+        if (write_capture(path, set, hits, capture, &s) != 0) {
+            fprintf(stderr, "%s: %s\n", path, strerror(errno));
+            ret = 1;
+            break;
+        }
+        printf("%s:", path);
+        for (size_t r = 0; r < set->count; r++) {
+            if (capture[r]) {
+                printf(" %s", set->rules[r].spec);
+            }
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+
+    if (!collected) {
+        fprintf(stderr, "Failed to collect the process list.\n");
+        ret = 1;
+    }
+    free_process_list(&s.procs);
+    return ret;
+}
@@ -0,0 +1,42 @@
+// src/core/capture.h
+#pragma once
+#include "rules.h"
+
+// Defaults of --trigger-keep and --trigger-cooldown
+#define CAPTURE_DEFAULT_KEEP 10
+#define CAPTURE_DEFAULT_COOLDOWN_SEC 60
+// Most capture files kept in a directory
+#define CAPTURE_MAX_KEEP 100
+
+// Without a process rule, the processes are only sampled when a rule fires;
+// this far apart, so %CPU is known
+#define CAPTURE_SAMPLE_MS 250
+
+/**
+ * Where and how often captures are written.
+ */
+typedef struct {
+    const char *dir;       // Directory of the capture files
+    unsigned keep;         // Capture files to rotate through
+    unsigned cooldown_sec; // Time before a rule may capture again
+    unsigned interval_ms;  // Evaluation interval
+    unsigned iterations;   // Evaluations to run (0: forever)
+} capture_config_t;
+
+/**
+ * @brief Runs toplite headless, evaluating rules and capturing snapshots.
+ * @details Every interval, only what the rules look at is collected: the
+ *          system statistics, the task counts if a tasks.* rule exists and
+ *          the process table (with just the fields the rules need) if a
+ *          proc.* rule exists. When rules fire, a detailed snapshot (the
+ *          rules and their offending processes with their command lines and
+ *          smaps_rollup, then every process) is written to
+ *          DIR/toplite-capture-NN.txt, replacing the oldest of 'keep'
+ *          files, and a line naming the file is printed to stdout. A rule
+ *          that captured stays quiet for the cooldown.
+ *
+ * @param set The compiled rules.
+ * @param cfg The capture settings.
+ * @return 0 after the last iteration, 1 on error.
+ */
+int capture_run(const rule_set_t *set, const capture_config_t *cfg);
@@ -0,0 +1,292 @@
+// src/core/cgroup.c
+#include "cgroup.h"
+#include "../util/util.h"
+#include <dirent.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+void init_pid_list(pid_list_t *list) {
+    list->pids = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+void free_pid_list(pid_list_t *list) {
+    free(list->pids);
+    init_pid_list(list);
+}
+
+static int add_pid_to_list(pid_list_t *list, pid_t pid) {
+    if (list->count == list->capacity) {
+        size_t new_capacity = (list->capacity == 0) ? 64 : list->capacity * 2;
+        pid_t *new_pids = realloc(list->pids, new_capacity * sizeof(pid_t));
+        if (!new_pids) {
+            perror("Failed to allocate memory for PID list");
+            return -1;
+        }
+        list->pids = new_pids;
+        list->capacity = new_capacity;
+    }
+
+    list->pids[list->count] = pid;
+    list->count++;
+    return 0;
+}
+
+const char *cgroup_v2_mount(void) {
+    static const char *mount = NULL;
+    static int probed = 0;
+
+    if (!probed) {
+        // Every cgroup v2 directory (including the root) has cgroup.procs
+        if (access(CGROUP_V2_ROOT "/cgroup.procs", R_OK) == 0 &&
+            access(CGROUP_V2_ROOT "/cgroup.controllers", R_OK) == 0) {
+            mount = CGROUP_V2_ROOT;
+        } else if (access(CGROUP_V2_ROOT "/unified/cgroup.procs", R_OK) == 0) {
+            mount = CGROUP_V2_ROOT "/unified";
+        }
+        probed = 1;
+    }
+    return mount;
+}
+
+int read_process_cgroup(pid_t pid, char *out, size_t size) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/cgroup", pid);
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
+
+    // The cgroup v2 entry is the one with hierarchy ID 0: "0::/path"
+    char line[PATH_MAX];
+    int ret = -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "0::", 3) == 0) {
+            line[strcspn(line, "\n")] = '\0';
+            snprintf(out, size, "%s", line + 3);
+            ret = 0;
+            break;
+        }
+    }
+    fclose(f);
+    return ret;
+}
+
+int cgroup_resolve_path(const char *path, char *out, size_t size) {
+    struct stat st;
+    int n;
+    const char *mount = cgroup_v2_mount();
+
+    if (path[0] == '/' && stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+        n = snprintf(out, size, "%s", path);
+    } else if (mount) {
+        // Treat it as a path inside the cgroup v2 hierarchy
+        n = snprintf(out, size, "%s%s%s", mount, path[0] == '/' ? "" : "/",
+                     path);
+    } else {
+        return -1;
+    }
+    if (n < 0 || (size_t)n >= size) {
+        return -1;
+    }
+
+    char procs_path[PATH_MAX];
+    n = snprintf(procs_path, sizeof(procs_path), "%s/cgroup.procs", out);
+    if (n < 0 || (size_t)n >= sizeof(procs_path)) {
+        return -1;
+    }
+    return access(procs_path, R_OK) == 0 ? 0 : -1;
+}
+
+/**
+ * Reads cgroup.procs of a single cgroup (no recursion) and appends the PIDs.
+ *
+ * @param cgroup_dir The cgroup directory.
+ * @param out Pointer to the pid_list_t to append to.
+ * @return 0 on success, -1 on error.
+ */
+static int read_cgroup_procs(const char *cgroup_dir, pid_list_t *out) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/cgroup.procs", cgroup_dir);
+
+    char *buf;
+    if (!read_text_file(path, &buf, NULL)) {
+        return -1;
+    }
+
+    // One PID per line
+    const char *p = buf;
+    while (*p) {
+        if (*p >= '0' && *p <= '9') {
+            pid_t pid = (pid_t)strtoull_safe(&p);
+            if (add_pid_to_list(out, pid) != 0) {
+                free(buf);
+                return -1;
+            }
+        } else {
+            p++;
+        }
+    }
+
+    free(buf);
+    return 0;
+}
+
+static int collect_pids_recursive(const char *cgroup_dir, pid_list_t *out) {
+    if (read_cgroup_procs(cgroup_dir, out) != 0) {
+        return -1;
+    }
+
+    DIR *d = opendir(cgroup_dir);
+    if (!d) {
+        return -1;
+    }
+
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        // Child cgroups are the only subdirectories of a cgroup
+        if (e->d_type != DT_DIR || e->d_name[0] == '.') {
+            continue;
+        }
+
+        char child[PATH_MAX];
+        int n = snprintf(child, sizeof(child), "%s/%s", cgroup_dir, e->d_name);
+        if (n < 0 || (size_t)n >= sizeof(child)) {
+            continue;
+        }
+
+        // A child may vanish between readdir and reading it; that's fine
+        collect_pids_recursive(child, out);
+    }
+    closedir(d);
+    return 0;
+}
+
+int cgroup_collect_pids(const char *cgroup_dir, pid_list_t *out) {
+    out->count = 0; // Reset list for a fresh collection
+    return collect_pids_recursive(cgroup_dir, out);
+}
+
+/**
+ * Reads a cgroup file holding a single number (e.g. memory.current).
+ * The literal "max" (no limit) is reported as 0.
+ *
+ * @return 0 on success, -1 if the file does not exist or cannot be read.
+ */
+static int read_cgroup_value(const char *cgroup_dir, const char *file,
+                             unsigned long long *value) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", cgroup_dir, file);
+
+    char *buf;
+    if (!read_text_file(path, &buf, NULL)) {
+        return -1;
+    }
+
+    const char *p = buf;
+    *value = strncmp(p, "max", 3) == 0 ? 0 : strtoull_safe(&p);
+    free(buf);
+    return 0;
+}
+
+long read_cgroup_descendants(const char *cgroup_dir) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/cgroup.stat", cgroup_dir);
+
+    char *buf;
+    if (!read_text_file(path, &buf, NULL)) {
+        return -1;
+    }
+    long descendants = -1;
+    char *save, *line = strtok_r(buf, "\n", &save);
+    while (line) {
+        if (sscanf(line, "nr_descendants %ld", &descendants) == 1) {
+            break;
+        }
+        line = strtok_r(NULL, "\n", &save);
+    }
+    free(buf);
+    return descendants;
+}
+
+int read_cgroup_cpu(const char *cgroup_dir, cgroup_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->timestamp = monotonic_seconds();
+
+    char path[PATH_MAX];
+    char *buf;
+
+    // cpu.stat is always present in cgroup v2, even without the cpu controller
+    snprintf(path, sizeof(path), "%s/cpu.stat", cgroup_dir);
+    if (!read_text_file(path, &buf, NULL)) {
+        return -1;
+    }
+    char *save, *line = strtok_r(buf, "\n", &save);
+    while (line) {
+        if (sscanf(line, "usage_usec %llu", &out->usage_usec) == 1) {
+        } else if (sscanf(line, "user_usec %llu", &out->user_usec) == 1) {
+        } else if (sscanf(line, "system_usec %llu", &out->system_usec) == 1) {
+        }
+        line = strtok_r(NULL, "\n", &save);
+    }
+    free(buf);
+    out->has_cpu = 1;
+    return 0;
+}
+
+int read_cgroup_stats(const char *cgroup_dir, cgroup_stats_t *out) {
+    read_cgroup_cpu(cgroup_dir, out); // Leaves has_cpu cleared on failure
+
+    char path[PATH_MAX];
+    char *buf;
+
+    // The memory controller files don't exist in the root cgroup
+    unsigned long long bytes;
+    if (read_cgroup_value(cgroup_dir, "memory.current", &bytes) == 0) {
+        out->mem_current = bytes / 1024;
+        out->has_mem = 1;
+
+        if (read_cgroup_value(cgroup_dir, "memory.max", &bytes) == 0) {
+            out->mem_max = bytes / 1024;
+        }
+
+        snprintf(path, sizeof(path), "%s/memory.stat", cgroup_dir);
+        if (read_text_file(path, &buf, NULL)) {
+            char *save, *line = strtok_r(buf, "\n", &save);
+            while (line) {
+                if (sscanf(line, "file %llu", &bytes) == 1) {
+                    out->mem_file = bytes / 1024;
+                    break;
+                }
+                line = strtok_r(NULL, "\n", &save);
+            }
+            free(buf);
+        }
+    }
+
+    return (out->has_cpu || out->has_mem) ? 0 : -1;
+}
+
+void cgroup_cpu_percent(const cgroup_stats_t *prev, const cgroup_stats_t *now,
+                        long ncpu, cgroup_cpu_percent_t *pct) {
+    memset(pct, 0, sizeof(*pct));
+
+    double elapsed_usec = (now->timestamp - prev->timestamp) * 1e6;
+    if (!prev->has_cpu || !now->has_cpu || elapsed_usec <= 0 || ncpu <= 0) {
+        return;
+    }
+
+#define D(field)                                                               \
+    ((now->field > prev->field) ? (double)(now->field - prev->field) : 0.0)
+
+    pct->cpus = D(usage_usec) / elapsed_usec;
+    pct->us = (D(user_usec) / (elapsed_usec * ncpu)) * 100.0;
+    pct->sy = (D(system_usec) / (elapsed_usec * ncpu)) * 100.0;
+
+#undef D
+}
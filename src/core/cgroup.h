@@ -0,0 +1,154 @@
+// src/core/cgroup.h
+#pragma once
+#include <stddef.h>
+#include <sys/types.h>
+
+// Mount point of the unified (v2) cgroup hierarchy
+#define CGROUP_V2_ROOT "/sys/fs/cgroup"
+
+/**
+ * Represents a dynamically-sized list of PIDs.
+ */
+typedef struct {
+    pid_t *pids;
+    size_t count;
+    size_t capacity;
+} pid_list_t;
+
+/**
+ * A structure that represents the resource counters of a single cgroup.
+ * The CPU counters come from cpu.stat, the memory counters from
+ * memory.current, memory.max and memory.stat.
+ */
+typedef struct {
+    unsigned long long usage_usec;  // Total CPU time consumed (microseconds)
+    unsigned long long user_usec;   // User CPU time (microseconds)
+    unsigned long long system_usec; // System CPU time (microseconds)
+    unsigned long long mem_current; // Memory charged to the cgroup in KiB
+    unsigned long long mem_max;     // Memory limit in KiB (0 if unlimited)
+    unsigned long long mem_file;    // Page cache charged to the cgroup in KiB
+    double timestamp;               // Monotonic time of the sample (seconds)
+    int has_cpu;                    // Non-zero if cpu.stat could be read
+    int has_mem;                    // Non-zero if memory.current exists
+} cgroup_stats_t;
+
+/**
+ * A structure that represents the CPU usage of a cgroup between two samples.
+ * The percentages are relative to the whole machine (like %Cpu(s)), while
+ * 'cpus' is the number of CPUs the cgroup kept busy on average.
+ */
+typedef struct {
+    double us;   // User time percentage
+    double sy;   // System time percentage
+    double cpus; // Average number of busy CPUs
+} cgroup_cpu_percent_t;
+
+/**
+ * @brief Initializes a PID list (pid_list_t).
+ *
+ * @param list Pointer to the pid_list_t to initialize.
+ */
+void init_pid_list(pid_list_t *list);
+
+/**
+ * @brief Frees the memory allocated for a PID list (pid_list_t).
+ *
+ * @param list Pointer to the pid_list_t to free.
+ */
+void free_pid_list(pid_list_t *list);
+
+/**
+ * @brief Finds where the cgroup v2 hierarchy is mounted.
+ * @details This is CGROUP_V2_ROOT on pure cgroup v2 hosts and
+ * CGROUP_V2_ROOT "/unified" on hybrid (v1 + v2) hosts.
+ *
+ * @return The mount point, or NULL if there is no cgroup v2 hierarchy.
+ */
+const char *cgroup_v2_mount(void);
+
+/**
+ * @brief Reads the cgroup v2 path of a process from /proc/[pid]/cgroup.
+ * @details The path is relative to the cgroup v2 mount point (e.g.
+ * "/system.slice/sshd.service").
+ *
+ * @param pid The process ID.
+ * @param out Buffer to store the path in.
+ * @param size Size of the output buffer.
+ * @return 0 on success, -1 on failure.
+ */
+int read_process_cgroup(pid_t pid, char *out, size_t size);
+
+/**
+ * @brief Resolves a user supplied cgroup path to a cgroup v2 directory.
+ * @details An absolute path to an existing directory is used as is; anything
+ * else is taken relative to the cgroup v2 mount point (e.g. "/kubepods/pod1"
+ * becomes "/sys/fs/cgroup/kubepods/pod1").
+ *
+ * @param path The path given on the command line.
+ * @param out Buffer to store the resolved directory in.
+ * @param size Size of the output buffer.
+ * @return 0 on success, -1 if the path is not a cgroup v2 directory.
+ */
+int cgroup_resolve_path(const char *path, char *out, size_t size);
+
+/**
+ * @brief Collects the PIDs of a cgroup and all of its descendants.
+ * @details Reads cgroup.procs of the given cgroup directory and recurses into
+ * every child cgroup. The list is reset before collecting.
+ *
+ * @param cgroup_dir The resolved cgroup directory.
+ * @param out Pointer to a pid_list_t to fill with the PIDs.
+ * @return 0 on success, -1 on error (e.g., if cgroup.procs cannot be read).
+ */
+int cgroup_collect_pids(const char *cgroup_dir, pid_list_t *out);
+
+/**
+ * @brief Reads the number of live descendant cgroups (cgroup.stat).
+ *
+ * @param cgroup_dir The resolved cgroup directory.
+ * @return nr_descendants, or -1 if cgroup.stat cannot be read.
+ */
+long read_cgroup_descendants(const char *cgroup_dir);
+
+/**
+ * @brief Reads only the CPU counters of a cgroup (cpu.stat).
+ * @details For callers that sample many cgroups per frame; the memory
+ * counters and has_mem are left cleared.
+ *
+ * @param cgroup_dir The resolved cgroup directory.
+ * @param out Pointer to a cgroup_stats_t structure to populate.
+ * @return 0 on success, -1 if cpu.stat cannot be read.
+ */
+int read_cgroup_cpu(const char *cgroup_dir, cgroup_stats_t *out);
+
+/**
+ * @brief Reads the CPU and memory counters of a cgroup.
+ * @details Missing controller files are not an error; the corresponding
+ * has_cpu / has_mem flags are simply left cleared.
+ *
+ * @param cgroup_dir The resolved cgroup directory.
+ * @param out Pointer to a cgroup_stats_t structure to populate.
+ * @return 0 on success, -1 on failure.
+ */
+int read_cgroup_stats(const char *cgroup_dir, cgroup_stats_t *out);
+
+/**
+ * @brief Calculates the CPU usage of a cgroup between two samples.
+ *
+ * @param prev Pointer to the previous cgroup_stats_t sample.
+ * @param now Pointer to the current cgroup_stats_t sample.
+ * @param ncpu Number of online CPUs used to normalize the percentages.
+ * @param pct Pointer to a cgroup_cpu_percent_t structure to populate.
+ */
+void cgroup_cpu_percent(const cgroup_stats_t *prev, const cgroup_stats_t *now,
+                        long ncpu, cgroup_cpu_percent_t *pct);
+
+/**
+ * Everything the header needs to show a cgroup-scoped view.
+ */
+typedef struct {
+    const char *path;         // Resolved cgroup directory
+    size_t nprocs;            // Number of processes in the cgroup subtree
+    cgroup_stats_t stats;     // Latest counters
+    cgroup_cpu_percent_t cpu; // CPU usage since the previous sample
+} cgroup_view_t;
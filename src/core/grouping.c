@@ -0,0 +1,170 @@
+// src/core/grouping.c
+#include "grouping.h"
+#include "../util/util.h"
+#include "cgroup.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uthash.h>
+
+/**
+ * Holds what toplite remembers about a cgroup between two collections.
+ */
+typedef struct {
+    char *cgroup;                  // cgroup v2 path (hash key)
+    unsigned long long usage_usec; // cpu.stat usage_usec at the last sample
+    double sample_time;            // Monotonic time of the last sample
+    int has_sample;                // usage_usec / sample_time are valid
+    int expanded;                  // Show the member processes
+    unsigned generation;           // Last grouping that saw the cgroup
+    size_t index;                  // Row in the current group_list_t
+    UT_hash_handle hh;
+} group_state_t;
+
+// All known cgroups, keyed by path
+static group_state_t *g_group_states = NULL;
+static unsigned g_generation = 0;
+
+void init_group_list(group_list_t *list) {
+    list->groups = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+void free_group_list(group_list_t *list) {
+    free(list->groups);
+    init_group_list(list);
+}
+
+static int add_group_to_list(group_list_t *list, const cgroup_group_t group) {
+    if (list->count == list->capacity) {
+        size_t new_capacity = (list->capacity == 0) ? 16 : list->capacity * 2;
+        cgroup_group_t *new_groups =
+            realloc(list->groups, new_capacity * sizeof(cgroup_group_t));
+        if (!new_groups) {
+            perror("Failed to allocate memory for group list");
+            return -1;
+        }
+        list->groups = new_groups;
+        list->capacity = new_capacity;
+    }
+
+    list->groups[list->count] = group;
+    list->count++;
+    return 0;
+}
+
+static group_state_t *get_group_state(const char *cgroup) {
+    group_state_t *st = NULL;
+    HASH_FIND_STR(g_group_states, cgroup, st);
+    if (st) {
+        return st;
+    }
+
+    st = calloc(1, sizeof(*st));
+    if (!st || !(st->cgroup = strdup(cgroup))) {
+        perror("Failed to allocate memory for cgroup state");
+        free(st);
+        return NULL;
+    }
+    HASH_ADD_KEYPTR(hh, g_group_states, st->cgroup, strlen(st->cgroup), st);
+    return st;
+}
+
+/**
+ * Replaces the summed %CPU of a group by the one from the cgroup's cpu.stat.
+ * cpu.stat also counts the child cgroups, so this is only done for cgroups
+ * without any. Processes can sit next to child cgroups unless a domain
+ * controller is enabled, and the root cgroup always has them.
+ */
+static void apply_cgroup_cpu(group_state_t *st, cgroup_group_t *group) {
+    const char *mount = cgroup_v2_mount();
+    if (!mount || strcmp(st->cgroup, "/") == 0) {
+        return;
+    }
+
+    char dir[PATH_MAX];
+    int n = snprintf(dir, sizeof(dir), "%s%s", mount, st->cgroup);
+    cgroup_stats_t stats;
+    if (n < 0 || (size_t)n >= sizeof(dir) ||
+        read_cgroup_descendants(dir) != 0 ||
+        read_cgroup_cpu(dir, &stats) != 0) {
+        st->has_sample = 0;
+        return;
+    }
+
+    double elapsed_usec = (stats.timestamp - st->sample_time) * 1e6;
+    if (st->has_sample && elapsed_usec > 0 &&
+        stats.usage_usec >= st->usage_usec) {
+        group->cpu_percent =
+            (double)(stats.usage_usec - st->usage_usec) / elapsed_usec * 100.0;
+        group->cpu_from_cgroup = 1;
+    }
+    st->usage_usec = stats.usage_usec;
+    st->sample_time = stats.timestamp;
+    st->has_sample = 1;
+}
+
+int group_processes_by_cgroup(const proc_list_t *procs, group_list_t *out) {
+    out->count = 0; // Reset list for a fresh grouping
+    g_generation++;
+
+    for (size_t i = 0; i < procs->count; i++) {
+        const proc_info_t *p = &procs->procs[i];
+        if (!p->cgroup) {
+            // The cgroup could not be read (e.g. the process just exited)
+            continue;
+        }
+
+        group_state_t *st = get_group_state(p->cgroup);
+        if (!st) {
+            return -1;
+        }
+
+        if (st->generation != g_generation) {
+            // First member of this cgroup in this grouping
+            cgroup_group_t group = {0};
+            group.cgroup = st->cgroup;
+            group.expanded = st->expanded;
+            if (add_group_to_list(out, group) != 0) {
+                return -1;
+            }
+            st->generation = g_generation;
+            st->index = out->count - 1;
+        }
+
+        cgroup_group_t *group = &out->groups[st->index];
+        group->nprocs++;
+        group->ntasks += (p->num_threads > 0) ? (unsigned long)p->num_threads
+                                              : 1;
+        group->res_mem += p->res_mem;
+        group->mem_percent += p->mem_percent;
+        group->cpu_percent += p->cpu_percent;
+        group->cpu_ticks += p->cpu_ticks;
+    }
+
+    // Prefer the kernel's own accounting, and forget vanished cgroups
+    group_state_t *st, *tmp;
+    HASH_ITER(hh, g_group_states, st, tmp) {
+        if (st->generation == g_generation) {
+            apply_cgroup_cpu(st, &out->groups[st->index]);
+        } else if (st->expanded) {
+            // Keep the setting in case the cgroup gets processes again
+            st->has_sample = 0;
+        } else {
+            HASH_DEL(g_group_states, st);
+            free(st->cgroup);
+            free(st);
+        }
+    }
+
+    return 0;
+}
+
+void grouping_toggle_expanded(const char *cgroup) {
+    group_state_t *st = get_group_state(cgroup);
+    if (st) {
+        st->expanded = !st->expanded;
+    }
+}
@@ -0,0 +1,64 @@
+// src/core/grouping.h
+#pragma once
+#include "process.h"
+#include <stddef.h>
+
+/**
+ * Holds the aggregated information of all processes in one cgroup.
+ */
+typedef struct {
+    const char *cgroup;           // cgroup v2 path (owned by the grouping)
+    unsigned nprocs;              // Number of processes
+    unsigned long ntasks;         // Number of tasks (threads)
+    unsigned long res_mem;        // Summed Resident Set Size in KiB
+    double mem_percent;           // Summed memory usage percentage
+    double cpu_percent;           // CPU usage percentage
+    unsigned long long cpu_ticks; // Summed CPU time in ticks
+    int cpu_from_cgroup;          // cpu_percent was taken from cpu.stat
+    int expanded;                 // Member processes are shown below it
+} cgroup_group_t;
+
+/**
+ * Represents a dynamically-sized list of cgroup groups.
+ */
+typedef struct {
+    cgroup_group_t *groups;
+    size_t count;
+    size_t capacity;
+} group_list_t;
+
+/**
+ * @brief Initializes a group list (group_list_t).
+ *
+ * @param list Pointer to the group_list_t to initialize.
+ */
+void init_group_list(group_list_t *list);
+
+/**
+ * @brief Frees the memory allocated for a group list (group_list_t).
+ *
+ * @param list Pointer to the group_list_t to free.
+ */
+void free_group_list(group_list_t *list);
+
+/**
+ * @brief Aggregates a process list into one row per cgroup.
+ * @details The processes must have been collected with PROC_FIELD_CGROUP.
+ *          %CPU of a cgroup without child cgroups is taken from its own
+ *          cpu.stat (one read per cgroup instead of summing every member).
+ *          Otherwise, or when cpu.stat cannot be read, it is the sum of the
+ *          members' %CPU.
+ *
+ * @param procs Pointer to the collected proc_list_t.
+ * @param out Pointer to the group_list_t to fill (reset first).
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+int group_processes_by_cgroup(const proc_list_t *procs, group_list_t *out);
+
+/**
+ * @brief Expands or collapses a group, i.e. shows or hides its processes.
+ * @details The setting is remembered across collections.
+ *
+ * @param cgroup The cgroup path of the group.
+ */
+void grouping_toggle_expanded(const char *cgroup);
@@ -0,0 +1,109 @@
+// src/core/history.c
+#include "history.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Position of a ring's newest sample and how many samples it holds.
+ */
+typedef struct {
+    uint16_t head;  // Index of the next sample to write
+    uint16_t count; // Samples written, up to g_samples
+} ring_t;
+
+static unsigned g_samples = 0;          // Samples per ring
+static unsigned g_max_rings = 0;        // Rings in the slab
+static history_sample_t *g_slab = NULL; // g_max_rings * g_samples samples
+static ring_t *g_rings = NULL;          // One per ring
+static int *g_free = NULL;              // Stack of free ring indices
+static unsigned g_nfree = 0;            // Entries in g_free
+
+int history_init(unsigned samples, unsigned max_pids) {
+    history_free();
+    if (samples == 0 || max_pids == 0) {
+        return 0; // Disabled
+    }
+    if (samples > UINT16_MAX) {
+        samples = UINT16_MAX;
+    }
+
+    g_slab = calloc((size_t)samples * max_pids, sizeof(*g_slab));
+    g_rings = calloc(max_pids, sizeof(*g_rings));
+    g_free = malloc(max_pids * sizeof(*g_free));
+    if (!g_slab || !g_rings || !g_free) {
+        perror("Failed to allocate memory for process history");
+        history_free();
+        return -1;
+    }
+
+    g_samples = samples;
+    g_max_rings = max_pids;
+    // Hand out the low indices first
+    for (unsigned i = 0; i < max_pids; i++) {
+        g_free[i] = (int)(max_pids - 1 - i);
+    }
+    g_nfree = max_pids;
+    return 0;
+}
+
+void history_free(void) {
+    free(g_slab);
+    free(g_rings);
+    free(g_free);
+    g_slab = NULL;
+    g_rings = NULL;
+    g_free = NULL;
+    g_samples = 0;
+    g_max_rings = 0;
+    g_nfree = 0;
+}
+
+unsigned history_length(void) { return g_samples; }
+
+size_t history_bytes_per_pid(void) {
+    // The samples, the ring position and the ring's slot in the free stack
+    return g_samples * sizeof(history_sample_t) + sizeof(ring_t) + sizeof(int);
+}
+
+int history_acquire(void) {
+    if (g_nfree == 0) {
+        return -1;
+    }
+    int ring = g_free[--g_nfree];
+    g_rings[ring].head = 0;
+    g_rings[ring].count = 0;
+    return ring;
+}
+
+void history_release(int ring) {
+    if (ring < 0 || (unsigned)ring >= g_max_rings) {
+        return;
+    }
+    g_free[g_nfree++] = ring;
+}
+
+void history_record(int ring, const history_sample_t *sample) {
+    ring_t *r = &g_rings[ring];
+    g_slab[(size_t)ring * g_samples + r->head] = *sample;
+    r->head = (uint16_t)((r->head + 1) % g_samples);
+    if (r->count < g_samples) {
+        r->count++;
+    }
+}
+
+size_t history_read(int ring, history_sample_t *out, size_t max) {
+    if (ring < 0 || (unsigned)ring >= g_max_rings) {
+        return 0;
+    }
+
+    const ring_t *r = &g_rings[ring];
+    size_t n = r->count < max ? r->count : max;
+    // The oldest of the n newest samples
+    size_t pos = (r->head + g_samples - n) % g_samples;
+    const history_sample_t *base = &g_slab[(size_t)ring * g_samples];
+    for (size_t i = 0; i < n; i++) {
+        out[i] = base[pos];
+        pos = (pos + 1) % g_samples;
+    }
+    return n;
+}
@@ -0,0 +1,82 @@
+// src/core/history.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Default number of samples kept per process
+#define HISTORY_DEFAULT_SAMPLES 32
+// Default number of processes that can have a history at the same time
+#define HISTORY_DEFAULT_PIDS 4096
+
+/**
+ * One collection's worth of a process' values.
+ */
+typedef struct {
+    float cpu;        // %CPU
+    float io;         // Bytes read + written per second (-1: unknown)
+    uint32_t res_kib; // RES in KiB
+} history_sample_t;
+
+/**
+ * @brief Allocates the history slab.
+ * @details Every process gets a fixed-size ring of the last 'samples'
+ *          samples, taken from one preallocated slab of 'max_pids' rings.
+ *          Memory is therefore bounded by history_bytes_per_pid() * max_pids
+ *          no matter how many processes come and go; processes that start
+ *          while the slab is full simply have no history until a ring frees
+ *          up. With the defaults (32 samples, 4096 PIDs) each ring costs
+ *          32 * 12 + 8 = 392 bytes, about 1.5 MiB in total.
+ *
+ * @param samples Samples per process (0 disables the history).
+ * @param max_pids Number of rings in the slab.
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+int history_init(unsigned samples, unsigned max_pids);
+
+/**
+ * @brief Frees the history slab.
+ */
+void history_free(void);
+
+/**
+ * @brief Get the number of samples kept per process (0: disabled).
+ */
+unsigned history_length(void);
+
+/**
+ * @brief Get the memory one process' ring takes in the slab, in bytes.
+ */
+size_t history_bytes_per_pid(void);
+
+/**
+ * @brief Takes an empty ring from the slab.
+ *
+ * @return The ring index, or -1 if the slab is full or disabled.
+ */
+int history_acquire(void);
+
+/**
+ * @brief Returns a ring to the slab.
+ *
+ * @param ring The ring index (-1 is ignored).
+ */
+void history_release(int ring);
+
+/**
+ * @brief Appends a sample, overwriting the oldest one once the ring is full.
+ *
+ * @param ring The ring index.
+ * @param sample The sample to append.
+ */
+void history_record(int ring, const history_sample_t *sample);
+
+/**
+ * @brief Copies the samples of a ring, oldest first.
+ *
+ * @param ring The ring index (-1 for none).
+ * @param out Array to copy the samples into.
+ * @param max Number of entries in out; the newest ones are kept if the ring
+ *            holds more.
+ * @return The number of samples copied.
+ */
+size_t history_read(int ring, history_sample_t *out, size_t max);
@@ -0,0 +1,277 @@
+// src/core/iostat.c
+#include "iostat.h"
+#include "../util/util.h"
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// Room for IOSTAT_MAX_DEVICES lines of either file
+#define IOSTAT_BUF_SIZE (IOSTAT_MAX_DEVICES * 192)
+
+static int g_diskstats_fd = -1;
+static int g_netdev_fd = -1;
+static char g_buf[IOSTAT_BUF_SIZE];
+
+// Whether /sys/block has an entry for a name (i.e. it is not a partition),
+// by line of /proc/diskstats; only looked up again when the name changes
+static struct {
+    char name[32];
+    bool whole;
+} g_whole[IOSTAT_MAX_DEVICES];
+
+/**
+ * Copies the next whitespace (or ':') separated word into out.
+ */
+static void parse_name(const char **p, char *out, size_t size) {
+    const char *s = *p;
+    while (*s == ' ') {
+        s++;
+    }
+    size_t n = 0;
+    while (*s && *s != ' ' && *s != ':' && *s != '\n') {
+        if (n + 1 < size) {
+            out[n++] = *s;
+        }
+        s++;
+    }
+    out[n] = '\0';
+    *p = s;
+}
+
+/**
+ * Moves to the start of the next line.
+ */
+static const char *next_line(const char *p) {
+    const char *nl = strchr(p, '\n');
+    return nl ? nl + 1 : p + strlen(p);
+}
+
+static bool is_whole_disk(size_t line, const char *name) {
+    if (line >= IOSTAT_MAX_DEVICES) {
+        return false;
+    }
+    if (strcmp(g_whole[line].name, name) != 0) {
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/block/%s", name);
+        snprintf(g_whole[line].name, sizeof(g_whole[line].name), "%s", name);
+        g_whole[line].whole = access(path, F_OK) == 0;
+    }
+    return g_whole[line].whole;
+}
+
+int read_disk_stats(disk_stats_t *out, bool all) {
+    out->count = 0;
+    out->timestamp = monotonic_seconds();
+    if (read_file_at(&g_diskstats_fd, "/proc/diskstats", g_buf,
+                     sizeof(g_buf)) < 0) {
+        return -1;
+    }
+
+    // "major minor name rd_ios rd_merges rd_sectors rd_ticks wr_ios
+    // wr_merges wr_sectors wr_ticks in_flight io_ticks ..."
+    size_t line = 0;
+    for (const char *p = g_buf; *p && out->count < IOSTAT_MAX_DEVICES;
+         p = next_line(p), line++) {
+        disk_dev_t *d = &out->devs[out->count];
+        strtoull_safe(&p); // major
+        strtoull_safe(&p); // minor
+        parse_name(&p, d->name, sizeof(d->name));
+        if (!all && (strncmp(d->name, "loop", 4) == 0 ||
+                     strncmp(d->name, "ram", 3) == 0)) {
+            continue;
+        }
+        if (d->name[0] == '\0' || !is_whole_disk(line, d->name)) {
+            continue; // Partitions are already counted in their disk
+        }
+
+        d->rd_ios = strtoull_safe(&p);
+        strtoull_safe(&p); // rd_merges
+        d->rd_sectors = strtoull_safe(&p);
+        strtoull_safe(&p); // rd_ticks
+        d->wr_ios = strtoull_safe(&p);
+        strtoull_safe(&p); // wr_merges
+        d->wr_sectors = strtoull_safe(&p);
+        strtoull_safe(&p); // wr_ticks
+        strtoull_safe(&p); // in_flight
+        d->io_ticks = strtoull_safe(&p);
+        out->count++;
+    }
+    return 0;
+}
+
+int read_net_stats(net_stats_t *out, bool all) {
+    out->count = 0;
+    out->timestamp = monotonic_seconds();
+    if (read_file_at(&g_netdev_fd, "/proc/net/dev", g_buf, sizeof(g_buf)) <
+        0) {
+        return -1;
+    }
+
+    // Two header lines, then "name: rx_bytes rx_packets errs drop fifo
+    // frame compressed multicast tx_bytes tx_packets ..."
+    const char *p = next_line(next_line(g_buf));
+    for (; *p && out->count < IOSTAT_MAX_DEVICES; p = next_line(p)) {
+        net_dev_t *d = &out->devs[out->count];
+        parse_name(&p, d->name, sizeof(d->name));
+        if (*p != ':' || (!all && strcmp(d->name, "lo") == 0)) {
+            continue;
+        }
+        p++;
+
+        d->rx_bytes = strtoull_safe(&p);
+        d->rx_packets = strtoull_safe(&p);
+        for (int i = 0; i < 6; i++) {
+            strtoull_safe(&p); // errs drop fifo frame compressed multicast
+        }
+        d->tx_bytes = strtoull_safe(&p);
+        d->tx_packets = strtoull_safe(&p);
+        out->count++;
+    }
+    return 0;
+}
+
+/**
+ * Finds the previous sample of a device. The order rarely changes, so the
+ * same index is tried first.
+ */
+#define FIND_PREV(prev, i, dev_name)                                           \
+    ((i) < (prev)->count && strcmp((prev)->devs[i].name, dev_name) == 0        \
+         ? &(prev)->devs[i]                                                    \
+         : find_by_name((prev)->devs, sizeof((prev)->devs[0]),                 \
+                        (prev)->count, dev_name))
+
+static const void *find_by_name(const void *devs, size_t stride, size_t count,
+                                const char *name) {
+    // Every device structure starts with its name
+    for (size_t i = 0; i < count; i++) {
+        const char *dev = (const char *)devs + i * stride;
+        if (strcmp(dev, name) == 0) {
+            return dev;
+        }
+    }
+    return NULL;
+}
+
+#define DELTA(field) (p->field < d->field ? (double)(d->field - p->field) : 0.0)
+
+/**
+ * Finds where a device with the given busyness goes among the busiest so
+ * far (busiest first), or 'top' if it is not among them.
+ */
+static size_t top_slot(const double *busy, size_t count, size_t top,
+                       double value) {
+    size_t slot = count < top ? count : top;
+    while (slot > 0 && busy[slot - 1] < value) {
+        slot--;
+    }
+    return slot;
+}
+
+void disk_rates(const disk_stats_t *prev, const disk_stats_t *now, size_t top,
+                disk_view_t *out) {
+    memset(out, 0, sizeof(*out));
+    double elapsed = now->timestamp - prev->timestamp;
+    if (top > IOSTAT_MAX_TOP) {
+        top = IOSTAT_MAX_TOP;
+    }
+
+    double busy[IOSTAT_MAX_TOP];
+    for (size_t i = 0; i < now->count; i++) {
+        const disk_dev_t *d = &now->devs[i];
+        const disk_dev_t *p = FIND_PREV(prev, i, d->name);
+
+        disk_rate_t r = {0};
+        snprintf(r.name, sizeof(r.name), "%s", d->name);
+        if (p && elapsed > 0) {
+            r.read_mbs = DELTA(rd_sectors) * 512 / 1e6 / elapsed;
+            r.write_mbs = DELTA(wr_sectors) * 512 / 1e6 / elapsed;
+            r.read_iops = DELTA(rd_ios) / elapsed;
+            r.write_iops = DELTA(wr_ios) / elapsed;
+            r.util = DELTA(io_ticks) / (elapsed * 1000.0) * 100.0;
+            if (r.util > 100.0) {
+                r.util = 100.0;
+            }
+        }
+
+        // Utilization first; idle devices are ordered by throughput
+        double value = r.util * 1e6 + r.read_mbs + r.write_mbs;
+        size_t slot = top_slot(busy, out->count, top, value);
+        disk_rate_t dropped =
+            (slot < top && out->count == top) ? out->top[top - 1] : r;
+        if (slot < top) {
+            size_t last = out->count < top ? out->count : top - 1;
+            memmove(&out->top[slot + 1], &out->top[slot],
+                    (last - slot) * sizeof(out->top[0]));
+            memmove(&busy[slot + 1], &busy[slot],
+                    (last - slot) * sizeof(busy[0]));
+            out->top[slot] = r;
+            busy[slot] = value;
+            if (out->count < top) {
+                out->count++;
+                continue;
+            }
+        }
+
+        // Whatever doesn't fit is summed up
+        out->hidden++;
+        out->rest.read_mbs += dropped.read_mbs;
+        out->rest.write_mbs += dropped.write_mbs;
+        out->rest.read_iops += dropped.read_iops;
+        out->rest.write_iops += dropped.write_iops;
+        if (dropped.util > out->rest.util) {
+            out->rest.util = dropped.util; // The busiest of them
+        }
+    }
+}
+
+void net_rates(const net_stats_t *prev, const net_stats_t *now, size_t top,
+               net_view_t *out) {
+    memset(out, 0, sizeof(*out));
+    double elapsed = now->timestamp - prev->timestamp;
+    if (top > IOSTAT_MAX_TOP) {
+        top = IOSTAT_MAX_TOP;
+    }
+
+    double busy[IOSTAT_MAX_TOP];
+    for (size_t i = 0; i < now->count; i++) {
+        const net_dev_t *d = &now->devs[i];
+        const net_dev_t *p = FIND_PREV(prev, i, d->name);
+
+        net_rate_t r = {0};
+        snprintf(r.name, sizeof(r.name), "%s", d->name);
+        if (p && elapsed > 0) {
+            r.rx_mbs = DELTA(rx_bytes) / 1e6 / elapsed;
+            r.tx_mbs = DELTA(tx_bytes) / 1e6 / elapsed;
+            r.rx_pps = DELTA(rx_packets) / elapsed;
+            r.tx_pps = DELTA(tx_packets) / elapsed;
+        }
+
+        double value = r.rx_mbs + r.tx_mbs + (r.rx_pps + r.tx_pps) / 1e6;
+        size_t slot = top_slot(busy, out->count, top, value);
+        net_rate_t dropped =
+            (slot < top && out->count == top) ? out->top[top - 1] : r;
+        if (slot < top) {
+            size_t last = out->count < top ? out->count : top - 1;
+            memmove(&out->top[slot + 1], &out->top[slot],
+                    (last - slot) * sizeof(out->top[0]));
+            memmove(&busy[slot + 1], &busy[slot],
+                    (last - slot) * sizeof(busy[0]));
+            out->top[slot] = r;
+            busy[slot] = value;
+            if (out->count < top) {
+                out->count++;
+                continue;
+            }
+        }
+
+        out->hidden++;
+        out->rest.rx_mbs += dropped.rx_mbs;
+        out->rest.tx_mbs += dropped.tx_mbs;
+        out->rest.rx_pps += dropped.rx_pps;
+        out->rest.tx_pps += dropped.tx_pps;
+    }
+}
+
+#undef DELTA
+#undef FIND_PREV
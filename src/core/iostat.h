@@ -0,0 +1,138 @@
+// src/core/iostat.h
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+// Most block devices and network interfaces toplite keeps track of
+#define IOSTAT_MAX_DEVICES 1024
+// Most devices shown per section, and the default
+#define IOSTAT_MAX_TOP 16
+#define IOSTAT_DEFAULT_TOP 4
+
+/**
+ * The counters of one block device from /proc/diskstats.
+ */
+typedef struct {
+    char name[32];                 // Device name (e.g. "nvme0n1")
+    unsigned long long rd_ios;     // Reads completed
+    unsigned long long rd_sectors; // Sectors read (512 bytes each)
+    unsigned long long wr_ios;     // Writes completed
+    unsigned long long wr_sectors; // Sectors written
+    unsigned long long io_ticks;   // Milliseconds spent doing I/O
+} disk_dev_t;
+
+/**
+ * The counters of every whole block device at one point in time.
+ */
+typedef struct {
+    disk_dev_t devs[IOSTAT_MAX_DEVICES];
+    size_t count;
+    double timestamp; // Monotonic time of the sample (seconds)
+} disk_stats_t;
+
+/**
+ * The counters of one network interface from /proc/net/dev.
+ */
+typedef struct {
+    char name[32];                 // Interface name (e.g. "eth0")
+    unsigned long long rx_bytes;   // Bytes received
+    unsigned long long rx_packets; // Packets received
+    unsigned long long tx_bytes;   // Bytes sent
+    unsigned long long tx_packets; // Packets sent
+} net_dev_t;
+
+/**
+ * The counters of every network interface at one point in time.
+ */
+typedef struct {
+    net_dev_t devs[IOSTAT_MAX_DEVICES];
+    size_t count;
+    double timestamp; // Monotonic time of the sample (seconds)
+} net_stats_t;
+
+/**
+ * The throughput of a block device between two samples.
+ */
+typedef struct {
+    char name[32];
+    double read_mbs;   // MB (10^6 bytes) read per second
+    double write_mbs;  // MB written per second
+    double read_iops;  // Reads per second
+    double write_iops; // Writes per second
+    double util;       // Time the device was busy in %
+} disk_rate_t;
+
+/**
+ * The throughput of a network interface between two samples.
+ */
+typedef struct {
+    char name[32];
+    double rx_mbs; // MB received per second
+    double tx_mbs; // MB sent per second
+    double rx_pps; // Packets received per second
+    double tx_pps; // Packets sent per second
+} net_rate_t;
+
+/**
+ * The busiest block devices, for the header.
+ */
+typedef struct {
+    disk_rate_t top[IOSTAT_MAX_TOP]; // Busiest first
+    size_t count;                    // Entries in top
+    size_t hidden;                   // Devices left out
+    disk_rate_t rest;                // Sum of the devices left out
+} disk_view_t;
+
+/**
+ * The busiest network interfaces, for the header.
+ */
+typedef struct {
+    net_rate_t top[IOSTAT_MAX_TOP]; // Busiest first
+    size_t count;                   // Entries in top
+    size_t hidden;                  // Interfaces left out
+    net_rate_t rest;                // Sum of the interfaces left out
+} net_view_t;
+
+/**
+ * @brief Reads the counters of the whole block devices (no partitions).
+ * @details The file stays open between calls and nothing is allocated.
+ *
+ * @param out Pointer to a disk_stats_t structure to populate.
+ * @param all Include loop and RAM disks.
+ * @return 0 on success, -1 on failure.
+ */
+int read_disk_stats(disk_stats_t *out, bool all);
+
+/**
+ * @brief Reads the counters of the network interfaces.
+ * @details The file stays open between calls and nothing is allocated.
+ *
+ * @param out Pointer to a net_stats_t structure to populate.
+ * @param all Include the loopback interface.
+ * @return 0 on success, -1 on failure.
+ */
+int read_net_stats(net_stats_t *out, bool all);
+
+/**
+ * @brief Calculates the throughput of the block devices between two samples
+ *        and picks the busiest (by utilization).
+ *
+ * @param prev Pointer to the previous disk_stats_t sample.
+ * @param now Pointer to the current disk_stats_t sample.
+ * @param top How many devices to pick (at most IOSTAT_MAX_TOP).
+ * @param out Pointer to a disk_view_t structure to populate.
+ */
+void disk_rates(const disk_stats_t *prev, const disk_stats_t *now, size_t top,
+                disk_view_t *out);
+
+/**
+ * @brief Calculates the throughput of the network interfaces between two
+ *        samples and picks the busiest (by bytes per second).
+ *
+ * @param prev Pointer to the previous net_stats_t sample.
+ * @param now Pointer to the current net_stats_t sample.
+ * @param top How many interfaces to pick (at most IOSTAT_MAX_TOP).
+ * @param out Pointer to a net_view_t structure to populate.
+ */
+void net_rates(const net_stats_t *prev, const net_stats_t *now, size_t top,
+               net_view_t *out);
@@ -0,0 +1,392 @@
+// src/core/irqstat.c
+#include "irqstat.h"
+#include "../util/util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Initial buffer per file; 256 CPUs make lines of ~3 KiB
+#define IRQSTAT_BUF_SIZE 65536
+
+/**
+ * A file read with read_file_at(), and the CPU numbers of its columns.
+ */
+typedef struct {
+    const char *path;
+    int fd;
+    char *buf;
+    size_t size;
+    int *cols;       // CPU number of each column
+    size_t ncols;    // Columns in the header line
+    size_t cols_cap; // Allocated entries in cols
+    int softirq;     // Rows are softirqs
+} irq_file_t;
+
+static irq_file_t g_files[] = {
+    {"/proc/interrupts", -1, NULL, 0, NULL, 0, 0, 0},
+    {"/proc/softirqs", -1, NULL, 0, NULL, 0, 0, 1},
+};
+
+#define IRQ_FILE_COUNT (sizeof(g_files) / sizeof(g_files[0]))
+
+void init_irq_stats(irq_stats_t *s) { memset(s, 0, sizeof(*s)); }
+
+void free_irq_stats(irq_stats_t *s) {
+    free(s->sources);
+    free(s->counts);
+    init_irq_stats(s);
+}
+
+void init_irq_view(irq_view_t *v) { memset(v, 0, sizeof(*v)); }
+
+void free_irq_view(irq_view_t *v) {
+    free(v->rates);
+    free(v->cpu_hard);
+    free(v->cpu_soft);
+    init_irq_view(v);
+}
+
+/**
+ * Reads a whole file into its buffer, growing the buffer until the file
+ * fits.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+static int read_irq_file(irq_file_t *f) {
+    for (;;) {
+        if (f->size == 0) {
+            f->buf = malloc(IRQSTAT_BUF_SIZE);
+            if (!f->buf) {
+                perror("Failed to allocate memory for interrupt counts");
+                return -1;
+            }
+            f->size = IRQSTAT_BUF_SIZE;
+        }
+
+        long len = read_file_at(&f->fd, f->path, f->buf, f->size);
+        if (len < 0) {
+            return -1;
+        }
+        // read_file_at() only cuts a file that filled the whole buffer
+        if ((size_t)len < f->size / 2) {
+            return 0;
+        }
+
+        char *buf = realloc(f->buf, f->size * 2);
+        if (!buf) {
+            perror("Failed to allocate memory for interrupt counts");
+            return -1;
+        }
+        f->buf = buf;
+        f->size *= 2;
+    }
+}
+
+static const char *skip_spaces(const char *p) {
+    while (*p == ' ') {
+        p++;
+    }
+    return p;
+}
+
+static const char *next_line(const char *p) {
+    const char *nl = strchr(p, '\n');
+    return nl ? nl + 1 : p + strlen(p);
+}
+
+/**
+ * Parses the header line ("CPU0 CPU1 ...") into the CPU number of each
+ * column. CPUs that are offline have no column.
+ *
+ * @return The highest CPU number + 1, or -1 on failure.
+ */
+static long parse_header(irq_file_t *f) {
+    long width = 0;
+    f->ncols = 0;
+    for (const char *p = skip_spaces(f->buf); strncmp(p, "CPU", 3) == 0;
+         p = skip_spaces(p)) {
+        p += 3;
+        int cpu = (int)strtoull_safe(&p);
+        if (f->ncols == f->cols_cap) {
+            size_t cap = f->cols_cap ? f->cols_cap * 2 : 64;
+            int *cols = realloc(f->cols, cap * sizeof(int));
+            if (!cols) {
+                perror("Failed to allocate memory for interrupt counts");
+                return -1;
+            }
+            f->cols = cols;
+            f->cols_cap = cap;
+        }
+        f->cols[f->ncols++] = cpu;
+        if (cpu + 1 > width) {
+            width = cpu + 1;
+        }
+    }
+    return f->ncols > 0 ? width : -1;
+}
+
+/**
+ * Makes room for one more source and returns its zeroed counters.
+ */
+static unsigned long long *add_source(irq_stats_t *s) {
+    if (s->nsources == s->capacity) {
+        size_t cap = s->capacity ? s->capacity * 2 : 64;
+        irq_source_t *sources = realloc(s->sources, cap * sizeof(*sources));
+        if (!sources) {
+            perror("Failed to allocate memory for interrupt counts");
+            return NULL;
+        }
+        s->sources = sources;
+        unsigned long long *counts =
+            realloc(s->counts, cap * s->width_capacity * sizeof(*counts));
+        if (!counts) {
+            perror("Failed to allocate memory for interrupt counts");
+            return NULL;
+        }
+        s->counts = counts;
+        s->capacity = cap;
+    }
+
+    unsigned long long *row = &s->counts[s->nsources * s->width];
+    memset(row, 0, s->width * sizeof(*row));
+    return row;
+}
+
+/**
+ * Copies the rest of a line, with runs of spaces squeezed to one.
+ */
+static void copy_desc(const char *p, char *out, size_t size) {
+    size_t n = 0;
+    p = skip_spaces(p);
+    while (*p && *p != '\n' && n + 1 < size) {
+        if (*p != ' ' || (p[1] != ' ' && p[1] != '\n' && p[1] != '\0')) {
+            out[n++] = *p;
+        }
+        p++;
+    }
+    out[n] = '\0';
+}
+
+/**
+ * Parses the rows of a file: "NAME: count per column [description]".
+ *
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+static int parse_rows(const irq_file_t *f, irq_stats_t *s) {
+    for (const char *p = next_line(f->buf); *p; p = next_line(p)) {
+        p = skip_spaces(p);
+        const char *colon = strchr(p, ':');
+        const char *nl = strchr(p, '\n');
+        if (!colon || (nl && colon > nl)) {
+            continue;
+        }
+
+        unsigned long long *row = add_source(s);
+        if (!row) {
+            return -1;
+        }
+        irq_source_t *src = &s->sources[s->nsources];
+        size_t len = (size_t)(colon - p);
+        if (len >= sizeof(src->name)) {
+            len = sizeof(src->name) - 1;
+        }
+        memcpy(src->name, p, len);
+        src->name[len] = '\0';
+        src->softirq = f->softirq;
+
+        // One count per column, without sscanf: these lines are very wide
+        const char *q = colon + 1;
+        size_t col = 0;
+        for (; col < f->ncols; col++) {
+            q = skip_spaces(q);
+            if (*q < '0' || *q > '9') {
+                break;
+            }
+            row[f->cols[col]] = strtoull_safe(&q);
+        }
+        if (col < f->ncols && f->ncols > 1) {
+            continue; // ERR and MIS are global counts, not per CPU
+        }
+
+        copy_desc(q, src->desc, sizeof(src->desc));
+        p = q;
+        s->nsources++;
+    }
+    return 0;
+}
+
+int read_irq_stats(irq_stats_t *out) {
+    out->nsources = 0;
+    out->timestamp = monotonic_seconds();
+
+    // Every row is laid out by CPU number, so the headers come first
+    long width = 0;
+    for (size_t i = 0; i < IRQ_FILE_COUNT; i++) {
+        if (read_irq_file(&g_files[i]) != 0) {
+            return -1;
+        }
+        long w = parse_header(&g_files[i]);
+        if (w < 0) {
+            return -1;
+        }
+        if (w > width) {
+            width = w;
+        }
+    }
+
+    if ((size_t)width > out->width_capacity) {
+        size_t cap = out->capacity ? out->capacity : 64;
+        unsigned long long *counts =
+            realloc(out->counts, cap * (size_t)width * sizeof(*counts));
+        if (!counts) {
+            perror("Failed to allocate memory for interrupt counts");
+            return -1;
+        }
+        out->counts = counts;
+        out->width_capacity = (size_t)width;
+        if (!out->sources) {
+            out->sources = malloc(cap * sizeof(*out->sources));
+            if (!out->sources) {
+                perror("Failed to allocate memory for interrupt counts");
+                return -1;
+            }
+        }
+        out->capacity = cap;
+    }
+    out->width = (size_t)width;
+
+    for (size_t i = 0; i < IRQ_FILE_COUNT; i++) {
+        if (parse_rows(&g_files[i], out) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Finds the previous counters of a source. The order rarely changes, so
+ * the same index is tried first.
+ */
+static const unsigned long long *find_prev(const irq_stats_t *prev, size_t i,
+                                           const irq_source_t *src) {
+    for (size_t n = 0; n < prev->nsources; n++) {
+        size_t j = (i + n) % prev->nsources;
+        const irq_source_t *p = &prev->sources[j];
+        if (p->softirq == src->softirq && strcmp(p->name, src->name) == 0) {
+            return &prev->counts[j * prev->width];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Grows the arrays of the view to hold 'count' sources and 'ncpus' CPUs.
+ *
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+static int reserve_view(irq_view_t *v, size_t count, size_t ncpus) {
+    if (count > v->capacity) {
+        irq_rate_t *rates = realloc(v->rates, count * sizeof(*rates));
+        if (!rates) {
+            perror("Failed to allocate memory for interrupt rates");
+            return -1;
+        }
+        v->rates = rates;
+        v->capacity = count;
+    }
+    if (ncpus > v->cpu_capacity) {
+        double *hard = realloc(v->cpu_hard, ncpus * sizeof(*hard));
+        if (!hard) {
+            perror("Failed to allocate memory for interrupt rates");
+            return -1;
+        }
+        v->cpu_hard = hard;
+        double *soft = realloc(v->cpu_soft, ncpus * sizeof(*soft));
+        if (!soft) {
+            perror("Failed to allocate memory for interrupt rates");
+            return -1;
+        }
+        v->cpu_soft = soft;
+        v->cpu_capacity = ncpus;
+    }
+    return 0;
+}
+
+/**
+ * Inserts a CPU among the busiest of a source, if it is one of them.
+ */
+static void insert_top_cpu(irq_rate_t *r, int cpu, double rate) {
+    size_t slot = r->ntop < IRQSTAT_TOP_CPUS ? r->ntop : IRQSTAT_TOP_CPUS;
+    while (slot > 0 && r->top[slot - 1].rate < rate) {
+        slot--;
+    }
+    if (slot == IRQSTAT_TOP_CPUS) {
+        return;
+    }
+
+    size_t last = r->ntop < IRQSTAT_TOP_CPUS ? r->ntop : IRQSTAT_TOP_CPUS - 1;
+    memmove(&r->top[slot + 1], &r->top[slot],
+            (last - slot) * sizeof(r->top[0]));
+    r->top[slot] = (irq_cpu_rate_t){cpu, rate};
+    if (r->ntop < IRQSTAT_TOP_CPUS) {
+        r->ntop++;
+    }
+}
+
+static int compare_rates(const void *a, const void *b) {
+    const irq_rate_t *r1 = a;
+    const irq_rate_t *r2 = b;
+    if (r1->rate != r2->rate) {
+        return r1->rate < r2->rate ? 1 : -1;
+    }
+    // Keep the order of the files among idle sources
+    return r1->source < r2->source ? -1 : (r1->source > r2->source);
+}
+
+int irq_rates(const irq_stats_t *prev, const irq_stats_t *now,
+              irq_view_t *out) {
+    if (reserve_view(out, now->nsources, now->width) != 0) {
+        return -1;
+    }
+    out->count = 0;
+    out->ncpus = now->width;
+    out->hard = 0;
+    out->soft = 0;
+    memset(out->cpu_hard, 0, out->ncpus * sizeof(double));
+    memset(out->cpu_soft, 0, out->ncpus * sizeof(double));
+
+    double elapsed = now->timestamp - prev->timestamp;
+    for (size_t i = 0; i < now->nsources; i++) {
+        const irq_source_t *src = &now->sources[i];
+        const unsigned long long *d = &now->counts[i * now->width];
+        const unsigned long long *p = find_prev(prev, i, src);
+
+        irq_rate_t *r = &out->rates[out->count++];
+        memset(r, 0, sizeof(*r));
+        r->source = src;
+        if (!p || elapsed <= 0) {
+            continue; // New source, or the first sample
+        }
+
+        double *per_cpu = src->softirq ? out->cpu_soft : out->cpu_hard;
+        size_t width = now->width < prev->width ? now->width : prev->width;
+        for (size_t cpu = 0; cpu < width; cpu++) {
+            if (d[cpu] <= p[cpu]) {
+                continue;
+            }
+            double rate = (double)(d[cpu] - p[cpu]) / elapsed;
+            r->rate += rate;
+            r->busy_cpus++;
+            per_cpu[cpu] += rate;
+            insert_top_cpu(r, (int)cpu, rate);
+        }
+        if (src->softirq) {
+            out->soft += r->rate;
+        } else {
+            out->hard += r->rate;
+        }
+    }
+
+    qsort(out->rates, out->count, sizeof(irq_rate_t), compare_rates);
+    return 0;
+}
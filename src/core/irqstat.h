@@ -0,0 +1,116 @@
+// src/core/irqstat.h
+#pragma once
+#include <stddef.h>
+
+// CPUs listed per source in the view, busiest first
+#define IRQSTAT_TOP_CPUS 4
+
+/**
+ * An interrupt source: a line of /proc/interrupts or /proc/softirqs.
+ */
+typedef struct {
+    char name[16]; // IRQ number, "NMI", "LOC", ... or softirq ("NET_RX")
+    char desc[64]; // Chip and handler of a hard IRQ ("" for softirqs)
+    int softirq;   // Comes from /proc/softirqs
+} irq_source_t;
+
+/**
+ * The per-CPU counts of every interrupt source at one point in time.
+ * counts holds one row of 'width' counters per source, indexed by CPU
+ * number; CPUs without a column in the files (offline) stay zero.
+ */
+typedef struct {
+    irq_source_t *sources;      // Hard IRQs first, then softirqs
+    unsigned long long *counts; // nsources x width
+    size_t nsources;            // Entries in sources
+    size_t capacity;            // Allocated entries in sources
+    size_t width;               // Highest CPU number + 1
+    size_t width_capacity;      // Allocated counters per source
+    double timestamp;           // Monotonic time of the sample (seconds)
+} irq_stats_t;
+
+/**
+ * The rate of an interrupt source on one CPU.
+ */
+typedef struct {
+    int cpu;     // CPU number
+    double rate; // Interrupts per second on this CPU
+} irq_cpu_rate_t;
+
+/**
+ * The rate of an interrupt source between two samples.
+ */
+typedef struct {
+    const irq_source_t *source;           // In the newer sample
+    double rate;                          // Interrupts per second, all CPUs
+    size_t busy_cpus;                     // CPUs with a non-zero rate
+    irq_cpu_rate_t top[IRQSTAT_TOP_CPUS]; // Busiest CPUs first
+    size_t ntop;                          // Entries in top
+} irq_rate_t;
+
+/**
+ * Everything the interrupt view shows.
+ */
+typedef struct {
+    irq_rate_t *rates;   // Busiest source first
+    size_t count;        // Entries in rates
+    size_t capacity;     // Allocated entries in rates
+    double *cpu_hard;    // Hard IRQs per second, indexed by CPU number
+    double *cpu_soft;    // Softirqs per second, indexed by CPU number
+    size_t ncpus;        // Entries in cpu_hard and cpu_soft
+    size_t cpu_capacity; // Allocated entries in cpu_hard and cpu_soft
+    double hard;         // Hard IRQs per second, all CPUs
+    double soft;         // Softirqs per second, all CPUs
+} irq_view_t;
+
+/**
+ * @brief Initializes an irq_stats_t.
+ *
+ * @param s Pointer to the irq_stats_t to initialize.
+ */
+void init_irq_stats(irq_stats_t *s);
+
+/**
+ * @brief Frees the memory allocated for an irq_stats_t.
+ *
+ * @param s Pointer to the irq_stats_t to free.
+ */
+void free_irq_stats(irq_stats_t *s);
+
+/**
+ * @brief Reads the per-CPU counts of /proc/interrupts and /proc/softirqs.
+ * @details Both files stay open between calls. The rows are parsed column by
+ *          column after the CPU numbers of the header line, so a sample only
+ *          allocates when the files grow. The arrays of 'out' are reused.
+ *
+ * @param out Pointer to an initialized irq_stats_t to populate.
+ * @return 0 on success, -1 on failure.
+ */
+int read_irq_stats(irq_stats_t *out);
+
+/**
+ * @brief Initializes an irq_view_t.
+ *
+ * @param v Pointer to the irq_view_t to initialize.
+ */
+void init_irq_view(irq_view_t *v);
+
+/**
+ * @brief Frees the memory allocated for an irq_view_t.
+ *
+ * @param v Pointer to the irq_view_t to free.
+ */
+void free_irq_view(irq_view_t *v);
+
+/**
+ * @brief Calculates the per-CPU rate of every source between two samples
+ *        and sorts the sources by rate.
+ * @details The view points into 'now', which must outlive it.
+ *
+ * @param prev Pointer to the previous irq_stats_t sample.
+ * @param now Pointer to the current irq_stats_t sample.
+ * @param out Pointer to an initialized irq_view_t to populate.
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+int irq_rates(const irq_stats_t *prev, const irq_stats_t *now,
+              irq_view_t *out);
@@ -0,0 +1,189 @@
+// src/core/numa.c
+#include "numa.h"
+#include "../util/util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Topology, read once: the online nodes and the node index of every CPU
+static int g_node_ids[NUMA_MAX_NODES];
+static unsigned g_node_ncpus[NUMA_MAX_NODES];
+static size_t g_node_count = 0;
+static short g_cpu_node[NUMA_MAX_CPUS]; // Index into g_node_ids (-1: none)
+static int g_probed = 0;
+
+/**
+ * Expands a sysfs list such as "0-3,8,10-11" into its numbers.
+ *
+ * @return The number of entries stored in out (at most max).
+ */
+static size_t parse_list(const char *s, int *out, size_t max) {
+    size_t n = 0;
+    while (*s >= '0' && *s <= '9') {
+        unsigned long lo = strtoull_safe(&s), hi = lo;
+        if (*s == '-') {
+            s++;
+            hi = strtoull_safe(&s);
+        }
+        for (unsigned long i = lo; i <= hi && n < max; i++) {
+            out[n++] = (int)i;
+        }
+        if (*s == ',') {
+            s++;
+        }
+    }
+    return n;
+}
+
+/**
+ * Reads a sysfs list file (see parse_list()).
+ */
+static size_t read_list(const char *path, int *out, size_t max) {
+    char *buf;
+    if (!read_text_file(path, &buf, NULL)) {
+        return 0;
+    }
+    size_t n = parse_list(buf, out, max);
+    free(buf);
+    return n;
+}
+
+static void probe_topology(void) {
+    g_probed = 1;
+    for (size_t i = 0; i < NUMA_MAX_CPUS; i++) {
+        g_cpu_node[i] = -1;
+    }
+
+    g_node_count =
+        read_list(NUMA_NODE_ROOT "/online", g_node_ids, NUMA_MAX_NODES);
+    for (size_t n = 0; n < g_node_count; n++) {
+        char path[128];
+        snprintf(path, sizeof(path), NUMA_NODE_ROOT "/node%d/cpulist",
+                 g_node_ids[n]);
+
+        static int cpus[NUMA_MAX_CPUS];
+        size_t ncpus = read_list(path, cpus, NUMA_MAX_CPUS);
+        for (size_t i = 0; i < ncpus; i++) {
+            if (cpus[i] < NUMA_MAX_CPUS) {
+                g_cpu_node[cpus[i]] = (short)n;
+            }
+        }
+        g_node_ncpus[n] = (unsigned)ncpus;
+    }
+}
+
+size_t numa_node_count(void) {
+    if (!g_probed) {
+        probe_topology();
+    }
+    return g_node_count > 0 ? g_node_count : 1;
+}
+
+int numa_cpu_node(int cpu) {
+    if (!g_probed) {
+        probe_topology();
+    }
+    if (cpu < 0 || cpu >= NUMA_MAX_CPUS || g_cpu_node[cpu] < 0) {
+        return -1;
+    }
+    return g_node_ids[g_cpu_node[cpu]];
+}
+
+/**
+ * Reads nodeN/meminfo, whose lines look like "Node 0 MemTotal:   123 kB".
+ */
+static int read_node_meminfo(numa_node_t *node) {
+    char path[128];
+    snprintf(path, sizeof(path), NUMA_NODE_ROOT "/node%d/meminfo", node->id);
+    char *buf;
+    if (!read_text_file(path, &buf, NULL)) {
+        return -1;
+    }
+
+    char *save, *line = strtok_r(buf, "\n", &save);
+    while (line) {
+        // Skip "Node N "
+        const char *key = strchr(line, ' ');
+        key = key ? strchr(key + 1, ' ') : NULL;
+        if (key) {
+            key++;
+            const char *value = strchr(key, ':');
+            if (value) {
+                value++;
+                if (strncmp(key, "MemTotal:", 9) == 0) {
+                    node->mem_total = strtoull_safe(&value);
+                } else if (strncmp(key, "MemFree:", 8) == 0) {
+                    node->mem_free = strtoull_safe(&value);
+                } else if (strncmp(key, "FilePages:", 10) == 0) {
+                    node->mem_file = strtoull_safe(&value);
+                }
+            }
+        }
+        line = strtok_r(NULL, "\n", &save);
+    }
+    free(buf);
+    return 0;
+}
+
+/**
+ * Adds the "cpuN" lines of /proc/stat to the node of each CPU.
+ */
+static int read_node_cpu_times(numa_stats_t *out) {
+    char *buf;
+    if (!read_text_file("/proc/stat", &buf, NULL)) {
+        return -1;
+    }
+
+    const char *p = buf;
+    while (p && strncmp(p, "cpu", 3) == 0) {
+        p += 3;
+        if (*p >= '0' && *p <= '9') {
+            unsigned long long cpu = strtoull_safe(&p);
+            if (cpu < NUMA_MAX_CPUS && g_cpu_node[cpu] >= 0) {
+                cpu_times_t *t = &out->nodes[g_cpu_node[cpu]].cpu;
+                t->user += strtoull_safe(&p);
+                t->nice += strtoull_safe(&p);
+                t->system += strtoull_safe(&p);
+                t->idle += strtoull_safe(&p);
+                t->iowait += strtoull_safe(&p);
+                t->irq += strtoull_safe(&p);
+                t->softirq += strtoull_safe(&p);
+                t->steal += strtoull_safe(&p);
+                t->guest += strtoull_safe(&p);
+                t->guest_nice += strtoull_safe(&p);
+            }
+        }
+        // The cpu lines come first; stop at the first other line
+        p = strchr(p, '\n');
+        p = p ? p + 1 : NULL;
+    }
+    free(buf);
+    return 0;
+}
+
+int read_numa_stats(numa_stats_t *out) {
+    if (numa_node_count() < 2) {
+        return -1;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->count = g_node_count;
+    for (size_t n = 0; n < g_node_count; n++) {
+        out->nodes[n].id = g_node_ids[n];
+        out->nodes[n].ncpus = g_node_ncpus[n];
+        read_node_meminfo(&out->nodes[n]);
+    }
+    return read_node_cpu_times(out);
+}
+
+void numa_cpu_percent(const numa_stats_t *prev, const numa_stats_t *now,
+                      numa_view_t *out) {
+    out->stats = now;
+    for (size_t n = 0; n < now->count; n++) {
+        if (n < prev->count) {
+            cpu_percent(&prev->nodes[n].cpu, &now->nodes[n].cpu, &out->cpu[n]);
+        } else {
+            memset(&out->cpu[n], 0, sizeof(out->cpu[n]));
+        }
+    }
+}
@@ -0,0 +1,73 @@
+// src/core/numa.h
+#pragma once
+#include "system.h"
+#include <stddef.h>
+
+// Sysfs directory with one nodeN subdirectory per NUMA node
+#define NUMA_NODE_ROOT "/sys/devices/system/node"
+
+// Most nodes and CPUs toplite keeps track of
+#define NUMA_MAX_NODES 64
+#define NUMA_MAX_CPUS 4096
+
+/**
+ * The counters of one NUMA node.
+ */
+typedef struct {
+    int id;                       // Node number (the N of nodeN)
+    unsigned ncpus;               // Online CPUs of the node
+    cpu_times_t cpu;              // Sum of the CPU times of its CPUs
+    unsigned long long mem_total; // Memory of the node in KiB
+    unsigned long long mem_free;  // Free memory in KiB
+    unsigned long long mem_file;  // Page cache in KiB
+} numa_node_t;
+
+/**
+ * The counters of every NUMA node at one point in time.
+ */
+typedef struct {
+    numa_node_t nodes[NUMA_MAX_NODES];
+    size_t count;
+} numa_stats_t;
+
+/**
+ * Everything the header needs to show the NUMA section.
+ */
+typedef struct {
+    const numa_stats_t *stats;         // Latest counters
+    cpu_percent_t cpu[NUMA_MAX_NODES]; // CPU usage of each node
+} numa_view_t;
+
+/**
+ * @brief Get the number of online NUMA nodes.
+ * @details The topology (nodes and the node of each CPU) is read once.
+ *
+ * @return The number of nodes; 1 on machines without NUMA.
+ */
+size_t numa_node_count(void);
+
+/**
+ * @brief Get the NUMA node of a CPU.
+ *
+ * @return The node number, or -1 if unknown.
+ */
+int numa_cpu_node(int cpu);
+
+/**
+ * @brief Reads the memory (nodeN/meminfo) and CPU times (/proc/stat) of
+ *        every node.
+ *
+ * @param out Pointer to a numa_stats_t structure to populate.
+ * @return 0 on success, -1 on failure or if there is only one node.
+ */
+int read_numa_stats(numa_stats_t *out);
+
+/**
+ * @brief Calculates the CPU usage of every node between two samples.
+ *
+ * @param prev The previous sample.
+ * @param now The current sample.
+ * @param out Pointer to a numa_view_t whose cpu array is filled.
+ */
+void numa_cpu_percent(const numa_stats_t *prev, const numa_stats_t *now,
+                      numa_view_t *out);
@@ -0,0 +1,244 @@
+// src/core/proc_events.c
+#include "proc_events.h"
+#include "../util/util.h"
+#include <errno.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Socket buffer for the events of a whole frame (a fork storm sends
+// thousands); going above rmem_max needs CAP_NET_ADMIN
+#define EVENTS_RCVBUF (8 << 20)
+// Upper limit of /proc/sys/kernel/pid_max on 64-bit kernels
+#define EVENTS_PID_MAX_LIMIT (4 << 20)
+
+#define WORD_BITS (sizeof(unsigned long) * 8)
+
+static int g_fd = -1;
+// One bit per possible PID: alive, and created since the last read
+static unsigned long *g_alive = NULL;
+static unsigned long *g_born = NULL;
+static size_t g_words = 0;
+// Counts collected since the last proc_events_read()
+static proc_events_t g_counts;
+// PIDs returned by proc_events_pids()
+static pid_t *g_pids = NULL;
+static size_t g_pids_capacity = 0;
+
+/**
+ * Sizes the PID bitmaps from /proc/sys/kernel/pid_max.
+ */
+static size_t pid_limit(void) {
+    char *buf;
+    if (!read_text_file("/proc/sys/kernel/pid_max", &buf, NULL)) {
+        return EVENTS_PID_MAX_LIMIT;
+    }
+    const char *p = buf;
+    size_t limit = (size_t)strtoull_safe(&p);
+    free(buf);
+    return (limit > 0 && limit <= EVENTS_PID_MAX_LIMIT) ? limit
+                                                        : EVENTS_PID_MAX_LIMIT;
+}
+
+/**
+ * Tells the proc connector to start (or stop) multicasting events to us.
+ */
+static int send_mcast_op(enum proc_cn_mcast_op op) {
+    union {
+        struct nlmsghdr nl;
+        char raw[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(op))];
+    } msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.nl.nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(op));
+    msg.nl.nlmsg_type = NLMSG_DONE;
+    msg.nl.nlmsg_pid = (uint32_t)getpid();
+
+    struct cn_msg *cn = NLMSG_DATA(&msg.nl);
+    cn->id.idx = CN_IDX_PROC;
+    cn->id.val = CN_VAL_PROC;
+    cn->len = sizeof(op);
+    memcpy(cn->data, &op, sizeof(op));
+
+    return send(g_fd, &msg, msg.nl.nlmsg_len, 0) < 0 ? -1 : 0;
+}
+
+int proc_events_open(void) {
+    g_fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK,
+                  NETLINK_CONNECTOR);
+    if (g_fd < 0) {
+        return -1;
+    }
+
+    // Before Linux 6.6, joining the proc connector group fails with EPERM
+    // without CAP_NET_ADMIN
+    struct sockaddr_nl addr = {
+        .nl_family = AF_NETLINK,
+        .nl_groups = CN_IDX_PROC,
+        .nl_pid = 0,
+    };
+    int rcvbuf = EVENTS_RCVBUF;
+    if (bind(g_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        send_mcast_op(PROC_CN_MCAST_LISTEN) != 0) {
+        proc_events_close();
+        return -1;
+    }
+    if (setsockopt(g_fd, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf,
+                   sizeof(rcvbuf)) != 0) {
+        setsockopt(g_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+
+    g_words = (pid_limit() + WORD_BITS - 1) / WORD_BITS;
+    g_alive = calloc(g_words, sizeof(*g_alive));
+    g_born = calloc(g_words, sizeof(*g_born));
+    if (!g_alive || !g_born) {
+        perror("Failed to allocate memory for the PID set");
+        proc_events_close();
+        return -1;
+    }
+    memset(&g_counts, 0, sizeof(g_counts));
+    return 0;
+}
+
+void proc_events_close(void) {
+    if (g_fd >= 0) {
+        send_mcast_op(PROC_CN_MCAST_IGNORE);
+        close(g_fd);
+        g_fd = -1;
+    }
+    free(g_alive);
+    free(g_born);
+    free(g_pids);
+    g_alive = g_born = NULL;
+    g_pids = NULL;
+    g_words = g_pids_capacity = 0;
+}
+
+/**
+ * Sets or clears the bit of a PID. A PID beyond the bitmap (pid_max was
+ * raised) makes the set inexact.
+ *
+ * @return The previous value of the bit.
+ */
+static int update_bit(unsigned long *bits, pid_t pid, int set) {
+    size_t word = (size_t)pid / WORD_BITS;
+    if (pid < 0 || word >= g_words) {
+        g_counts.lost = 1;
+        return 0;
+    }
+    unsigned long mask = 1UL << ((size_t)pid % WORD_BITS);
+    int was = (bits[word] & mask) != 0;
+    bits[word] = set ? (bits[word] | mask) : (bits[word] & ~mask);
+    return was;
+}
+
+/**
+ * Applies a single event. Only events of thread group leaders matter, as
+ * the PID set holds processes.
+ */
+static void handle_event(const struct proc_event *ev) {
+    switch (ev->what) {
+    case PROC_EVENT_FORK:
+        if (ev->event_data.fork.child_pid == ev->event_data.fork.child_tgid) {
+            update_bit(g_alive, ev->event_data.fork.child_tgid, 1);
+            update_bit(g_born, ev->event_data.fork.child_tgid, 1);
+            g_counts.forks++;
+        }
+        break;
+    case PROC_EVENT_EXEC:
+        g_counts.execs++;
+        break;
+    case PROC_EVENT_EXIT:
+        if (ev->event_data.exit.process_pid ==
+            ev->event_data.exit.process_tgid) {
+            pid_t pid = ev->event_data.exit.process_tgid;
+            update_bit(g_alive, pid, 0);
+            if (update_bit(g_born, pid, 0)) {
+                g_counts.short_lived++;
+            }
+            g_counts.exits++;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+int proc_events_read(proc_events_t *out) {
+    // Page-sized, aligned for the netlink headers
+    union {
+        struct nlmsghdr nl;
+        char raw[8192];
+    } buf;
+
+    while (true) {
+        ssize_t n = recv(g_fd, &buf, sizeof(buf), MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == ENOBUFS) {
+                g_counts.lost = 1; // The socket buffer overflowed
+                continue;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            break; // EAGAIN: drained
+        }
+
+        int len = (int)n;
+        for (struct nlmsghdr *nl = &buf.nl; NLMSG_OK(nl, len);
+             nl = NLMSG_NEXT(nl, len)) {
+            if (nl->nlmsg_type == NLMSG_ERROR ||
+                nl->nlmsg_type == NLMSG_NOOP) {
+                continue;
+            }
+            const struct cn_msg *cn = NLMSG_DATA(nl);
+            if (cn->id.idx != CN_IDX_PROC || cn->id.val != CN_VAL_PROC) {
+                continue;
+            }
+            handle_event((const struct proc_event *)cn->data);
+        }
+    }
+
+    // A new frame starts: whatever is alive now will be shown
+    memset(g_born, 0, g_words * sizeof(*g_born));
+    *out = g_counts;
+    memset(&g_counts, 0, sizeof(g_counts));
+    return out->lost ? -1 : 0;
+}
+
+const pid_t *proc_events_pids(size_t *count) {
+    size_t n = 0;
+    for (size_t w = 0; w < g_words; w++) {
+        unsigned long bits = g_alive[w];
+        while (bits) {
+            if (n == g_pids_capacity) {
+                size_t new_capacity = n == 0 ? 1024 : n * 2;
+                pid_t *new_pids =
+                    realloc(g_pids, new_capacity * sizeof(*new_pids));
+                if (!new_pids) {
+                    perror("Failed to allocate memory for the PID set");
+                    return NULL;
+                }
+                g_pids = new_pids;
+                g_pids_capacity = new_capacity;
+            }
+            g_pids[n++] = (pid_t)(w * WORD_BITS + __builtin_ctzl(bits));
+            bits &= bits - 1;
+        }
+    }
+    *count = n;
+    return g_pids;
+}
+
+void proc_events_reconcile(const proc_list_t *list) {
+    memset(g_alive, 0, g_words * sizeof(*g_alive));
+    for (size_t i = 0; i < list->count; i++) {
+        update_bit(g_alive, list->procs[i].pid, 1);
+    }
+}
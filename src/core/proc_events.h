@@ -0,0 +1,64 @@
+// src/core/proc_events.h
+#pragma once
+#include "process.h"
+#include <stddef.h>
+#include <sys/types.h>
+
+// Even with events, /proc is scanned in full this often to catch anything
+// the events missed
+#define PROC_EVENTS_RECONCILE_SEC 30.0
+
+/**
+ * Process lifecycle events received from the netlink proc connector since
+ * the previous proc_events_read(). Threads are not counted.
+ */
+typedef struct {
+    unsigned long forks;       // Processes created
+    unsigned long execs;       // exec() calls
+    unsigned long exits;       // Processes that exited
+    unsigned long short_lived; // Created and exited in between (never shown)
+    int lost;                  // Events were dropped (counts are too low)
+} proc_events_t;
+
+/**
+ * @brief Subscribes to the fork, exec and exit events of all processes.
+ * @details Needs CAP_NET_ADMIN before Linux 6.6. The PID set starts
+ *          empty, so the caller must pass the result of a full scan to
+ *          proc_events_reconcile() before relying on proc_events_pids().
+ *
+ * @return 0 on success, -1 if the proc connector is not available.
+ */
+int proc_events_open(void);
+
+/**
+ * @brief Unsubscribes and frees the PID set.
+ */
+void proc_events_close(void);
+
+/**
+ * @brief Applies the pending events to the PID set.
+ * @details Never blocks. If the socket buffer overflowed, events were lost
+ *          and the PID set may be wrong until the next reconciliation.
+ *
+ * @param out Where the events since the previous call are counted.
+ * @return 0 if the PID set is exact, -1 if it needs a reconciliation.
+ */
+int proc_events_read(proc_events_t *out);
+
+/**
+ * @brief Get the PIDs of all live processes, in ascending order.
+ *
+ * @param count Where the number of PIDs is stored.
+ * @return The PIDs, valid until the next proc_events_* call, or NULL on
+ *         allocation failure.
+ */
+const pid_t *proc_events_pids(size_t *count);
+
+/**
+ * @brief Replaces the PID set with the processes of a full /proc scan.
+ * @details Events that arrive during the scan are still pending and are
+ *          applied by the next proc_events_read().
+ *
+ * @param list The processes found by collect_all_processes().
+ */
+void proc_events_reconcile(const proc_list_t *list);
@@ -1,9 +1,69 @@
 // src/core/proc_iter.c
-#include "system.h"
+#include "proc_iter.h"
 #include <ctype.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+
+// Bytes of /proc/[pid]/stat read to find the state: the PID, the comm (at
+// most 64 bytes for kernel threads) and the state itself
+#define STATE_READ_SIZE 128
+
+/**
+ * Reads the state of a single task from /proc/[pid]/stat and adds it to the
+ * counts. Tasks that vanished in the meantime are ignored.
+ *
+ * @param pid The process ID to inspect.
+ * @param out Pointer to the task_counts_t structure to update.
+ */
+static void tally_task_state(pid_t pid, task_counts_t *out) {
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    // /proc/[pid]/stat format: "pid (comm) state ...". Only the head is
+    // read, without stdio, since this runs for every task of the host.
+    char buf[STATE_READ_SIZE + 1];
+    ssize_t n = read(fd, buf, STATE_READ_SIZE);
+    close(fd);
+    if (n <= 0) {
+        return;
+    }
+    buf[n] = '\0';
+
+    // comm may contain ')' itself, so the last one ends it
+    const char *paren = strrchr(buf, ')');
+    if (paren && paren[1] == ' ' && paren[2] != '\0') {
+        char state = paren[2];
+        out->total++;
+        switch (state) {
+        case 'R': // Running
+            out->running++;
+            break;
+        case 'S': // Interruptible sleep
+        case 'D': // Uninterruptible disk sleep
+        case 'I': // Idle kernel thread
+            out->sleeping++;
+            break;
+        case 'T': // Stopped (by job control signal)
+        case 't': // Tracing stop (stopped by debugger)
+            out->stopped++;
+            break;
+        case 'Z': // Zombie (terminated but not reaped by parent)
+            out->zombie++;
+            break;
+        default:
+            // Unknown state (or very rare), we can ignore it
+            break;
+        }
+    }
+}
 
 int scan_task_states(task_counts_t *out) {
     memset(out, 0, sizeof(*out));
@@ -22,48 +82,21 @@ int scan_task_states(task_counts_t *out) {
             continue;
         }
 
-        char path[256] = {0};
-        snprintf(path, sizeof(path), "/proc/%s/stat", e->d_name);
-        FILE *f = fopen(path, "r");
-        if (!f) {
-            continue;
-        }
-
-        // /proc/[pid]/stat format: "pid (comm) state ..."
-        int pid;
-        char comm[256] = {0};
-        char state = '?';
-        // NOTE: it will fail if a process name (comm) contains a right
-        // parenthesis ). But this is rare in practice, and we can ignore it for
-        // now.
-        if (fscanf(f, "%d (%255[^)]) %c", &pid, comm, &state) == 3) {
-            out->total++;
-            switch (state) {
-            case 'R': // Running
-                out->running++;
-                break;
-            case 'S': // Interruptible sleep
-            case 'D': // Uninterruptible disk sleep
-            case 'I': // Idle kernel thread
-                out->sleeping++;
-                break;
-            case 'T': // Stopped (by job control signal)
-            case 't': // Tracing stop (stopped by debugger)
-                out->stopped++;
-                break;
-            case 'Z': // Zombie (terminated but not reaped by parent)
-                out->zombie++;
-                break;
-            default:
-                // Unknown state (or very rare), we can ignore it
-                break;
-            }
-        }
-        // Close the file descriptor
-        fclose(f);
+        tally_task_state(atoi(e->d_name), out);
     }
     // Close the directory stream
     closedir(d);
 
     return 0;
 }
+
+int scan_task_states_pids(const pid_t *pids, size_t count,
+                          task_counts_t *out) {
+    memset(out, 0, sizeof(*out));
+
+    for (size_t i = 0; i < count; i++) {
+        tally_task_state(pids[i], out);
+    }
+
+    return 0;
+}
@@ -1,6 +1,8 @@
 // src/core/proc_iter.h
 #pragma once
 #include "system.h"
+#include <stddef.h>
+#include <sys/types.h>
 
 /**
  * @brief Scan the /proc filesystem to count the number of tasks in various
@@ -10,3 +12,15 @@
  * @return 0 on success, -1 on error (e.g., if /proc cannot be opened).
  */
 int scan_task_states(task_counts_t *out);
+
+/**
+ * @brief Count the task states of the given processes only.
+ * @details Same as scan_task_states(), but for a scoped view (e.g. a cgroup)
+ * instead of the whole /proc filesystem.
+ *
+ * @param pids Array of PIDs to inspect.
+ * @param count Number of entries in pids.
+ * @param out Pointer to a TaskCounts structure to fill with the counts.
+ * @return 0 on success.
+ */
+int scan_task_states_pids(const pid_t *pids, size_t count, task_counts_t *out);
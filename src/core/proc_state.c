@@ -0,0 +1,158 @@
+// src/core/proc_state.c
+#include "proc_state.h"
+#include "history.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// All known processes, keyed by PID
+static proc_state_t *g_states = NULL;
+static unsigned g_generation = 0;
+
+// Cumulative mode: exited states are kept; the totals of the ones whose PID
+// was reused end up in a single sum
+static int g_keep_exited = 0;
+static proc_totals_t g_folded;
+static size_t g_folded_count = 0;
+
+static int has_totals(const proc_state_t *st) {
+    const proc_totals_t *t = &st->totals;
+    return t->cpu_ticks || t->read_bytes || t->write_bytes || t->minflt ||
+           t->majflt;
+}
+
+static void add_totals(proc_totals_t *sum, const proc_totals_t *t) {
+    sum->cpu_ticks += t->cpu_ticks;
+    sum->read_bytes += t->read_bytes;
+    sum->write_bytes += t->write_bytes;
+    sum->minflt += t->minflt;
+    sum->majflt += t->majflt;
+}
+
+static void free_state(proc_state_t *st) {
+    free(st->cgroup);
+    history_release(st->history);
+    free(st);
+}
+
+/**
+ * Clears everything derived from a previous process with the same PID.
+ */
+static void reset_state(proc_state_t *st, unsigned long long start_ticks) {
+    if (g_keep_exited && has_totals(st)) {
+        add_totals(&g_folded, &st->totals);
+        g_folded_count++;
+    }
+    free(st->cgroup);
+    history_release(st->history);
+    pid_t pid = st->pid;
+    UT_hash_handle hh = st->hh;
+
+    memset(st, 0, sizeof(*st));
+    st->pid = pid;
+    st->hh = hh;
+    st->start_ticks = start_ticks;
+    st->history = -1;
+}
+
+void proc_state_begin_collection(void) { g_generation++; }
+
+void proc_state_end_collection(void) {
+    proc_state_t *st, *tmp;
+    HASH_ITER(hh, g_states, st, tmp) {
+        if (st->generation == g_generation || st->exited) {
+            continue;
+        }
+        if (g_keep_exited && has_totals(st)) {
+            st->exited = 1;
+            history_release(st->history);
+            st->history = -1;
+            continue;
+        }
+        HASH_DEL(g_states, st);
+        free_state(st);
+    }
+}
+
+proc_state_t *proc_state_get(pid_t pid, unsigned long long start_ticks,
+                             int *is_new) {
+    proc_state_t *st = NULL;
+    HASH_FIND_INT(g_states, &pid, st);
+    *is_new = 0;
+
+    if (!st) {
+        st = calloc(1, sizeof(*st));
+        if (!st) {
+            perror("Failed to allocate memory for process state");
+            return NULL;
+        }
+        st->pid = pid;
+        st->start_ticks = start_ticks;
+        st->history = -1;
+        HASH_ADD_INT(g_states, pid, st);
+        *is_new = 1;
+    } else if (st->start_ticks != start_ticks) {
+        // Same PID, different process
+        reset_state(st, start_ticks);
+        *is_new = 1;
+    } else {
+        st->exited = 0; // Back in view (e.g. a scoped collection)
+    }
+
+    st->generation = g_generation;
+    return st;
+}
+
+void proc_state_mark_seen(proc_state_t *st) { st->generation = g_generation; }
+
+proc_state_t *proc_state_find(pid_t pid) {
+    proc_state_t *st = NULL;
+    HASH_FIND_INT(g_states, &pid, st);
+    return st;
+}
+
+void proc_state_keep_exited(int keep) {
+    g_keep_exited = keep;
+    if (!keep) {
+        proc_state_reset_totals();
+    }
+}
+
+int proc_state_foreach_exited(int (*fn)(const proc_state_t *st, void *ctx),
+                              void *ctx) {
+    proc_state_t *st, *tmp;
+    int ret = 0;
+    HASH_ITER(hh, g_states, st, tmp) {
+        if (st->exited && (ret = fn(st, ctx)) != 0) {
+            break;
+        }
+    }
+    return ret;
+}
+
+void proc_state_reset_totals(void) {
+    proc_state_t *st, *tmp;
+    HASH_ITER(hh, g_states, st, tmp) {
+        if (st->exited) {
+            HASH_DEL(g_states, st);
+            free_state(st);
+        } else {
+            memset(&st->totals, 0, sizeof(st->totals));
+        }
+    }
+    memset(&g_folded, 0, sizeof(g_folded));
+    g_folded_count = 0;
+}
+
+size_t proc_state_folded(proc_totals_t *sum) {
+    *sum = g_folded;
+    return g_folded_count;
+}
+
+void proc_state_clear(void) {
+    proc_state_t *st, *tmp;
+    HASH_ITER(hh, g_states, st, tmp) {
+        HASH_DEL(g_states, st);
+        free_state(st);
+    }
+}
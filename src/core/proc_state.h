@@ -0,0 +1,155 @@
+// src/core/proc_state.h
+#pragma once
+#include "process.h"
+#include <sys/types.h>
+#include <uthash.h>
+
+/**
+ * Cumulative I/O counters of a process (from /proc/[pid]/io).
+ */
+typedef struct {
+    unsigned long long read_bytes;  // Bytes fetched from the storage layer
+    unsigned long long write_bytes; // Bytes sent to the storage layer
+    unsigned long long syscr;       // Number of read syscalls
+    unsigned long long syscw;       // Number of write syscalls
+} proc_io_t;
+
+/**
+ * Scheduler counters of a process (from /proc/[pid]/schedstat).
+ */
+typedef struct {
+    unsigned long long run_ns;  // Time spent on a CPU
+    unsigned long long wait_ns; // Time spent runnable, waiting on a run queue
+    unsigned long long slices;  // Number of timeslices run
+} proc_schedstat_t;
+
+/**
+ * Memory sizes of a process from /proc/[pid]/smaps_rollup.
+ */
+typedef struct {
+    unsigned long pss;  // Proportional set size in KiB
+    unsigned long uss;  // Unique set size (private pages) in KiB
+    unsigned long swap; // Swapped out anonymous memory in KiB
+} proc_smaps_t;
+
+/**
+ * Holds what toplite remembers about a process between two collections
+ * (e.g. the previous CPU counters needed for rates). An entry lives as long
+ * as the process: it is dropped as soon as a collection no longer sees the
+ * PID, and reset when the PID is reused by a new process.
+ */
+typedef struct {
+    pid_t pid;                      // Process ID (hash key)
+    unsigned long long start_ticks; // starttime, to detect PID reuse
+    unsigned long long cpu_ticks;   // utime + stime at the last sample
+    unsigned long long minflt;      // Minor faults at the last sample
+    unsigned long long majflt;      // Major faults at the last sample
+    double sample_time;             // Monotonic time of the last sample
+    unsigned generation;            // Last collection that saw the process
+    char *cgroup;                   // Cached cgroup v2 path (or NULL)
+    proc_io_t io;                   // I/O counters at the last sample
+    double io_sample_time;          // Monotonic time of the last I/O sample
+    int has_io;                     // io / io_sample_time are valid
+    unsigned long long vcsw;        // Voluntary context switches
+    unsigned long long ivcsw;       // Involuntary context switches
+    double ctxsw_sample_time;       // Monotonic time of the last vcsw/ivcsw
+    int has_ctxsw;                  // vcsw / ivcsw are valid
+    proc_schedstat_t sched;         // schedstat at the last sample
+    double sched_sample_time;       // Monotonic time of the last schedstat
+    int has_sched;                  // sched / sched_sample_time are valid
+    int history;                    // History ring (-1: none)
+    proc_smaps_t smaps;             // Last smaps_rollup values
+    double smaps_time;              // When smaps was read (0: never)
+    double smaps_due;               // When smaps should be read again
+    int has_smaps;                  // smaps is valid (the read succeeded)
+    size_t sample_slot;             // Index + 1 in the sampling cache (0: no)
+    int sample_hot;                 // Among the busiest (sampling mode)
+    proc_totals_t totals;           // Used since the baseline (cumulative)
+    int exited;                     // Gone, kept for its totals
+    uid_t uid;                      // Owner, for exited processes
+    char comm[32];                  // comm, for exited processes
+    UT_hash_handle hh;
+} proc_state_t;
+
+/**
+ * @brief Marks the start of a new collection.
+ * @details Every state that is not looked up again before the matching
+ *          proc_state_end_collection() is considered gone.
+ */
+void proc_state_begin_collection(void);
+
+/**
+ * @brief Drops the states of all processes that were not seen since the last
+ *        proc_state_begin_collection().
+ */
+void proc_state_end_collection(void);
+
+/**
+ * @brief Finds (or creates) the state of a process.
+ * @details If the PID was reused by a new process (different start time), the
+ *          old state is reset first. The returned state is marked as seen in
+ *          the current collection.
+ *
+ * @param pid The process ID.
+ * @param start_ticks The process start time (field 22 of /proc/[pid]/stat).
+ * @param is_new Set to non-zero if the state was just created (or reset).
+ * @return Pointer to the state, or NULL if memory allocation fails.
+ */
+proc_state_t *proc_state_get(pid_t pid, unsigned long long start_ticks,
+                             int *is_new);
+
+/**
+ * @brief Marks a state as seen in the current collection, like
+ *        proc_state_get() does, without reading the process.
+ *
+ * @param st The state.
+ */
+void proc_state_mark_seen(proc_state_t *st);
+
+/**
+ * @brief Finds the state of a process without creating it or marking it as
+ *        seen.
+ *
+ * @param pid The process ID.
+ * @return Pointer to the state, or NULL if the process is unknown.
+ */
+proc_state_t *proc_state_find(pid_t pid);
+
+/**
+ * @brief Keeps the states of processes that exit (cumulative mode).
+ * @details A state that is not seen in a collection is then marked as
+ *          exited instead of dropped, if it accumulated anything. When its
+ *          PID is reused, its totals are folded into a single sum (see
+ *          proc_state_folded()).
+ *
+ * @param keep Non-zero to keep exited states.
+ */
+void proc_state_keep_exited(int keep);
+
+/**
+ * @brief Calls a function for every exited state.
+ *
+ * @param fn The function; a non-zero return value stops the iteration.
+ * @param ctx Passed to fn.
+ * @return The last return value of fn (0 if it was never called).
+ */
+int proc_state_foreach_exited(int (*fn)(const proc_state_t *st, void *ctx),
+                              void *ctx);
+
+/**
+ * @brief Zeroes the totals of all states and drops the exited ones.
+ */
+void proc_state_reset_totals(void);
+
+/**
+ * @brief Gets the totals of exited processes whose PID was reused.
+ *
+ * @param sum Set to the sum of their totals.
+ * @return The number of such processes.
+ */
+size_t proc_state_folded(proc_totals_t *sum);
+
+/**
+ * @brief Releases all remembered process states.
+ */
+void proc_state_clear(void);
@@ -1,12 +1,188 @@
 // src/core/process.c
 #include "process.h"
+#include "../util/util.h"
+#include "cgroup.h"
+#include "history.h"
+#include "proc_state.h"
+#include "system.h"
+#include "uring.h"
 #include <ctype.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h> // For sysconf
 
+// Optional fields (proc_field_t) read by the next collections
+static unsigned g_optional_fields = 0;
+// Clock ticks per second and page size in KiB, refreshed at the start of
+// every collection
+static long g_hz = 0;
+static unsigned long g_page_kib = 4;
+
+// Read buffers for /proc/[pid]/stat and /proc/[pid]/statm
+#define STAT_BUF_SIZE 1024
+#define STATM_BUF_SIZE 128
+// Optional fields that are read through the /proc/[pid] directory
+#define DIR_FIELDS                                                             \
+    (PROC_FIELD_DETAILS | PROC_FIELD_IO | PROC_FIELD_CTXSW | PROC_FIELD_SCHED)
+
+// Processes read per io_uring submission: a statx() of /proc/[pid] for the
+// owner and a linked open/read/close chain for stat and for statm
+#define URING_BATCH 128
+#define URING_SQES_PER_PROC 7
+
+/**
+ * A process queued for the io_uring collector.
+ */
+typedef struct {
+    pid_t pid;
+    char dir[24];        // "/proc/[pid]"
+    char stat_path[32];  // "/proc/[pid]/stat"
+    char statm_path[32]; // "/proc/[pid]/statm"
+    struct statx stx;    // Owner of the directory
+    int stx_res;         // statx() result
+    int stat_len;        // Bytes read from stat (or a negative errno)
+    int statm_len;       // Bytes read from statm (or a negative errno)
+    int queued;          // All its requests are in the ring
+    char stat_buf[STAT_BUF_SIZE];
+    char statm_buf[STATM_BUF_SIZE];
+} uring_job_t;
+
+// The ring (NULL: synchronous reads) and the processes queued for it
+static uring_t *g_ring = NULL;
+static uring_job_t *g_jobs = NULL;
+static size_t g_job_count = 0;
+
+// Sampling mode (see process_set_sampling()); a period of 0 reads every
+// process in every collection
+static unsigned g_sample_period = 0;
+static unsigned g_sample_top = 0;
+static unsigned g_sample_round = 0;        // Collections since sampling began
+static proc_info_t *g_sample_cache = NULL; // The last list (see sample_slot)
+static size_t g_sample_cache_count = 0;
+static size_t g_sample_cache_capacity = 0;
+static pid_t *g_sample_hot = NULL;  // Busiest PIDs of the last collection
+static size_t *g_sample_pick = NULL; // Scratch space to pick them
+static size_t g_sample_hot_count = 0;
+static proc_sampling_t g_sampling;  // What the last collection read
+static double g_collect_time = 0;   // Start of the current collection
+
+// Cumulative mode (see process_set_cumulative()): the baseline as clock
+// ticks since boot (to tell processes started after it), monotonic time
+// (to tell samples taken before it) and wall clock time
+static int g_cumulative = 0;
+static unsigned long long g_baseline_ticks = 0;
+static double g_baseline_mono = 0;
+static time_t g_baseline_time = 0;
+static proc_cumulative_t g_cumulative_sum; // Of the last collection
+
+void process_set_optional_fields(unsigned fields) {
+    g_optional_fields = fields;
+}
+
+int process_set_collector(proc_collector_t collector) {
+    if (collector == PROC_COLLECTOR_SYNC) {
+        uring_close(g_ring);
+        free(g_jobs);
+        g_ring = NULL;
+        g_jobs = NULL;
+        return 0;
+    }
+    if (g_ring) {
+        return 0;
+    }
+
+    g_jobs = calloc(URING_BATCH, sizeof(*g_jobs));
+    if (!g_jobs) {
+        perror("Failed to allocate memory for the io_uring collector");
+        return -1;
+    }
+    g_ring = uring_open(URING_BATCH * URING_SQES_PER_PROC, URING_BATCH * 2);
+    if (!g_ring) {
+        free(g_jobs);
+        g_jobs = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+const char *process_collector_name(void) {
+    return g_ring ? "io_uring" : "sync";
+}
+
+int process_set_sampling(unsigned period, unsigned top) {
+    pid_t *hot = NULL;
+    size_t *pick = NULL;
+    if (period > 0 && top > 0) {
+        hot = malloc(top * sizeof(*hot));
+        pick = malloc(top * sizeof(*pick));
+        if (!hot || !pick) {
+            perror("Failed to allocate memory for sampling");
+            free(hot);
+            free(pick);
+            return -1;
+        }
+    }
+
+    // The busiest processes of the last collection lose their mark
+    for (size_t i = 0; i < g_sample_hot_count; i++) {
+        proc_state_t *st = proc_state_find(g_sample_hot[i]);
+        if (st) {
+            st->sample_hot = 0;
+        }
+    }
+    free(g_sample_hot);
+    free(g_sample_pick);
+    g_sample_hot = hot;
+    g_sample_pick = pick;
+    g_sample_hot_count = 0;
+    g_sample_period = period;
+    g_sample_top = top;
+    g_sample_round = 0;
+    g_sample_cache_count = 0;
+    return 0;
+}
+
+int process_get_sampling(proc_sampling_t *out) {
+    if (g_sample_period == 0) {
+        return -1;
+    }
+    *out = g_sampling;
+    out->period = g_sample_period;
+    return 0;
+}
+
+void process_set_cumulative(int on) {
+    if (on && !g_cumulative) {
+        g_cumulative = 1;
+        proc_state_keep_exited(1);
+        process_reset_totals();
+    } else if (!on && g_cumulative) {
+        g_cumulative = 0;
+        proc_state_keep_exited(0);
+    }
+}
+
+void process_reset_totals(void) {
+    double uptime = 0;
+    read_uptime(&uptime);
+    g_baseline_ticks = (unsigned long long)(uptime * sys_hz());
+    g_baseline_mono = monotonic_seconds();
+    g_baseline_time = time(NULL);
+    proc_state_reset_totals();
+}
+
+int process_get_cumulative(proc_cumulative_t *out) {
+    if (!g_cumulative) {
+        return -1;
+    }
+    *out = g_cumulative_sum;
+    return 0;
+}
+
 void init_process_list(proc_list_t *list) {
     list->procs = NULL;
     list->count = 0;
@@ -34,20 +210,19 @@ static int add_process_to_list(proc_list_t *list,
     return 0; // Success
 }
 
-static void get_command_line(pid_t pid,    // [in]
+static void get_command_line(int dir_fd,   // [in]
                              char *buffer, // [out]
                              size_t size   // [in]
 ) {
-    char path[256] = {0};
-    snprintf(path, sizeof(path), "/proc/%d/cmdline", pid);
-    FILE *f = fopen(path, "r");
-    if (!f) {
+    int fd = openat(dir_fd, "cmdline", O_RDONLY);
+    if (fd < 0) {
         buffer[0] = '\0'; // No command line available
         return;
     }
 
-    size_t bytes_read = fread(buffer, 1, size - 1, f);
-    fclose(f);
+    ssize_t n = read(fd, buffer, size - 1);
+    close(fd);
+    size_t bytes_read = (n > 0) ? (size_t)n : 0;
     buffer[bytes_read] = '\0'; // Null-terminate the string
 
     // Replace null bytes with spaces for display
@@ -59,121 +234,1034 @@ static void get_command_line(pid_t pid,    // [in]
 }
 
 /**
- * Collects all processes from the /proc filesystem and fills the ProcessList.
- * This function reads process information from /proc/[pid]/stat and
- * /proc/[pid]/status files, and calculates memory usage percentages based on
- * the total system memory.
+ * Fills the user name and, if the process has one, the command line.
+ * Kernel threads have an empty cmdline and keep comm as their command.
  *
- * @param list Pointer to the proc_list_t where processes will be stored.
+ * @param dir_fd File descriptor of the /proc/[pid] directory, or -1 if only
+ * the user name can be filled.
+ * @param p Pointer to the proc_info_t to complete.
+ */
+static void load_details_at(int dir_fd, proc_info_t *p) {
+    // Convert UID to username
+    struct passwd *pw = getpwuid(p->uid);
+    if (pw) {
+        strncpy(p->user, pw->pw_name, sizeof(p->user) - 1);
+    } else {
+        // Failed? Use UID as a fallback
+        snprintf(p->user, sizeof(p->user), "%u", p->uid);
+    }
+
+    // Get full command line
+    if (dir_fd >= 0) {
+        char cmdline[sizeof(p->command)];
+        get_command_line(dir_fd, cmdline, sizeof(cmdline));
+        if (cmdline[0] != '\0') {
+            memcpy(p->command, cmdline, sizeof(p->command));
+        }
+    }
+    p->has_details = 1;
+}
+
+void process_load_details(proc_info_t *p) {
+    if (p->has_details) {
+        return;
+    }
+
+    char dir_path[64];
+    snprintf(dir_path, sizeof(dir_path), "/proc/%d", p->pid);
+    int dir_fd = open(dir_path, O_RDONLY | O_DIRECTORY);
+    load_details_at(dir_fd, p);
+    if (dir_fd >= 0) {
+        close(dir_fd);
+    }
+}
+
+/**
+ * Reads the cumulative I/O counters of a process from /proc/[pid]/io.
+ * The file is only readable for processes we are allowed to ptrace.
+ *
+ * @param dir_fd File descriptor of the /proc/[pid] directory.
+ * @param io Pointer to the proc_io_t to fill.
+ * @return 0 on success, -1 if the file cannot be read.
+ */
+static int read_process_io(int dir_fd, proc_io_t *io) {
+    int fd = openat(dir_fd, "io", O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    char buf[512];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) {
+        return -1;
+    }
+    buf[n] = '\0';
+
+    // "rchar: N\nwchar: N\nsyscr: N\nsyscw: N\nread_bytes: N\n..."
+    memset(io, 0, sizeof(*io));
+    const char *p = buf;
+    while (*p) {
+        const char *colon = strchr(p, ':');
+        if (!colon) {
+            break;
+        }
+        size_t key_len = (size_t)(colon - p);
+        const char *value = colon + 1;
+
+        if (key_len == 5 && strncmp(p, "syscr", 5) == 0) {
+            io->syscr = strtoull_safe(&value);
+        } else if (key_len == 5 && strncmp(p, "syscw", 5) == 0) {
+            io->syscw = strtoull_safe(&value);
+        } else if (key_len == 10 && strncmp(p, "read_bytes", 10) == 0) {
+            io->read_bytes = strtoull_safe(&value);
+        } else if (key_len == 11 && strncmp(p, "write_bytes", 11) == 0) {
+            io->write_bytes = strtoull_safe(&value);
+        }
+
+        const char *eol = strchr(value, '\n');
+        if (!eol) {
+            break;
+        }
+        p = eol + 1;
+    }
+    return 0;
+}
+
+/**
+ * Fills the I/O rate fields of a process from the difference between its
+ * current /proc/[pid]/io counters and the ones remembered in its state.
+ * io_valid stays 0 if the counters cannot be read (e.g. no permission) or if
+ * this is the first sample.
+ */
+static void collect_io_rates(int dir_fd, proc_state_t *st, double now,
+                             int is_new, proc_info_t *proc_info) {
+    proc_io_t io;
+    if (read_process_io(dir_fd, &io) != 0) {
+        st->has_io = 0;
+        return;
+    }
+
+    if (g_cumulative) {
+        if (!is_new && st->has_io && st->io_sample_time >= g_baseline_mono) {
+            st->totals.read_bytes +=
+                io.read_bytes >= st->io.read_bytes
+                    ? io.read_bytes - st->io.read_bytes
+                    : 0;
+            st->totals.write_bytes +=
+                io.write_bytes >= st->io.write_bytes
+                    ? io.write_bytes - st->io.write_bytes
+                    : 0;
+        } else if (!st->has_io && st->start_ticks >= g_baseline_ticks) {
+            // Started after the baseline: everything it did counts
+            st->totals.read_bytes += io.read_bytes;
+            st->totals.write_bytes += io.write_bytes;
+        }
+    }
+
+    double elapsed = now - st->io_sample_time;
+    if (!is_new && st->has_io && elapsed > 0) {
+#define RATE(field)                                                            \
+    ((io.field >= st->io.field) ? (double)(io.field - st->io.field) / elapsed  \
+                                : 0.0)
+        proc_info->io_read_rate = RATE(read_bytes);
+        proc_info->io_write_rate = RATE(write_bytes);
+        proc_info->io_syscr_rate = RATE(syscr);
+        proc_info->io_syscw_rate = RATE(syscw);
+        proc_info->io_valid = 1;
+#undef RATE
+    }
+
+    st->io = io;
+    st->io_sample_time = now;
+    st->has_io = 1;
+}
+
+/**
+ * Reads the context switch counters from the end of /proc/[pid]/status.
+ *
+ * @return 0 on success, -1 if the file cannot be read.
+ */
+static int read_process_ctxsw(int dir_fd, unsigned long long *vcsw,
+                              unsigned long long *ivcsw) {
+    int fd = openat(dir_fd, "status", O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    char buf[4096];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) {
+        return -1;
+    }
+    buf[n] = '\0';
+
+    // The two counters are the last lines of the file
+    const char *v = strstr(buf, "\nvoluntary_ctxt_switches:\t");
+    const char *iv = strstr(buf, "\nnonvoluntary_ctxt_switches:\t");
+    if (!v || !iv) {
+        return -1;
+    }
+    // The values follow a tab, which strtoull_safe() doesn't skip
+    v += strlen("\nvoluntary_ctxt_switches:\t");
+    iv += strlen("\nnonvoluntary_ctxt_switches:\t");
+    *vcsw = strtoull_safe(&v);
+    *ivcsw = strtoull_safe(&iv);
+    return 0;
+}
+
+/**
+ * Fills the context switch rates of a process, like collect_io_rates().
+ */
+static void collect_ctxsw_rates(int dir_fd, proc_state_t *st, double now,
+                                int is_new, proc_info_t *proc_info) {
+    unsigned long long vcsw, ivcsw;
+    if (read_process_ctxsw(dir_fd, &vcsw, &ivcsw) != 0) {
+        st->has_ctxsw = 0;
+        return;
+    }
+
+    double elapsed = now - st->ctxsw_sample_time;
+    if (!is_new && st->has_ctxsw && elapsed > 0) {
+        proc_info->vcsw_rate =
+            vcsw >= st->vcsw ? (double)(vcsw - st->vcsw) / elapsed : 0.0;
+        proc_info->ivcsw_rate =
+            ivcsw >= st->ivcsw ? (double)(ivcsw - st->ivcsw) / elapsed : 0.0;
+        proc_info->ctxsw_valid = 1;
+    }
+
+    st->vcsw = vcsw;
+    st->ivcsw = ivcsw;
+    st->ctxsw_sample_time = now;
+    st->has_ctxsw = 1;
+}
+
+/**
+ * Reads /proc/[pid]/schedstat: "run_ns wait_ns slices". Unlike stat, the
+ * times are in nanoseconds, not clock ticks.
+ *
+ * @return 0 on success, -1 if the file cannot be read.
+ */
+static int read_process_schedstat(int dir_fd, proc_schedstat_t *sched) {
+    int fd = openat(dir_fd, "schedstat", O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    char buf[128];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) {
+        return -1;
+    }
+    buf[n] = '\0';
+
+    const char *p = buf;
+    sched->run_ns = strtoull_safe(&p);
+    sched->wait_ns = strtoull_safe(&p);
+    sched->slices = strtoull_safe(&p);
+    return 0;
+}
+
+/**
+ * Fills the scheduler fields of a process, like collect_io_rates().
+ */
+static void collect_sched_rates(int dir_fd, proc_state_t *st, double now,
+                                int is_new, proc_info_t *proc_info) {
+    proc_schedstat_t sched;
+    if (read_process_schedstat(dir_fd, &sched) != 0) {
+        st->has_sched = 0;
+        return;
+    }
+
+    double elapsed = now - st->sched_sample_time;
+    if (!is_new && st->has_sched && elapsed > 0) {
+#define DELTA(field)                                                           \
+    ((sched.field >= st->sched.field)                                          \
+         ? (double)(sched.field - st->sched.field)                             \
+         : 0.0)
+        // ns per second of wall time / 1e7 = percent
+        proc_info->sched_run_percent = DELTA(run_ns) / (elapsed * 1e7);
+        proc_info->sched_wait_percent = DELTA(wait_ns) / (elapsed * 1e7);
+        proc_info->sched_slice_rate = DELTA(slices) / elapsed;
+        proc_info->sched_valid = 1;
+#undef DELTA
+    }
+
+    st->sched = sched;
+    st->sched_sample_time = now;
+    st->has_sched = 1;
+}
+
+/**
+ * Reads the start of a small file below /proc/[pid] in a single read() and
+ * NUL-terminates it. Every file used here fits into one page.
+ *
+ * @return The number of bytes read, or -1 if the file cannot be read.
+ */
+static ssize_t read_small_file(int dir_fd, const char *name, char *buf,
+                               size_t size) {
+    int fd = openat(dir_fd, name, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t n = read(fd, buf, size - 1);
+    close(fd);
+    if (n <= 0) {
+        return -1;
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+/**
+ * Parses the memory sizes of a process from /proc/[pid]/statm.
+ * statm is a single line of page counts and is much cheaper for the kernel to
+ * generate than /proc/[pid]/status.
+ *
+ * @param buf Contents of /proc/[pid]/statm.
+ * @param proc_info Pointer to the proc_info_t whose VIRT/RES/SHR are filled.
+ */
+static void parse_process_statm(const char *buf, proc_info_t *proc_info) {
+    // "size resident shared text lib data dt", all in pages
+    const char *p = buf;
+    proc_info->virt_mem = strtoull_safe(&p) * g_page_kib;
+    proc_info->res_mem = strtoull_safe(&p) * g_page_kib;
+    proc_info->shr_mem = strtoull_safe(&p) * g_page_kib;
+}
+
+/**
+ * Adds the CPU time and faults of a process since its previous sample to
+ * its totals (cumulative mode). A sample from before the baseline is only
+ * a starting point, unless the process started after the baseline: then
+ * everything it did counts.
+ */
+static void accumulate_totals(proc_state_t *st, int is_new,
+                              unsigned long long cpu_ticks,
+                              unsigned long long minflt,
+                              unsigned long long majflt) {
+#define ADD(field, now)                                                        \
+    st->totals.field += (now) >= st->field ? (now) - st->field : 0
+
+    if (!is_new && st->sample_time >= g_baseline_mono) {
+        ADD(cpu_ticks, cpu_ticks);
+        ADD(minflt, minflt);
+        ADD(majflt, majflt);
+    } else if (is_new && st->start_ticks >= g_baseline_ticks) {
+        st->totals.cpu_ticks += cpu_ticks;
+        st->totals.minflt += minflt;
+        st->totals.majflt += majflt;
+    }
+
+#undef ADD
+}
+
+/**
+ * Builds the information of a single process from the contents of
+ * /proc/[pid]/stat and /proc/[pid]/statm, reads the optional fields and
+ * appends it to the list. Memory usage percentages are based on the total
+ * system memory.
+ *
+ * @param list Pointer to the proc_list_t where the process will be stored.
+ * @param dir_fd File descriptor of the /proc/[pid] directory (only used for
+ * the optional fields, see DIR_FIELDS).
+ * @param pid The process ID.
+ * @param uid Owner of the /proc/[pid] directory.
+ * @param stat_buf Contents of /proc/[pid]/stat.
+ * @param statm_buf Contents of /proc/[pid]/statm.
  * @param system_mem_total Total system memory in kilobytes (from
  * /proc/meminfo).
- * @return 0 on success, -1 on error (e.g., if /proc cannot be opened or
- *         if memory allocation fails).
+ * @return 0 on success, -1 if memory allocation fails.
  */
-int collect_all_processes(proc_list_t *list,
-                          unsigned long long system_mem_total) {
-    DIR *d = opendir("/proc");
-    if (!d) {
-        perror("Could not open /proc");
+static int add_process(proc_list_t *list, int dir_fd, pid_t pid, uid_t uid,
+                       const char *stat_buf, const char *statm_buf,
+                       unsigned long long system_mem_total) {
+    proc_info_t proc_info = {0};
+    proc_info.pid = pid;
+
+    // Parse /proc/[pid]/stat. comm may contain ')' and anything that looks
+    // like the fields after it, so the last ')' ends it
+    const char *open_paren = strchr(stat_buf, '(');
+    const char *close_paren = strrchr(stat_buf, ')');
+    if (!open_paren || !close_paren || close_paren < open_paren) {
+        return 0; // Not a stat line; skip the process
+    }
+    char comm[256] = {0};
+    size_t comm_len = (size_t)(close_paren - open_paren - 1);
+    if (comm_len >= sizeof(comm)) {
+        comm_len = sizeof(comm) - 1;
+    }
+    memcpy(comm, open_paren + 1, comm_len);
+
+    long priority_long = 0;
+    unsigned long utime = 0, stime = 0;
+    unsigned long minflt = 0, majflt = 0;
+    int parsed = sscanf(close_paren + 1,
+                        " %c "                 // Field 3: state
+                        "%d "                  // Field 4: ppid
+                        "%*d %*d %*d %*d %*u " // Skip 5-9
+                        "%lu "                 // Field 10: minflt
+                        "%*u "                 // Field 11: cminflt
+                        "%lu "                 // Field 12: majflt
+                        "%*u "                 // Field 13: cmajflt
+                        "%lu "                 // Field 14: utime
+                        "%lu "                 // Field 15: stime
+                        "%*d %*d "             // Skip 16-17
+                        "%ld "                 // Field 18: priority
+                        "%ld "                 // Field 19: nice
+                        "%ld "                 // Field 20: num_threads
+                        "%*d "                 // Field 21: itrealvalue
+                        "%llu "                // Field 22: starttime
+                        "%*s %*s %*s %*s %*s " // Skip 23-27
+                        "%*s %*s %*s %*s %*s " // Skip 28-32
+                        "%*s %*s %*s %*s %*s " // Skip 33-37
+                        "%*s "                 // Field 38: exit_signal
+                        "%d",                  // Field 39: processor
+                        &proc_info.state, &proc_info.ppid, &minflt, &majflt,
+                        &utime, &stime, &priority_long, &proc_info.nice,
+                        &proc_info.num_threads, &proc_info.uptime_ticks,
+                        &proc_info.last_cpu);
+    if (parsed != 11) {
+        return 0; // Truncated or malformed; skip the process
+    }
+    proc_info.cpu_ticks = (unsigned long long)utime + stime;
+
+    if (priority_long < 0) {
+        strncpy(proc_info.priority, "rt", sizeof(proc_info.priority) - 1);
+    } else {
+        snprintf(proc_info.priority, sizeof(proc_info.priority), "%ld",
+                 priority_long);
+    }
+
+    parse_process_statm(statm_buf, &proc_info);
+
+    // comm stands in for the command line until the details are loaded
+    proc_info.uid = uid;
+    strncpy(proc_info.command, comm, sizeof(proc_info.command) - 1);
+    if (g_optional_fields & PROC_FIELD_DETAILS) {
+        load_details_at(dir_fd, &proc_info);
+    }
+
+    // Calculate %MEM
+    if (system_mem_total > 0) {
+        proc_info.mem_percent =
+            ((double)proc_info.res_mem / system_mem_total) * 100.0;
+    }
+
+    // Calculate %CPU from the CPU time consumed since the last collection
+    int is_new;
+    proc_state_t *st = proc_state_get(pid, proc_info.uptime_ticks, &is_new);
+    if (!st) {
         return -1;
     }
+    double now = monotonic_seconds();
+    if (!is_new && now > st->sample_time && g_hz > 0 &&
+        proc_info.cpu_ticks >= st->cpu_ticks) {
+        double cpu_seconds =
+            (double)(proc_info.cpu_ticks - st->cpu_ticks) / g_hz;
+        proc_info.cpu_percent = cpu_seconds / (now - st->sample_time) * 100.0;
+    }
 
-    list->count = 0; // Reset list for a fresh collection
-    struct dirent *e;
+    // Page faults come from the same stat read, so they are always known
+    if (!is_new && now > st->sample_time) {
+        double elapsed = now - st->sample_time;
+        proc_info.minflt_rate =
+            minflt >= st->minflt ? (minflt - st->minflt) / elapsed : 0.0;
+        proc_info.majflt_rate =
+            majflt >= st->majflt ? (majflt - st->majflt) / elapsed : 0.0;
+    }
+    if (g_cumulative) {
+        accumulate_totals(st, is_new, proc_info.cpu_ticks, minflt, majflt);
+        st->uid = uid;
+        snprintf(st->comm, sizeof(st->comm), "%s", comm);
+    }
+    st->cpu_ticks = proc_info.cpu_ticks;
+    st->minflt = minflt;
+    st->majflt = majflt;
+    st->sample_time = now;
 
-    while ((e = readdir(d)) != NULL) {
-        if (!isdigit((unsigned char)e->d_name[0])) {
-            // Skip non-numeric directories (not a process (PID))
-            continue;
+    // The cgroup of a process rarely changes; read it once per process
+    if ((g_optional_fields & PROC_FIELD_CGROUP) && !st->cgroup) {
+        char cgroup[512];
+        if (read_process_cgroup(pid, cgroup, sizeof(cgroup)) == 0) {
+            st->cgroup = strdup(cgroup);
         }
+    }
+    proc_info.cgroup = st->cgroup;
 
-        pid_t pid = atoi(e->d_name);
-        proc_info_t proc_info = {0};
-        proc_info.pid = pid;
+    if (g_optional_fields & PROC_FIELD_IO) {
+        collect_io_rates(dir_fd, st, now, is_new, &proc_info);
+    }
+    if (g_optional_fields & PROC_FIELD_CTXSW) {
+        collect_ctxsw_rates(dir_fd, st, now, is_new, &proc_info);
+    }
+    if (g_optional_fields & PROC_FIELD_SCHED) {
+        collect_sched_rates(dir_fd, st, now, is_new, &proc_info);
+    }
+
+    // Keep the recent values for trends (a no-op if the history is off)
+    if (st->history < 0) {
+        st->history = history_acquire();
+    }
+    if (st->history >= 0) {
+        history_sample_t sample = {
+            .cpu = (float)proc_info.cpu_percent,
+            .io = proc_info.io_valid ? (float)(proc_info.io_read_rate +
+                                               proc_info.io_write_rate)
+                                     : -1.0f,
+            .res_kib = (uint32_t)proc_info.res_mem,
+        };
+        history_record(st->history, &sample);
+    }
+    proc_info.history = st->history;
+
+    // smaps_rollup is only read on demand; carry the last values over
+    proc_info.pss_mem = st->smaps.pss;
+    proc_info.uss_mem = st->smaps.uss;
+    proc_info.swap_mem = st->smaps.swap;
+    proc_info.smaps_time = st->smaps_time;
+    proc_info.smaps_due = st->smaps_due;
+    proc_info.smaps_valid = st->has_smaps;
+
+    proc_info.totals = st->totals;
+    proc_info.sample_time = now;
+    st->sample_slot = list->count + 1;
+    g_sampling.read++;
+    return add_process_to_list(list, proc_info);
+}
+
+/**
+ * Reads the information of a single process and appends it to the list.
+ * The owner is taken from the /proc/[pid] directory itself. A process that
+ * vanished while being read is silently skipped.
+ *
+ * @param list Pointer to the proc_list_t where the process will be stored.
+ * @param dir_fd File descriptor of the /proc/[pid] directory.
+ * @param pid The process ID to read.
+ * @param system_mem_total Total system memory in kilobytes.
+ * @return 0 on success (or skipped process), -1 if memory allocation fails.
+ */
+static int collect_process_at(proc_list_t *list, int dir_fd, pid_t pid,
+                              unsigned long long system_mem_total) {
+    // /proc/[pid] is owned by the process' effective UID, so a single
+    // fstat() replaces parsing the Uid line of /proc/[pid]/status
+    struct stat dir_stat;
+    if (fstat(dir_fd, &dir_stat) != 0) {
+        return 0;
+    }
+
+    char stat_buf[STAT_BUF_SIZE], statm_buf[STATM_BUF_SIZE];
+    if (read_small_file(dir_fd, "stat", stat_buf, sizeof(stat_buf)) < 0 ||
+        read_small_file(dir_fd, "statm", statm_buf, sizeof(statm_buf)) < 0) {
+        return 0;
+    }
+    return add_process(list, dir_fd, pid, dir_stat.st_uid, stat_buf,
+                       statm_buf, system_mem_total);
+}
 
-        char stat_path[256] = {0};
-        snprintf(stat_path, sizeof(stat_path), "/proc/%d/stat", pid);
-        FILE *stat_file = fopen(stat_path, "r");
-        if (!stat_file)
+/**
+ * Reads /proc/[pid]/smaps_rollup. The kernel walks every page table of the
+ * process to produce it, which can take milliseconds for a large process.
+ *
+ * @return 0 on success, -1 if the file cannot be read.
+ */
+static int read_process_smaps(pid_t pid, proc_smaps_t *smaps) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", pid);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    char buf[2048];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) {
+        return -1;
+    }
+    buf[n] = '\0';
+
+    // An address range line, then "Key:   N kB" lines
+    memset(smaps, 0, sizeof(*smaps));
+    const char *p = strchr(buf, '\n');
+    while (p && *++p) {
+        const char *colon = strchr(p, ':');
+        if (!colon) {
+            break;
+        }
+        size_t key_len = (size_t)(colon - p);
+        const char *value = colon + 1;
+
+        if (key_len == 3 && strncmp(p, "Pss", 3) == 0) {
+            smaps->pss = strtoull_safe(&value);
+        } else if (key_len == 13 && (strncmp(p, "Private_Clean", 13) == 0 ||
+                                     strncmp(p, "Private_Dirty", 13) == 0)) {
+            smaps->uss += strtoull_safe(&value);
+        } else if (key_len == 4 && strncmp(p, "Swap", 4) == 0) {
+            smaps->swap = strtoull_safe(&value);
+        }
+        p = strchr(value, '\n');
+    }
+    return 0;
+}
+
+int process_load_smaps(proc_info_t *p) {
+    proc_smaps_t smaps;
+    double start = monotonic_seconds();
+    int ret = read_process_smaps(p->pid, &smaps);
+    double now = monotonic_seconds();
+
+    // Keep the reads of each process to a small share of the time
+    double wait = (now - start) * SMAPS_COST_FACTOR;
+    if (ret != 0) {
+        wait = SMAPS_RETRY_AGE;
+    } else if (wait < SMAPS_MIN_AGE) {
+        wait = SMAPS_MIN_AGE;
+    }
+
+    p->smaps_time = now;
+    p->smaps_due = now + wait;
+    p->smaps_valid = ret == 0;
+    if (ret == 0) {
+        p->pss_mem = smaps.pss;
+        p->uss_mem = smaps.uss;
+        p->swap_mem = smaps.swap;
+    }
+
+    // The state outlives this list; skip it if the PID was reused since
+    proc_state_t *st = proc_state_find(p->pid);
+    if (st && st->start_ticks == p->uptime_ticks) {
+        if (ret == 0) {
+            st->smaps = smaps;
+        }
+        st->smaps_time = p->smaps_time;
+        st->smaps_due = p->smaps_due;
+        st->has_smaps = p->smaps_valid;
+    }
+    return ret;
+}
+
+size_t process_refresh_smaps(proc_list_t *list, size_t max_reads,
+                             double deadline) {
+    if (max_reads > SMAPS_MAX_READS) {
+        max_reads = SMAPS_MAX_READS;
+    }
+
+    // Pick the due processes that were read the longest ago (never first),
+    // kept sorted by smaps_time
+    proc_info_t *pick[SMAPS_MAX_READS];
+    size_t npick = 0;
+    double now = monotonic_seconds();
+    for (size_t i = 0; i < list->count; i++) {
+        proc_info_t *p = &list->procs[i];
+        if (p->smaps_due > now) {
             continue;
+        }
+        size_t j = npick < max_reads ? npick++ : max_reads;
+        while (j > 0 && pick[j - 1]->smaps_time > p->smaps_time) {
+            if (j < max_reads) {
+                pick[j] = pick[j - 1];
+            }
+            j--;
+        }
+        if (j < max_reads) {
+            pick[j] = p;
+        }
+    }
+
+    size_t done = 0;
+    while (done < npick && monotonic_seconds() < deadline) {
+        process_load_smaps(pick[done++]);
+    }
+    return done;
+}
+
+/**
+ * Opens /proc/[pid] and reads the process through collect_process_at().
+ *
+ * @return 0 on success (or skipped process), -1 if memory allocation fails.
+ */
+static int collect_process(proc_list_t *list, pid_t pid,
+                           unsigned long long system_mem_total) {
+    char dir_path[64];
+    snprintf(dir_path, sizeof(dir_path), "/proc/%d", pid);
+    int dir_fd = open(dir_path, O_RDONLY | O_DIRECTORY);
+    if (dir_fd < 0) {
+        return 0; // The process is gone
+    }
+
+    int ret = collect_process_at(list, dir_fd, pid, system_mem_total);
+    close(dir_fd);
+    return ret;
+}
+
+/**
+ * Stores a completion of the io_uring collector in its job. The user data
+ * is the job index times 3 plus the request (statx, stat, statm).
+ */
+static void uring_complete(void *ctx, uint64_t user_data, int res) {
+    (void)ctx;
+    uring_job_t *job = &g_jobs[user_data / 3];
+    switch (user_data % 3) {
+    case 0:
+        job->stx_res = res;
+        break;
+    case 1:
+        job->stat_len = res;
+        break;
+    default:
+        job->statm_len = res;
+        break;
+    }
+}
+
+/**
+ * Reads the queued processes with a single io_uring submission and appends
+ * them to the list in queue order. If the submission fails (e.g. io_uring
+ * is blocked by a seccomp filter), the ring is dropped and this and all
+ * later collections read synchronously.
+ *
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+static int flush_uring_jobs(proc_list_t *list,
+                            unsigned long long system_mem_total) {
+    size_t count = g_job_count;
+    g_job_count = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        uring_job_t *job = &g_jobs[i];
+        snprintf(job->dir, sizeof(job->dir), "/proc/%d", job->pid);
+        snprintf(job->stat_path, sizeof(job->stat_path), "%s/stat", job->dir);
+        snprintf(job->statm_path, sizeof(job->statm_path), "%s/statm",
+                 job->dir);
+        job->stx_res = job->stat_len = job->statm_len = -1;
+
+        // A job that doesn't fit in the ring is read synchronously
+        job->queued =
+            uring_prep_statx(g_ring, job->dir, STATX_UID, &job->stx,
+                             i * 3) == 0 &&
+            uring_prep_read_file(g_ring, job->stat_path, job->stat_buf,
+                                 sizeof(job->stat_buf) - 1, i * 2,
+                                 i * 3 + 1) == 0 &&
+            uring_prep_read_file(g_ring, job->statm_path, job->statm_buf,
+                                 sizeof(job->statm_buf) - 1, i * 2 + 1,
+                                 i * 3 + 2) == 0;
+    }
+
+    if (uring_run(g_ring, uring_complete, NULL) != 0) {
+        uring_close(g_ring);
+        g_ring = NULL;
+        for (size_t i = 0; i < count; i++) {
+            if (collect_process(list, g_jobs[i].pid, system_mem_total) != 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
 
-        // Parse /proc/[pid]/stat
-        char comm[256] = {0};
-        long priority_long;
-        fscanf(
-            stat_file,
-            "%*d (%255[^)]) %c " // Fields 1-3: pid, comm, state
-            "%*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d " // Skip
-                                                                       // 4-17
-            "%ld "  // Field 18: priority
-            "%ld "  // Field 19: nice
-            "%*ld " // Field 20: num_threads
-            "%*ld " // Field 21: itrealvalue
-            "%llu", // Field 22: starttime (uptime_ticks)
-            comm, &proc_info.state, &priority_long, &proc_info.nice,
-            &proc_info.uptime_ticks);
-        fclose(stat_file);
-
-        if (priority_long < 0) {
-            strncpy(proc_info.priority, "rt", sizeof(proc_info.priority) - 1);
-        } else {
-            snprintf(proc_info.priority, sizeof(proc_info.priority), "%ld",
-                     priority_long);
-        }
-
-        // Fetch UID and memory info from /proc/[pid]/status
-        char status_path[256] = {0};
-        snprintf(status_path, sizeof(status_path), "/proc/%d/status", pid);
-        FILE *status_file = fopen(status_path, "r");
-        if (!status_file) {
+    for (size_t i = 0; i < count; i++) {
+        uring_job_t *job = &g_jobs[i];
+        if (!job->queued) {
+            if (collect_process(list, job->pid, system_mem_total) != 0) {
+                return -1;
+            }
             continue;
         }
+        if (job->stx_res < 0 || job->stat_len <= 0 || job->statm_len <= 0) {
+            continue; // The process is gone
+        }
+        job->stat_buf[job->stat_len] = '\0';
+        job->statm_buf[job->statm_len] = '\0';
 
-        uid_t uid = 0;
-        char line[256] = {0};
-        while (fgets(line, sizeof(line), status_file)) {
-            if (sscanf(line, "Uid:\t%u", &uid) == 1) {
-                // Done with Uid, continue to get memory
-            } else if (sscanf(line, "VmSize:\t%lu kB", &proc_info.virt_mem) ==
-                       1) {
-            } else if (sscanf(line, "VmRSS:\t%lu kB", &proc_info.res_mem) ==
-                       1) {
-            } else if (sscanf(line, "RssShmem:\t%lu kB", &proc_info.shr_mem) ==
-                       1) {
+        // The optional fields still read through the directory
+        int dir_fd = -1;
+        if (g_optional_fields & DIR_FIELDS) {
+            dir_fd = open(job->dir, O_RDONLY | O_DIRECTORY);
+            if (dir_fd < 0) {
+                continue;
             }
         }
-        fclose(status_file);
+        int ret = add_process(list, dir_fd, job->pid, job->stx.stx_uid,
+                              job->stat_buf, job->statm_buf,
+                              system_mem_total);
+        if (dir_fd >= 0) {
+            close(dir_fd);
+        }
+        if (ret != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * In sampling mode, appends the values of the last read of a process
+ * instead of reading it, unless it is its turn, it was among the busiest
+ * processes, or it is new.
+ *
+ * @return 1 if the process was carried over, 0 if it has to be read, -1 if
+ *         memory allocation fails.
+ */
+static int carry_over_process(proc_list_t *list, pid_t pid) {
+    if ((unsigned)pid % g_sample_period == g_sample_round % g_sample_period) {
+        return 0;
+    }
+    proc_state_t *st = proc_state_find(pid);
+    if (!st || st->exited || st->sample_hot || st->sample_slot == 0 ||
+        st->sample_slot > g_sample_cache_count ||
+        g_sample_cache[st->sample_slot - 1].pid != pid) {
+        return 0;
+    }
+
+    proc_info_t p = g_sample_cache[st->sample_slot - 1];
+    proc_state_mark_seen(st);
+    p.stale = 1;
+    p.cgroup = st->cgroup;
+    p.history = st->history;
+    p.pss_mem = st->smaps.pss;
+    p.uss_mem = st->smaps.uss;
+    p.swap_mem = st->smaps.swap;
+    p.smaps_time = st->smaps_time;
+    p.smaps_due = st->smaps_due;
+    p.smaps_valid = st->has_smaps;
+    p.totals = st->totals;
+
+    double age = g_collect_time - p.sample_time;
+    if (age > g_sampling.oldest) {
+        g_sampling.oldest = age;
+    }
+    g_sampling.carried++;
+    st->sample_slot = list->count + 1;
+    return add_process_to_list(list, p) == 0 ? 1 : -1;
+}
+
+/**
+ * Remembers the list for the next collection in sampling mode, and which
+ * of its processes were the busiest.
+ *
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+static int end_sampling_round(const proc_list_t *list) {
+    if (g_sample_period == 0) {
+        return 0;
+    }
+    g_sample_round++;
+
+    if (list->count > g_sample_cache_capacity) {
+        proc_info_t *cache =
+            realloc(g_sample_cache, list->capacity * sizeof(proc_info_t));
+        if (!cache) {
+            perror("Failed to allocate memory for the sampling cache");
+            g_sample_cache_count = 0; // Everything is read next time
+            return -1;
+        }
+        g_sample_cache = cache;
+        g_sample_cache_capacity = list->capacity;
+    }
+    memcpy(g_sample_cache, list->procs, list->count * sizeof(proc_info_t));
+    g_sample_cache_count = list->count;
 
-        // Convert UID to username
-        struct passwd *pw = getpwuid(uid);
-        if (pw) {
-            strncpy(proc_info.user, pw->pw_name, sizeof(proc_info.user) - 1);
-        } else {
-            // Failed? Use UID as a fallback
-            snprintf(proc_info.user, sizeof(proc_info.user), "%u", uid);
+    for (size_t i = 0; i < g_sample_hot_count; i++) {
+        proc_state_t *st = proc_state_find(g_sample_hot[i]);
+        if (st) {
+            st->sample_hot = 0;
         }
+    }
 
-        // Get full command line
-        get_command_line(pid, proc_info.command, sizeof(proc_info.command));
-        if (proc_info.command[0] == '\0') {
-            // Fallback to comm from stat if cmdline is empty (e.g. kernel
-            // threads)
-            strncpy(proc_info.command, comm, sizeof(proc_info.command) - 1);
+    // Keep the indexes of the busiest processes, busiest first
+    size_t n = 0;
+    for (size_t i = 0; g_sample_top > 0 && i < list->count; i++) {
+        double cpu = list->procs[i].cpu_percent;
+        if (cpu <= 0 ||
+            (n == g_sample_top && cpu <= list->procs[g_sample_pick[n - 1]]
+                                             .cpu_percent)) {
+            continue;
+        }
+        size_t slot = n < g_sample_top ? n++ : n - 1;
+        while (slot > 0 &&
+               list->procs[g_sample_pick[slot - 1]].cpu_percent < cpu) {
+            g_sample_pick[slot] = g_sample_pick[slot - 1];
+            slot--;
         }
+        g_sample_pick[slot] = i;
+    }
+    for (size_t i = 0; i < n; i++) {
+        g_sample_hot[i] = list->procs[g_sample_pick[i]].pid;
+        proc_state_t *st = proc_state_find(g_sample_hot[i]);
+        if (st) {
+            st->sample_hot = 1;
+        }
+    }
+    g_sample_hot_count = n;
+    return 0;
+}
+
+/**
+ * Appends an exited process to the list (see end_cumulative_round()).
+ */
+static int add_exited_process(const proc_state_t *st, void *ctx) {
+    proc_list_t *list = ctx;
+    proc_info_t p = {0};
+    p.pid = st->pid;
+    p.uid = st->uid;
+    p.state = 'X';
+    p.uptime_ticks = st->start_ticks;
+    p.cpu_ticks = st->cpu_ticks;
+    p.cgroup = st->cgroup;
+    p.history = -1;
+    p.sample_time = st->sample_time;
+    p.totals = st->totals;
+    p.exited = 1;
+    strncpy(p.priority, "-", sizeof(p.priority) - 1);
+    strncpy(p.command, st->comm, sizeof(p.command) - 1);
+    if (g_optional_fields & PROC_FIELD_DETAILS) {
+        load_details_at(-1, &p); // Only the user name is left
+    }
+    return add_process_to_list(list, p);
+}
+
+/**
+ * In cumulative mode, appends the exited processes to the list and sums up
+ * the totals.
+ *
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+static int end_cumulative_round(proc_list_t *list) {
+    if (!g_cumulative) {
+        return 0;
+    }
+    size_t alive = list->count;
+    int ret = proc_state_foreach_exited(add_exited_process, list);
+
+    proc_cumulative_t *c = &g_cumulative_sum;
+    c->since = g_baseline_time;
+    c->exited = list->count - alive;
+    c->folded = proc_state_folded(&c->sum);
+    for (size_t i = 0; i < list->count; i++) {
+        const proc_totals_t *t = &list->procs[i].totals;
+        c->sum.cpu_ticks += t->cpu_ticks;
+        c->sum.read_bytes += t->read_bytes;
+        c->sum.write_bytes += t->write_bytes;
+        c->sum.minflt += t->minflt;
+        c->sum.majflt += t->majflt;
+    }
+    return ret;
+}
 
-        // Calculate %MEM
-        if (system_mem_total > 0) {
-            proc_info.mem_percent =
-                ((double)proc_info.res_mem / system_mem_total) * 100.0;
+/**
+ * Prepares the per-collection settings.
+ */
+static void begin_collection(void) {
+    g_hz = sys_hz();
+    g_page_kib = (unsigned long)sys_pagesize() / 1024;
+    g_collect_time = monotonic_seconds();
+    memset(&g_sampling, 0, sizeof(g_sampling));
+    proc_state_begin_collection();
+}
+
+/**
+ * Finishes a collection. The per-process states of a collection that was
+ * cut short are left alone: the processes it didn't reach are still alive
+ * and must not be dropped or listed as exited.
+ *
+ * @param ret 0 if every process was read, -1 if the collection stopped.
+ * @return 0 on success, -1 on failure.
+ */
+static int end_collection(proc_list_t *list, int ret) {
+    g_job_count = 0;
+    if (ret != 0) {
+        return -1;
+    }
+    proc_state_end_collection();
+    if (end_cumulative_round(list) != 0) {
+        return -1;
+    }
+    return end_sampling_round(list);
+}
+
+/**
+ * Reads a process with the selected collector. With io_uring, the process
+ * is only queued; flush_uring_jobs() reads the queue once it is full and at
+ * the end of the collection.
+ *
+ * @return 0 on success (or skipped process), -1 if memory allocation fails.
+ */
+static int queue_process(proc_list_t *list, pid_t pid,
+                         unsigned long long system_mem_total) {
+    if (g_sample_period > 0) {
+        int carried = carry_over_process(list, pid);
+        if (carried != 0) {
+            return carried < 0 ? -1 : 0;
         }
+    }
+    if (!g_ring) {
+        return collect_process(list, pid, system_mem_total);
+    }
+    g_jobs[g_job_count++].pid = pid;
+    if (g_job_count == URING_BATCH) {
+        return flush_uring_jobs(list, system_mem_total);
+    }
+    return 0;
+}
+
+int collect_all_processes(proc_list_t *list,
+                          unsigned long long system_mem_total) {
+    DIR *d = opendir("/proc");
+    if (!d) {
+        perror("Could not open /proc");
+        return -1;
+    }
 
-        // TODO: Calculate %CPU (this is complex and will be done later)
-        proc_info.cpu_percent = 0.0;
+    list->count = 0; // Reset list for a fresh collection
+    begin_collection();
+    struct dirent *e;
+    int ret = 0;
 
-        if (add_process_to_list(list, proc_info) != 0) {
+    while ((e = readdir(d)) != NULL) {
+        if (!isdigit((unsigned char)e->d_name[0])) {
+            // Skip non-numeric directories (not a process (PID))
+            continue;
+        }
+
+        pid_t pid = atoi(e->d_name);
+        if ((ret = queue_process(list, pid, system_mem_total)) != 0) {
             break; // Stop if we can't add more processes
         }
     }
+    if (ret == 0 && g_job_count > 0) {
+        ret = flush_uring_jobs(list, system_mem_total);
+    }
     closedir(d);
-    return 0;
+    return end_collection(list, ret);
+}
+
+int collect_processes(proc_list_t *list, const pid_t *pids, size_t count,
+                      unsigned long long system_mem_total) {
+    list->count = 0; // Reset list for a fresh collection
+    begin_collection();
+
+    int ret = 0;
+    for (size_t i = 0; i < count; i++) {
+        if ((ret = queue_process(list, pids[i], system_mem_total)) != 0) {
+            break; // Stop if we can't add more processes
+        }
+    }
+    if (ret == 0 && g_job_count > 0) {
+        ret = flush_uring_jobs(list, system_mem_total);
+    }
+    return end_collection(list, ret);
+}
+
+void free_process_list(proc_list_t *list) {
+    free(list->procs);
+    init_process_list(list);
+    proc_state_clear();
+
+    // The cache refers to the states
+    free(g_sample_cache);
+    g_sample_cache = NULL;
+    g_sample_cache_count = 0;
+    g_sample_cache_capacity = 0;
+    g_sample_hot_count = 0;
 }
@@ -2,6 +2,18 @@
 #pragma once
 #include <pwd.h>
 #include <sys/types.h>
+#include <time.h>
+
+/**
+ * Resources a process used since the baseline (cumulative mode).
+ */
+typedef struct {
+    unsigned long long cpu_ticks;   // utime + stime in clock ticks
+    unsigned long long read_bytes;  // Bytes read from storage
+    unsigned long long write_bytes; // Bytes written to storage
+    unsigned long long minflt;      // Minor page faults
+    unsigned long long majflt;      // Major page faults
+} proc_totals_t;
 
 /**
  * Holds all relavant information for a single process.
@@ -9,7 +21,9 @@
  */
 typedef struct {
     pid_t pid;                       // Process ID
-    char user[32];                   // User name of the process owner
+    pid_t ppid;                      // Parent process ID
+    uid_t uid;                       // Effective UID of the process owner
+    char user[32];                   // User name (see has_details)
     char priority[5];                // Process priority
     long nice;                       // Nice value
     unsigned long virt_mem;          // Virtual memory size in KiB
@@ -19,9 +33,95 @@ typedef struct {
     double cpu_percent;              // CPU usage percentage
     double mem_percent;              // Memory usage percentage
     unsigned long long uptime_ticks; // Uptime in ticks
-    char command[256];               // Command line of the process
+    unsigned long long cpu_ticks;    // CPU time (utime + stime) in ticks
+    long num_threads;                // Number of threads
+    int last_cpu;                    // CPU the process last ran on
+    const char *cgroup;              // cgroup path, valid until next collect
+    double io_read_rate;             // Bytes read from storage per second
+    double io_write_rate;            // Bytes written to storage per second
+    double io_syscr_rate;            // read syscalls per second
+    double io_syscw_rate;            // write syscalls per second
+    int io_valid;                    // I/O rates are known (PROC_FIELD_IO)
+    double minflt_rate;              // Minor page faults per second
+    double majflt_rate;              // Major page faults per second
+    double vcsw_rate;                // Voluntary context switches per second
+    double ivcsw_rate;               // Involuntary context switches per second
+    int ctxsw_valid;                 // vcsw/ivcsw rates are known
+    double sched_run_percent;        // On-CPU time in % (nanosecond precise)
+    double sched_wait_percent;       // Time waiting on a run queue in %
+    double sched_slice_rate;         // Timeslices run per second
+    int sched_valid;                 // sched_* are known (PROC_FIELD_SCHED)
+    int history;                     // History ring (-1: none), see history.h
+    int has_details;                 // user and command line are filled
+    unsigned long pss_mem;           // Proportional set size in KiB
+    unsigned long uss_mem;           // Unique set size in KiB
+    unsigned long swap_mem;          // Swapped out memory in KiB
+    double smaps_time;               // When PSS/USS/SWAP were read (0: never)
+    double smaps_due;                // When they should be read again
+    int smaps_valid;                 // PSS/USS/SWAP are known
+    double sample_time;              // When stat/statm were read
+    int stale;                       // Carried over unread (sampling mode)
+    proc_totals_t totals;            // Used since the baseline (cumulative)
+    int exited;                      // Gone, listed for its totals
+    char command[256];               // Command line, or comm until loaded
 } proc_info_t;
 
+/**
+ * Optional per-process fields that are only read when a view needs them.
+ * They can be combined as a bit mask.
+ */
+typedef enum {
+    PROC_FIELD_CGROUP = 1 << 0,  // cgroup path from /proc/[pid]/cgroup
+    PROC_FIELD_IO = 1 << 1,      // I/O rates from /proc/[pid]/io
+    PROC_FIELD_DETAILS = 1 << 2, // User name and /proc/[pid]/cmdline
+    PROC_FIELD_CTXSW = 1 << 3,   // Context switches from /proc/[pid]/status
+    PROC_FIELD_SCHED = 1 << 4,   // Run/wait times from /proc/[pid]/schedstat
+} proc_field_t;
+
+// smaps_rollup of a process is read again after this many seconds at the
+// earliest...
+#define SMAPS_MIN_AGE 1.0
+// ...or after this many times the duration of its last read, so a huge
+// process can't take up a large share of the time
+#define SMAPS_COST_FACTOR 100.0
+// A process whose smaps_rollup can't be read is retried this much later
+#define SMAPS_RETRY_AGE 30.0
+// Default and largest number of smaps_rollup reads per frame
+#define SMAPS_DEFAULT_READS 16
+#define SMAPS_MAX_READS 256
+
+/**
+ * How a collection reads /proc/[pid]/stat and /proc/[pid]/statm.
+ */
+typedef enum {
+    PROC_COLLECTOR_SYNC,  // openat(), read() and close() per file
+    PROC_COLLECTOR_URING, // Batched for many processes through io_uring
+} proc_collector_t;
+
+// Default number of busiest processes that sampling mode reads every time
+#define SAMPLING_DEFAULT_TOP 64
+
+/**
+ * What the last collection in sampling mode read.
+ */
+typedef struct {
+    size_t read;     // Processes read in full
+    size_t carried;  // Processes whose last values were carried over
+    double oldest;   // Age of the oldest carried-over values in seconds
+    unsigned period; // Every process is read at least every 'period' times
+} proc_sampling_t;
+
+/**
+ * What cumulative mode has accumulated since the baseline.
+ */
+typedef struct {
+    time_t since;         // Wall clock time of the baseline
+    proc_totals_t sum;    // Totals of all processes, exited ones included
+    size_t exited;        // Exited processes listed for their totals
+    size_t folded;        // Exited processes whose PID was reused since;
+                          // only counted in sum
+} proc_cumulative_t;
+
 /**
  * Represents a dynamically-sized list of processes.
  */
@@ -31,6 +131,82 @@ typedef struct {
     size_t capacity;
 } proc_list_t;
 
+/**
+ * @brief Selects which optional fields the next collections will read.
+ *
+ * @param fields A bit mask of proc_field_t values (0 for none).
+ */
+void process_set_optional_fields(unsigned fields);
+
+/**
+ * @brief Selects how the next collections read the per-process files.
+ * @details The io_uring collector queues the reads of many processes and
+ *          submits them with a single io_uring_enter(). If io_uring turns
+ *          out to be unusable, collections fall back to synchronous reads
+ *          (see process_collector_name()).
+ *
+ * @param collector The collector to use.
+ * @return 0 on success, -1 if io_uring is not available (the synchronous
+ *         collector stays in use).
+ */
+int process_set_collector(proc_collector_t collector);
+
+/**
+ * @brief Get the name of the collector in use ("sync" or "io_uring").
+ */
+const char *process_collector_name(void);
+
+/**
+ * @brief Turns on sampling: collections read only some processes in full.
+ * @details Each collection reads the 'top' busiest processes of the previous
+ *          one, new processes and a rotating slice of the rest (the PIDs
+ *          congruent to the collection number modulo 'period'), so every
+ *          process is read at least every 'period' collections. The others
+ *          keep the values of their last read, marked 'stale'. A reused PID
+ *          goes unnoticed until the process is read again.
+ *
+ * @param period Collections between two reads of a process (0: turns
+ *               sampling off, every process is read every time).
+ * @param top Busiest processes read every time.
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+int process_set_sampling(unsigned period, unsigned top);
+
+/**
+ * @brief Gets what the last collection read in sampling mode.
+ *
+ * @param out Pointer to the proc_sampling_t to fill.
+ * @return 0 on success, -1 if sampling is off.
+ */
+int process_get_sampling(proc_sampling_t *out);
+
+/**
+ * @brief Turns cumulative mode on or off.
+ * @details In cumulative mode, every read adds what a process used since
+ *          its previous read (CPU time, storage I/O bytes, page faults) to
+ *          its totals, kept in the per-PID state. Processes started after
+ *          the baseline count from their start. Exited processes keep their
+ *          state and are appended to every collection (with 'exited' set)
+ *          until the next baseline. Turning the mode on sets a baseline.
+ *          The I/O totals need PROC_FIELD_IO.
+ *
+ * @param on Non-zero to turn cumulative mode on.
+ */
+void process_set_cumulative(int on);
+
+/**
+ * @brief Starts the totals over from now and forgets exited processes.
+ */
+void process_reset_totals(void);
+
+/**
+ * @brief Gets what the last collection accumulated in cumulative mode.
+ *
+ * @param out Pointer to the proc_cumulative_t to fill.
+ * @return 0 on success, -1 if cumulative mode is off.
+ */
+int process_get_cumulative(proc_cumulative_t *out);
+
 /**
  * @brief Initializes a process list (proc_list_t).
  * @details This function sets the initial state of the process list, preparing
@@ -41,17 +217,68 @@ typedef struct {
 void init_process_list(proc_list_t *list);
 
 /**
- * @brief Adds a single process to the process list (proc_list_t)
- * @details This function appends a new process information (proc_info_t) to the
- * list, resizing it if necessary.
+ * @brief Collects every process in /proc into the list.
+ * @details A collection that stops early (e.g. when memory allocation
+ * fails) leaves the per-process state of the processes it didn't reach
+ * alone, and the list holds only the processes read so far.
  *
- * @param list Pointer to the proc_list_t where the process will be added.
- * @param process_info The proc_info_t structure containing the process
- * information to add.
+ * @param list Pointer to the proc_list_t where the processes will be stored.
+ * @param system_mem_total Total system memory in KiB (for %MEM).
  * @return 0 on success, -1 on error (e.g., if memory allocation fails).
  */
 int collect_all_processes(proc_list_t *list,
                           unsigned long long system_mem_total);
+
+/**
+ * @brief Collects only the given processes instead of enumerating /proc.
+ * @details Used when the view is scoped (e.g. to a cgroup). PIDs that no
+ * longer exist are skipped.
+ *
+ * @param list Pointer to the proc_list_t where the processes will be stored.
+ * @param pids Array of PIDs to collect.
+ * @param count Number of entries in pids.
+ * @param system_mem_total Total system memory in KiB (for %MEM).
+ * @return 0 on success, -1 on error.
+ */
+int collect_processes(proc_list_t *list, const pid_t *pids, size_t count,
+                      unsigned long long system_mem_total);
+
+/**
+ * @brief Fills the user name and command line of a process if the collection
+ *        skipped them.
+ * @details Without PROC_FIELD_DETAILS a collection only stores the UID and
+ * comm, which is all sorting and most views need. The caller then loads the
+ * details of the rows that are actually shown. If the process is gone by
+ * now, comm is kept as the command.
+ *
+ * @param p Pointer to the proc_info_t to complete.
+ */
+void process_load_details(proc_info_t *p);
+
+/**
+ * @brief Reads PSS, USS and swap of a process from smaps_rollup.
+ * @details The values are also remembered in the process state, so the
+ *          next collections carry them over (with their age) instead of
+ *          reading the file again. Sets smaps_due for the next read.
+ *
+ * @param p Pointer to the proc_info_t to update.
+ * @return 0 on success, -1 if the file cannot be read (e.g. no permission).
+ */
+int process_load_smaps(proc_info_t *p);
+
+/**
+ * @brief Reads smaps_rollup for the processes that waited the longest.
+ * @details Only processes that are due are considered. Called every frame
+ *          with a small budget, this goes round-robin through the list.
+ *
+ * @param list The process list.
+ * @param max_reads How many processes to read at most.
+ * @param deadline Monotonic time after which no new read is started.
+ * @return The number of processes read.
+ */
+size_t process_refresh_smaps(proc_list_t *list, size_t max_reads,
+                             double deadline);
+
 /**
  * @brief Frees the memory allocated for a process list (proc_list_t).
  * @details This function releases all memory used by the process list,
@@ -0,0 +1,197 @@
+// src/core/psi.c
+#include "psi.h"
+#include "../util/util.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char *const g_resource_names[PSI_RESOURCE_COUNT] = {
+    "cpu",
+    "memory",
+    "io",
+};
+
+const char *psi_resource_name(psi_resource_t resource) {
+    return g_resource_names[resource];
+}
+
+/**
+ * Builds the path of a resource's pressure file.
+ */
+static int psi_path(psi_resource_t resource, const char *cgroup_dir,
+                    char *out, size_t size) {
+    int n;
+    if (cgroup_dir) {
+        n = snprintf(out, size, "%s/%s.pressure", cgroup_dir,
+                     g_resource_names[resource]);
+    } else {
+        n = snprintf(out, size, "/proc/pressure/%s",
+                     g_resource_names[resource]);
+    }
+    return (n < 0 || (size_t)n >= size) ? -1 : 0;
+}
+
+static int read_psi_file(const char *path, psi_resource_stats_t *out) {
+    char *buf;
+    if (!read_text_file(path, &buf, NULL)) {
+        return -1;
+    }
+
+    // "some avg10=0.00 avg60=0.00 avg300=0.00 total=0"
+    // "full avg10=0.00 avg60=0.00 avg300=0.00 total=0" (not for the root cpu)
+    char *save, *line = strtok_r(buf, "\n", &save);
+    while (line) {
+        psi_line_t *l = NULL;
+        if (strncmp(line, "some ", 5) == 0) {
+            l = &out->some;
+        } else if (strncmp(line, "full ", 5) == 0) {
+            l = &out->full;
+        }
+        if (l) {
+            sscanf(line + 5, "avg10=%lf avg60=%lf avg300=%lf total=%llu",
+                   &l->avg10, &l->avg60, &l->avg300, &l->total);
+        }
+        line = strtok_r(NULL, "\n", &save);
+    }
+
+    free(buf);
+    out->valid = 1;
+    return 0;
+}
+
+int read_psi(const char *cgroup_dir, psi_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->timestamp = monotonic_seconds();
+
+    int any = 0;
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        char path[PATH_MAX];
+        if (psi_path((psi_resource_t)r, cgroup_dir, path, sizeof(path)) != 0) {
+            continue;
+        }
+        if (read_psi_file(path, &out->res[r]) == 0) {
+            any = 1;
+        }
+    }
+    return any ? 0 : -1;
+}
+
+void psi_percent(const psi_stats_t *prev, const psi_stats_t *now,
+                 psi_percent_t *pct) {
+    memset(pct, 0, sizeof(*pct));
+
+    double elapsed_usec = (now->timestamp - prev->timestamp) * 1e6;
+    if (elapsed_usec <= 0) {
+        return;
+    }
+
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        const psi_line_t *a = &prev->res[r].some;
+        const psi_line_t *b = &now->res[r].some;
+        if (prev->res[r].valid && now->res[r].valid && b->total >= a->total) {
+            pct->some[r] = (double)(b->total - a->total) / elapsed_usec * 100.0;
+        }
+    }
+}
+
+int psi_trigger_open(const char *spec, const char *cgroup_dir,
+                     psi_trigger_t *out) {
+    char resource[16], kind[8];
+    unsigned long stall_us, window_us;
+    if (sscanf(spec, "%15[^:]:%7[^:]:%lu:%lu", resource, kind, &stall_us,
+               &window_us) != 4 ||
+        (strcmp(kind, "some") != 0 && strcmp(kind, "full") != 0)) {
+        fprintf(stderr, "%s: expected resource:some|full:stall_us:window_us\n",
+                spec);
+        return -1;
+    }
+
+    int r;
+    for (r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        if (strcmp(resource, g_resource_names[r]) == 0) {
+            break;
+        }
+    }
+    if (r == PSI_RESOURCE_COUNT) {
+        fprintf(stderr, "%s: unknown resource (cpu, memory or io)\n", spec);
+        return -1;
+    }
+
+    char path[PATH_MAX];
+    if (psi_path((psi_resource_t)r, cgroup_dir, path, sizeof(path)) != 0) {
+        return -1;
+    }
+    int fd = open(path, O_RDWR | O_NONBLOCK);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    // The kernel expects the trigger including the terminating NUL
+    char trigger[64];
+    int len = snprintf(trigger, sizeof(trigger), "%s %lu %lu", kind, stall_us,
+                       window_us);
+    if (write(fd, trigger, (size_t)len + 1) < 0) {
+        fprintf(stderr, "%s: %s\n", spec, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    out->resource = (psi_resource_t)r;
+    out->fd = fd;
+    out->spec = spec;
+    return 0;
+}
+
+void psi_trigger_close(psi_trigger_t *trigger) {
+    if (trigger->fd >= 0) {
+        close(trigger->fd);
+        trigger->fd = -1;
+    }
+}
+
+int psi_wait(const psi_trigger_t *triggers, size_t count, unsigned timeout_ms) {
+    struct pollfd fds[PSI_MAX_TRIGGERS];
+    if (count > PSI_MAX_TRIGGERS) {
+        count = PSI_MAX_TRIGGERS;
+    }
+    for (size_t i = 0; i < count; i++) {
+        fds[i].fd = triggers[i].fd;
+        fds[i].events = POLLPRI;
+        fds[i].revents = 0;
+    }
+
+    double deadline = monotonic_seconds() + timeout_ms / 1000.0;
+    while (true) {
+        double left = deadline - monotonic_seconds();
+        if (left <= 0) {
+            return -1;
+        }
+
+        int ret = poll(fds, count, (int)(left * 1000.0) + 1);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return -1; // Timeout (or a poll error: fall back to the interval)
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            if (fds[i].revents & POLLPRI) {
+                return (int)i;
+            }
+        }
+        // POLLERR means the pressure file went away; stop polling it
+        for (size_t i = 0; i < count; i++) {
+            if (fds[i].revents & (POLLERR | POLLNVAL)) {
+                fds[i].fd = -1;
+            }
+        }
+    }
+}
@@ -0,0 +1,119 @@
+// src/core/psi.h
+#pragma once
+#include <stddef.h>
+
+// Most PSI triggers that can be armed at once
+#define PSI_MAX_TRIGGERS 8
+
+/**
+ * The resources covered by Pressure Stall Information.
+ */
+typedef enum {
+    PSI_CPU,
+    PSI_MEMORY,
+    PSI_IO,
+    PSI_RESOURCE_COUNT, // How many resources?
+} psi_resource_t;
+
+/**
+ * One line ("some" or "full") of a pressure file.
+ */
+typedef struct {
+    double avg10;             // % of time stalled over the last 10 seconds
+    double avg60;             // % of time stalled over the last 60 seconds
+    double avg300;            // % of time stalled over the last 300 seconds
+    unsigned long long total; // Total stall time in microseconds
+} psi_line_t;
+
+/**
+ * The pressure of a single resource.
+ */
+typedef struct {
+    psi_line_t some; // Some tasks were stalled
+    psi_line_t full; // All non-idle tasks were stalled
+    int valid;       // Non-zero if the pressure file could be read
+} psi_resource_stats_t;
+
+/**
+ * The pressure of all resources at one point in time.
+ */
+typedef struct {
+    psi_resource_stats_t res[PSI_RESOURCE_COUNT];
+    double timestamp; // Monotonic time of the sample (seconds)
+} psi_stats_t;
+
+/**
+ * The share of time ("some" line) each resource was stalled between two
+ * samples, computed from the total counters.
+ */
+typedef struct {
+    double some[PSI_RESOURCE_COUNT]; // Percentage of time stalled
+} psi_percent_t;
+
+/**
+ * An armed PSI trigger (see Documentation/accounting/psi.rst).
+ */
+typedef struct {
+    psi_resource_t resource; // Watched resource
+    int fd;                  // Pressure file the trigger was written to
+    const char *spec;        // The trigger as given by the user
+} psi_trigger_t;
+
+/**
+ * @brief Get the short display name of a resource ("cpu", "memory", "io").
+ */
+const char *psi_resource_name(psi_resource_t resource);
+
+/**
+ * @brief Reads the pressure of all resources.
+ * @details Reads /proc/pressure/{cpu,memory,io}, or the cgroup's own
+ * {cpu,memory,io}.pressure files if a cgroup directory is given.
+ *
+ * @param cgroup_dir A cgroup v2 directory, or NULL for the whole system.
+ * @param out Pointer to a psi_stats_t structure to populate.
+ * @return 0 if at least one resource could be read, -1 otherwise (e.g. the
+ * kernel was built without PSI).
+ */
+int read_psi(const char *cgroup_dir, psi_stats_t *out);
+
+/**
+ * @brief Calculates the share of time stalled between two samples.
+ *
+ * @param prev Pointer to the previous psi_stats_t sample.
+ * @param now Pointer to the current psi_stats_t sample.
+ * @param pct Pointer to a psi_percent_t structure to populate.
+ */
+void psi_percent(const psi_stats_t *prev, const psi_stats_t *now,
+                 psi_percent_t *pct);
+
+/**
+ * @brief Arms a PSI trigger.
+ * @details The spec has the form "resource:some|full:stall_us:window_us",
+ * e.g. "memory:some:150000:2000000" fires when some tasks were stalled on
+ * memory for 150 ms within any 2 s window. Without CAP_SYS_RESOURCE the
+ * kernel only accepts windows that are a multiple of 2 s.
+ *
+ * @param spec The trigger specification.
+ * @param cgroup_dir A cgroup v2 directory, or NULL for the whole system.
+ * @param out Pointer to the psi_trigger_t to initialize.
+ * @return 0 on success, -1 on a malformed spec or if the kernel refused it.
+ */
+int psi_trigger_open(const char *spec, const char *cgroup_dir,
+                     psi_trigger_t *out);
+
+/**
+ * @brief Disarms a PSI trigger.
+ *
+ * @param trigger Pointer to the psi_trigger_t to close.
+ */
+void psi_trigger_close(psi_trigger_t *trigger);
+
+/**
+ * @brief Waits until a trigger fires or the timeout expires.
+ *
+ * @param triggers Array of armed triggers.
+ * @param count Number of entries in triggers.
+ * @param timeout_ms How long to wait at most, in milliseconds.
+ * @return The index of the first trigger that fired, -1 on timeout.
+ */
+int psi_wait(const psi_trigger_t *triggers, size_t count, unsigned timeout_ms);
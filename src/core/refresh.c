@@ -0,0 +1,92 @@
+// src/core/refresh.c
+#include "refresh.h"
+#include "../util/util.h"
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+
+// Weight of the latest frame in the smoothed per-frame cost
+#define REFRESH_SMOOTHING 0.3
+
+/**
+ * Returns the CPU time (user + system) used by toplite so far, in seconds.
+ */
+static double self_cpu_seconds(void) {
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) {
+        return 0.0;
+    }
+    return (double)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+           (double)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+void refresh_init(refresh_t *r, unsigned interval_ms, unsigned min_ms,
+                  unsigned max_ms, double budget) {
+    memset(r, 0, sizeof(*r));
+    r->min_ms = min_ms;
+    r->max_ms = max_ms > min_ms ? max_ms : min_ms;
+    r->budget = budget;
+
+    r->interval_ms = interval_ms;
+    if (budget > 0) {
+        if (r->interval_ms < r->min_ms) {
+            r->interval_ms = r->min_ms;
+        } else if (r->interval_ms > r->max_ms) {
+            r->interval_ms = r->max_ms;
+        }
+    }
+
+    r->cycle_cpu = self_cpu_seconds();
+    r->cycle_wall = monotonic_seconds();
+}
+
+void refresh_frame_begin(refresh_t *r) {
+    r->frame_cpu_mark = self_cpu_seconds();
+    r->frame_wall_mark = monotonic_seconds();
+
+    // A cycle is one frame plus the wait after it (none before the first)
+    double wall = r->frame_wall_mark - r->cycle_wall;
+    if (r->frame_wall > 0 && wall > 0) {
+        r->overhead = (r->frame_cpu_mark - r->cycle_cpu) / wall * 100.0;
+    }
+    r->cycle_cpu = r->frame_cpu_mark;
+    r->cycle_wall = r->frame_wall_mark;
+}
+
+unsigned refresh_frame_end(refresh_t *r) {
+    double cpu = self_cpu_seconds() - r->frame_cpu_mark;
+    double wall = monotonic_seconds() - r->frame_wall_mark;
+
+    if (r->frame_wall == 0) {
+        r->frame_cpu = cpu; // First frame: nothing to smooth against yet
+        r->frame_wall = wall;
+    } else {
+        r->frame_cpu += REFRESH_SMOOTHING * (cpu - r->frame_cpu);
+        r->frame_wall += REFRESH_SMOOTHING * (wall - r->frame_wall);
+    }
+
+    if (r->budget <= 0) {
+        return r->interval_ms;
+    }
+
+    // Solve frame_cpu / (frame_wall + interval) = budget for the interval
+    double interval = r->frame_cpu / (r->budget / 100.0) - r->frame_wall;
+    double ms = interval * 1000.0;
+    if (ms < r->min_ms) {
+        ms = r->min_ms;
+    } else if (ms > r->max_ms) {
+        ms = r->max_ms;
+    }
+    r->interval_ms = (unsigned)ms;
+    return r->interval_ms;
+}
+
+int refresh_set_idle(void) {
+    struct sched_param param = {.sched_priority = 0};
+    if (sched_setscheduler(0, SCHED_IDLE, &param) != 0) {
+        perror("sched_setscheduler(SCHED_IDLE)");
+        return -1;
+    }
+    return 0;
+}
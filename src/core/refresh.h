@@ -0,0 +1,59 @@
+// src/core/refresh.h
+#pragma once
+
+/**
+ * Tracks what collecting and drawing a frame costs toplite itself and, in
+ * adaptive mode, stretches or shrinks the refresh interval so that the
+ * overhead stays within a CPU budget.
+ */
+typedef struct {
+    unsigned interval_ms;   // Effective refresh interval
+    unsigned min_ms;        // Lower bound of the adaptive interval
+    unsigned max_ms;        // Upper bound of the adaptive interval
+    double budget;          // CPU budget in % of one CPU (0: fixed interval)
+    double overhead;        // CPU used over the last cycle in % of one CPU
+    double frame_cpu;       // Smoothed CPU seconds spent per frame
+    double frame_wall;      // Smoothed wall seconds spent per frame
+    double cycle_cpu;       // Process CPU seconds at the start of the cycle
+    double cycle_wall;      // Monotonic time at the start of the cycle
+    double frame_cpu_mark;  // Process CPU seconds at the start of the frame
+    double frame_wall_mark; // Monotonic time at the start of the frame
+} refresh_t;
+
+/**
+ * @brief Initializes the refresh state.
+ *
+ * @param r Pointer to the refresh_t to initialize.
+ * @param interval_ms Initial (or fixed) refresh interval.
+ * @param min_ms Lower bound of the adaptive interval.
+ * @param max_ms Upper bound of the adaptive interval.
+ * @param budget CPU budget in % of one CPU, or 0 to keep interval_ms fixed.
+ */
+void refresh_init(refresh_t *r, unsigned interval_ms, unsigned min_ms,
+                  unsigned max_ms, double budget);
+
+/**
+ * @brief Marks the start of a frame (collection and rendering).
+ *
+ * @param r Pointer to the refresh state.
+ */
+void refresh_frame_begin(refresh_t *r);
+
+/**
+ * @brief Marks the end of a frame and picks the next interval.
+ * @details The cost of the frame is measured with getrusage(). In adaptive
+ *          mode the interval is set so that cost / (cost + interval) matches
+ *          the budget, clamped to [min_ms, max_ms].
+ *
+ * @param r Pointer to the refresh state.
+ * @return The interval to wait before the next frame, in milliseconds.
+ */
+unsigned refresh_frame_end(refresh_t *r);
+
+/**
+ * @brief Moves toplite to the SCHED_IDLE scheduling class.
+ * @details toplite then only runs when a CPU would otherwise be idle.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+int refresh_set_idle(void);
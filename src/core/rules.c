@@ -0,0 +1,338 @@
+// src/core/rules.c
+#include "rules.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+    OP_GT, // >
+    OP_GE, // >=
+    OP_LT, // <
+    OP_LE, // <=
+} rule_op_t;
+
+typedef enum {
+    UNIT_PERCENT, // %
+    UNIT_BYTES,   // Bytes (K/M/G/T suffixes)
+    UNIT_RATE,    // Bytes per second
+    UNIT_COUNT,   // Plain number
+} rule_unit_t;
+
+typedef enum {
+    M_CPU_US,
+    M_CPU_SY,
+    M_CPU_NI,
+    M_CPU_ID,
+    M_CPU_WA,
+    M_CPU_HI,
+    M_CPU_SI,
+    M_CPU_ST,
+    M_MEM_USED,
+    M_MEM_AVAILABLE,
+    M_SWAP_USED,
+    M_LOAD1,
+    M_LOAD5,
+    M_LOAD15,
+    M_TASKS_TOTAL,
+    M_TASKS_RUNNING,
+    M_TASKS_ZOMBIE,
+    M_PROC_CPU,
+    M_PROC_MEM,
+    M_PROC_RSS,
+    M_PROC_VIRT,
+    M_PROC_THREADS,
+    M_PROC_READ,
+    M_PROC_WRITE,
+    M_PROC_MAJFLT,
+} metric_id_t;
+
+/**
+ * A metric rules can refer to.
+ */
+typedef struct {
+    const char *name;
+    rule_unit_t unit;
+    unsigned fields; // Optional process fields needed (proc.* only)
+    const char *help;
+} metric_t;
+
+// Indexed by metric_id_t
+static const metric_t g_metrics[] = {
+    {"cpu.us", UNIT_PERCENT, 0, "user CPU time"},
+    {"cpu.sy", UNIT_PERCENT, 0, "system CPU time"},
+    {"cpu.ni", UNIT_PERCENT, 0, "nice CPU time"},
+    {"cpu.idle", UNIT_PERCENT, 0, "idle time"},
+    {"cpu.iowait", UNIT_PERCENT, 0, "I/O wait time"},
+    {"cpu.irq", UNIT_PERCENT, 0, "hardware interrupt time"},
+    {"cpu.softirq", UNIT_PERCENT, 0, "software interrupt time"},
+    {"cpu.steal", UNIT_PERCENT, 0, "steal time"},
+    {"mem.used", UNIT_BYTES, 0, "memory in use (total - available)"},
+    {"mem.available", UNIT_BYTES, 0, "available memory"},
+    {"swap.used", UNIT_BYTES, 0, "swap in use"},
+    {"load.1", UNIT_COUNT, 0, "1 minute load average"},
+    {"load.5", UNIT_COUNT, 0, "5 minute load average"},
+    {"load.15", UNIT_COUNT, 0, "15 minute load average"},
+    {"tasks.total", UNIT_COUNT, 0, "processes"},
+    {"tasks.running", UNIT_COUNT, 0, "running processes"},
+    {"tasks.zombie", UNIT_COUNT, 0, "zombie processes"},
+    {"proc.cpu", UNIT_PERCENT, 0, "%CPU of a process"},
+    {"proc.mem", UNIT_PERCENT, 0, "%MEM of a process"},
+    {"proc.rss", UNIT_BYTES, 0, "resident memory of a process"},
+    {"proc.virt", UNIT_BYTES, 0, "virtual memory of a process"},
+    {"proc.threads", UNIT_COUNT, 0, "threads of a process"},
+    {"proc.read", UNIT_RATE, PROC_FIELD_IO, "storage reads of a process"},
+    {"proc.write", UNIT_RATE, PROC_FIELD_IO, "storage writes of a process"},
+    {"proc.majflt", UNIT_COUNT, 0, "major page faults/s of a process"},
+};
+
+#define METRIC_COUNT (sizeof(g_metrics) / sizeof(g_metrics[0]))
+
+bool rules_is_process_rule(const rule_t *rule) {
+    return rule->metric >= M_PROC_CPU;
+}
+
+/**
+ * Parses a threshold with an optional K/M/G/T suffix (and a trailing "B"
+ * or "%", which are ignored).
+ */
+static int parse_threshold(const char *s, double *out) {
+    char *end;
+    double value = strtod(s, &end);
+    if (end == s) {
+        return -1;
+    }
+    static const char suffixes[] = "KMGT";
+    const char *suffix = *end ? strchr(suffixes, *end) : NULL;
+    if (suffix) {
+        for (const char *k = suffixes; k <= suffix; k++) {
+            value *= 1024.0;
+        }
+        end++;
+    }
+    if (*end == 'B' || *end == '%') {
+        end++;
+    }
+    if (*end != '\0') {
+        return -1;
+    }
+    *out = value;
+    return 0;
+}
+
+int rules_compile(const char *spec, rule_set_t *set) {
+    if (set->count == RULES_MAX) {
+        fprintf(stderr, "At most %d rules are supported.\n", RULES_MAX);
+        return -1;
+    }
+
+    // METRIC is everything up to the operator
+    size_t name_len = strcspn(spec, "<>");
+    const char *p = spec + name_len;
+    if (*p == '\0') {
+        fprintf(stderr, "%s: expected METRIC>VALUE (or >=, <, <=)\n", spec);
+        return -1;
+    }
+    rule_t *rule = &set->rules[set->count];
+    rule->spec = spec;
+    rule->metric = -1;
+    for (size_t i = 0; i < METRIC_COUNT; i++) {
+        if (strlen(g_metrics[i].name) == name_len &&
+            strncmp(spec, g_metrics[i].name, name_len) == 0) {
+            rule->metric = (int)i;
+            break;
+        }
+    }
+    if (rule->metric < 0) {
+        fprintf(stderr, "%s: unknown metric (see --trigger help)\n", spec);
+        return -1;
+    }
+
+    bool eq = p[1] == '=';
+    rule->op = p[0] == '>' ? (eq ? OP_GE : OP_GT) : (eq ? OP_LE : OP_LT);
+    p += eq ? 2 : 1;
+    if (parse_threshold(p, &rule->threshold) != 0) {
+        fprintf(stderr, "%s: invalid value\n", spec);
+        return -1;
+    }
+
+    const metric_t *m = &g_metrics[rule->metric];
+    set->fields |= m->fields;
+    set->need_procs |= rules_is_process_rule(rule);
+    set->need_tasks |= rule->metric >= M_TASKS_TOTAL &&
+                       rule->metric <= M_TASKS_ZOMBIE;
+    set->count++;
+    return 0;
+}
+
+/**
+ * Gets the value of a system-wide metric.
+ */
+static double system_value(int metric, const rule_input_t *in) {
+    switch (metric) {
+    case M_CPU_US:
+        return in->cpu->us;
+    case M_CPU_SY:
+        return in->cpu->sy;
+    case M_CPU_NI:
+        return in->cpu->ni;
+    case M_CPU_ID:
+        return in->cpu->id;
+    case M_CPU_WA:
+        return in->cpu->wa;
+    case M_CPU_HI:
+        return in->cpu->hi;
+    case M_CPU_SI:
+        return in->cpu->si;
+    case M_CPU_ST:
+        return in->cpu->st;
+    case M_MEM_USED:
+        return (double)(in->mem->mem_total - in->mem->mem_available) * 1024;
+    case M_MEM_AVAILABLE:
+        return (double)in->mem->mem_available * 1024;
+    case M_SWAP_USED:
+        return (double)(in->mem->swap_total - in->mem->swap_free) * 1024;
+    case M_LOAD1:
+        return in->ld->load1;
+    case M_LOAD5:
+        return in->ld->load5;
+    case M_LOAD15:
+        return in->ld->load15;
+    case M_TASKS_TOTAL:
+        return in->tc->total;
+    case M_TASKS_RUNNING:
+        return in->tc->running;
+    case M_TASKS_ZOMBIE:
+        return in->tc->zombie;
+    default:
+        return 0.0;
+    }
+}
+
+/**
+ * Gets the value of a per-process metric.
+ */
+static double process_value(int metric, const proc_info_t *p) {
+    switch (metric) {
+    case M_PROC_CPU:
+        return p->cpu_percent;
+    case M_PROC_MEM:
+        return p->mem_percent;
+    case M_PROC_RSS:
+        return (double)p->res_mem * 1024;
+    case M_PROC_VIRT:
+        return (double)p->virt_mem * 1024;
+    case M_PROC_THREADS:
+        return (double)p->num_threads;
+    case M_PROC_READ:
+        return p->io_read_rate;
+    case M_PROC_WRITE:
+        return p->io_write_rate;
+    case M_PROC_MAJFLT:
+        return p->majflt_rate;
+    default:
+        return 0.0;
+    }
+}
+
+static bool compare(int op, double value, double threshold) {
+    switch (op) {
+    case OP_GT:
+        return value > threshold;
+    case OP_GE:
+        return value >= threshold;
+    case OP_LT:
+        return value < threshold;
+    default:
+        return value <= threshold;
+    }
+}
+
+/**
+ * Tells whether a is further past the threshold than b.
+ */
+static bool worse(int op, double a, double b) {
+    return (op == OP_GT || op == OP_GE) ? a > b : a < b;
+}
+
+/**
+ * Adds a process to the offenders of a rule, which are kept worst first.
+ */
+static void add_offender(const rule_t *rule, const proc_list_t *procs,
+                         size_t index, rule_hit_t *hit) {
+    double value = process_value(rule->metric, &procs->procs[index]);
+    size_t slot = hit->noffenders;
+    while (slot > 0 &&
+           worse(rule->op, value,
+                 process_value(rule->metric,
+                               &procs->procs[hit->offenders[slot - 1]]))) {
+        slot--;
+    }
+    if (slot == RULES_MAX_OFFENDERS) {
+        return;
+    }
+    size_t last = hit->noffenders < RULES_MAX_OFFENDERS
+                      ? hit->noffenders
+                      : RULES_MAX_OFFENDERS - 1;
+    memmove(&hit->offenders[slot + 1], &hit->offenders[slot],
+            (last - slot) * sizeof(hit->offenders[0]));
+    hit->offenders[slot] = index;
+    if (hit->noffenders < RULES_MAX_OFFENDERS) {
+        hit->noffenders++;
+    }
+    if (slot == 0) {
+        hit->value = value;
+    }
+}
+
+size_t rules_eval(const rule_set_t *set, const rule_input_t *in,
+                  rule_hit_t *hits) {
+    size_t fired = 0;
+    for (size_t r = 0; r < set->count; r++) {
+        const rule_t *rule = &set->rules[r];
+        rule_hit_t *hit = &hits[r];
+        hit->fired = false;
+        hit->noffenders = 0;
+
+        if (!rules_is_process_rule(rule)) {
+            hit->value = system_value(rule->metric, in);
+            hit->fired = compare(rule->op, hit->value, rule->threshold);
+        } else if (in->procs) {
+            hit->value = 0.0;
+            for (size_t i = 0; i < in->procs->count; i++) {
+                double v = process_value(rule->metric, &in->procs->procs[i]);
+                if (compare(rule->op, v, rule->threshold)) {
+                    add_offender(rule, in->procs, i, hit);
+                    hit->fired = true;
+                }
+            }
+        }
+        fired += hit->fired;
+    }
+    return fired;
+}
+
+void rules_format_value(const rule_t *rule, double value, char *out,
+                        size_t size) {
+    rule_unit_t unit = g_metrics[rule->metric].unit;
+    if (unit == UNIT_PERCENT) {
+        snprintf(out, size, "%.1f%%", value);
+    } else if (unit == UNIT_BYTES || unit == UNIT_RATE) {
+        static const char suffixes[] = " KMGT";
+        int i = 0;
+        while ((value >= 1024.0 || value <= -1024.0) && i < 4) {
+            value /= 1024.0;
+            i++;
+        }
+        snprintf(out, size, "%.1f%s%s", value,
+                 i > 0 ? (char[]){suffixes[i], '\0'} : "",
+                 unit == UNIT_RATE ? "/s" : "");
+    } else {
+        snprintf(out, size, "%.2f", value);
+    }
+}
+
+void rules_print_metrics(FILE *out) {
+    for (size_t i = 0; i < METRIC_COUNT; i++) {
+        fprintf(out, "  %-14s %s\n", g_metrics[i].name, g_metrics[i].help);
+    }
+}
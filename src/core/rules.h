@@ -0,0 +1,96 @@
+// src/core/rules.h
+#pragma once
+#include "process.h"
+#include "system.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Most rules and offending processes per rule toplite keeps track of
+#define RULES_MAX 16
+#define RULES_MAX_OFFENDERS 8
+
+/**
+ * A compiled threshold rule, e.g. "cpu.iowait>40" or "proc.rss>8G".
+ */
+typedef struct {
+    const char *spec; // The rule as given
+    int metric;       // Index into the metric table of rules.c
+    int op;           // Comparison operator
+    double threshold; // In the unit of the metric (%, bytes, count, ...)
+} rule_t;
+
+/**
+ * The rules given on the command line.
+ */
+typedef struct {
+    rule_t rules[RULES_MAX];
+    size_t count;
+    unsigned fields;  // Optional process fields the rules need
+    bool need_procs;  // A rule looks at processes
+    bool need_tasks;  // A rule looks at the task counts
+} rule_set_t;
+
+/**
+ * What the rules are evaluated against. Sections the rule set doesn't
+ * need may be NULL.
+ */
+typedef struct {
+    const cpu_percent_t *cpu;
+    const mem_info_t *mem;
+    const load_avg_t *ld;
+    const task_counts_t *tc;
+    const proc_list_t *procs;
+} rule_input_t;
+
+/**
+ * The outcome of one rule.
+ */
+typedef struct {
+    bool fired;                                 // The threshold was crossed
+    double value;                               // Value (worst process)
+    size_t noffenders;                          // Entries in offenders
+    size_t offenders[RULES_MAX_OFFENDERS];      // Process list indexes,
+                                                // worst first
+} rule_hit_t;
+
+/**
+ * @brief Compiles a rule and adds it to a set.
+ * @details A rule is METRIC OP VALUE, where OP is one of > >= < <= and
+ *          VALUE may have a K, M, G or T suffix (powers of 1024). See
+ *          rules_print_metrics() for the metrics. Errors are printed to
+ *          stderr.
+ *
+ * @param spec The rule.
+ * @param set The set to add it to.
+ * @return 0 on success, -1 if the rule is invalid or the set is full.
+ */
+int rules_compile(const char *spec, rule_set_t *set);
+
+/**
+ * @brief Evaluates every rule of a set. Nothing is allocated.
+ *
+ * @param set The compiled rules.
+ * @param in The current values.
+ * @param hits One entry per rule of the set, filled in.
+ * @return The number of rules that fired.
+ */
+size_t rules_eval(const rule_set_t *set, const rule_input_t *in,
+                  rule_hit_t *hits);
+
+/**
+ * @brief Tells whether a rule compares processes (proc.*) rather than the
+ *        whole system.
+ */
+bool rules_is_process_rule(const rule_t *rule);
+
+/**
+ * @brief Formats a value in the unit of a rule's metric (e.g. "8.5G").
+ */
+void rules_format_value(const rule_t *rule, double value, char *out,
+                        size_t size);
+
+/**
+ * @brief Prints the known metrics to a stream.
+ */
+void rules_print_metrics(FILE *out);
@@ -0,0 +1,133 @@
+// src/core/search.c
+#include "search.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void init_search_index(search_index_t *idx) { memset(idx, 0, sizeof(*idx)); }
+
+void free_search_index(search_index_t *idx) {
+    free(idx->text);
+    free(idx->offsets);
+    free(idx->matches);
+    init_search_index(idx);
+}
+
+/**
+ * Makes room for count entries of at most text_len bytes in total.
+ *
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+static int reserve_index(search_index_t *idx, size_t count, size_t text_len) {
+    if (text_len > idx->text_capacity) {
+        char *text = realloc(idx->text, text_len);
+        if (!text) {
+            perror("Failed to allocate memory for search index");
+            return -1;
+        }
+        idx->text = text;
+        idx->text_capacity = text_len;
+    }
+
+    if (count > idx->capacity) {
+        size_t *offsets = realloc(idx->offsets, count * sizeof(size_t));
+        if (!offsets) {
+            perror("Failed to allocate memory for search index");
+            return -1;
+        }
+        idx->offsets = offsets;
+
+        unsigned char *matches = realloc(idx->matches, count);
+        if (!matches) {
+            perror("Failed to allocate memory for search index");
+            return -1;
+        }
+        idx->matches = matches;
+        idx->capacity = count;
+    }
+    return 0;
+}
+
+/**
+ * Appends a lowercased copy of a string.
+ */
+static char *append_lower(char *dst, const char *src) {
+    while (*src) {
+        *dst++ = (char)tolower((unsigned char)*src++);
+    }
+    return dst;
+}
+
+int build_search_index(const proc_list_t *list, search_index_t *idx) {
+    idx->count = 0;
+    idx->len = 0;
+
+    // Size everything first so the packing loop never reallocates
+    size_t text_len = 0;
+    for (size_t i = 0; i < list->count; i++) {
+        const proc_info_t *p = &list->procs[i];
+        text_len += strlen(p->user) + strlen(p->command) + 2;
+    }
+    if (reserve_index(idx, list->count, text_len) != 0) {
+        return -1;
+    }
+
+    char *out = idx->text;
+    for (size_t i = 0; i < list->count; i++) {
+        const proc_info_t *p = &list->procs[i];
+        idx->offsets[i] = (size_t)(out - idx->text);
+        out = append_lower(out, p->user);
+        *out++ = '\t';
+        out = append_lower(out, p->command);
+        *out++ = '\n';
+    }
+    idx->len = (size_t)(out - idx->text);
+    idx->count = list->count;
+    memset(idx->matches, 0, idx->count);
+    return 0;
+}
+
+/**
+ * Finds the entry that holds a byte of the packed text.
+ */
+static size_t entry_at(const search_index_t *idx, size_t pos) {
+    size_t lo = 0, hi = idx->count;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (idx->offsets[mid] <= pos) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+size_t search_index_match(search_index_t *idx, const char *needle) {
+    if (idx->count > 0) {
+        memset(idx->matches, 0, idx->count);
+    }
+
+    char lower[SEARCH_MAX_LEN + 1];
+    size_t n = 0;
+    for (; needle[n] && n < SEARCH_MAX_LEN; n++) {
+        lower[n] = (char)tolower((unsigned char)needle[n]);
+    }
+    if (n == 0 || idx->count == 0) {
+        return 0;
+    }
+
+    size_t found = 0;
+    const char *p = idx->text, *end = idx->text + idx->len;
+    while ((p = memmem(p, (size_t)(end - p), lower, n)) != NULL) {
+        size_t entry = entry_at(idx, (size_t)(p - idx->text));
+        idx->matches[entry] = 1;
+        found++;
+
+        // One hit is enough per entry: continue with the next one
+        p = (entry + 1 < idx->count) ? idx->text + idx->offsets[entry + 1]
+                                     : end;
+    }
+    return found;
+}
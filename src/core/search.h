@@ -0,0 +1,61 @@
+// src/core/search.h
+#pragma once
+#include "process.h"
+#include <stddef.h>
+
+// Longest search text that can be typed
+#define SEARCH_MAX_LEN 63
+
+/**
+ * A lowercased copy of the user and command of every process of a snapshot,
+ * packed into one buffer so a search is a single memmem() pass instead of a
+ * walk over the proc_info_t structures.
+ *
+ * Entry i is "user\tcommand\n" and starts at offsets[i]; a search text can't
+ * contain '\t' or '\n', so a hit never spans two fields or two entries.
+ */
+typedef struct {
+    char *text;             // Packed entries
+    size_t len;             // Bytes used in text
+    size_t text_capacity;   // Bytes allocated for text
+    size_t *offsets;        // Start of each entry in text
+    unsigned char *matches; // Non-zero for the entries of the last search
+    size_t count;           // Number of entries
+    size_t capacity;        // Entries allocated for offsets and matches
+} search_index_t;
+
+/**
+ * @brief Initializes a search index.
+ *
+ * @param idx Pointer to the search_index_t to initialize.
+ */
+void init_search_index(search_index_t *idx);
+
+/**
+ * @brief Frees the memory allocated for a search index.
+ *
+ * @param idx Pointer to the search_index_t to free.
+ */
+void free_search_index(search_index_t *idx);
+
+/**
+ * @brief Rebuilds the index from a snapshot.
+ * @details Entry i describes list->procs[i], so the list must not be
+ *          re-sorted while the index is in use. The buffers are reused
+ *          between snapshots.
+ *
+ * @param list Pointer to the proc_list_t to index.
+ * @param idx Pointer to the search_index_t to fill.
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+int build_search_index(const proc_list_t *list, search_index_t *idx);
+
+/**
+ * @brief Marks every entry whose user or command contains a text.
+ * @details The match is case-insensitive. An empty text matches nothing.
+ *
+ * @param idx Pointer to the built search_index_t; idx->matches is updated.
+ * @param needle The text to look for.
+ * @return The number of matching entries.
+ */
+size_t search_index_match(search_index_t *idx, const char *needle);
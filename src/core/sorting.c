@@ -6,20 +6,99 @@
 static sort_by_t g_sort_by = SORT_BY_CPU;
 static sort_direction_t g_sort_direction = DESCENDING;
 
-void sorting_next_column(void) {
-    g_sort_by = (g_sort_by + 1) % SORT_COLUMN_COUNT;
+// Tells which columns are shown (NULL: all of them)
+static bool (*g_column_shown)(sort_by_t column) = NULL;
+
+void sorting_set_column_filter(bool (*shown)(sort_by_t column)) {
+    g_column_shown = shown;
 }
 
-void sorting_prev_column(void) {
-    g_sort_by = (g_sort_by == 0) ? (SORT_COLUMN_COUNT - 1) : (g_sort_by - 1);
+/**
+ * Moves the sorting column by 'step' until it lands on a sortable column
+ * that is shown. Stays put if there is none.
+ */
+static void step_column(int step) {
+    int col = g_sort_by;
+    for (int i = 0; i < SORT_COLUMN_COUNT; i++) {
+        col = (col + step + SORT_COLUMN_COUNT) % SORT_COLUMN_COUNT;
+        if (col > SORT_BY_NONE &&
+            (!g_column_shown || g_column_shown((sort_by_t)col))) {
+            g_sort_by = (sort_by_t)col;
+            return;
+        }
+    }
 }
 
+void sorting_next_column(void) { step_column(1); }
+
+void sorting_prev_column(void) { step_column(-1); }
+
+void sorting_set_column(sort_by_t column) { g_sort_by = column; }
+
 void sorting_flip_direction(void) {
     g_sort_direction = (g_sort_direction == ASCENDING) ? DESCENDING : ASCENDING;
 }
 
 sort_by_t sorting_get_current_column(void) { return g_sort_by; }
 
+/**
+ * The value compared when sorting by an I/O column. Processes without known
+ * rates sort below idle ones.
+ */
+static double io_sort_value(const proc_info_t *p) {
+    if (!p->io_valid) {
+        return -1.0;
+    }
+    return (g_sort_by == SORT_BY_IO_READ) ? p->io_read_rate : p->io_write_rate;
+}
+
+/**
+ * The value compared when sorting by PSS. Processes whose PSS is unknown
+ * sort below the others.
+ */
+static double pss_sort_value(const proc_info_t *p) {
+    return p->smaps_valid ? (double)p->pss_mem : -1.0;
+}
+
+/**
+ * The value compared when sorting by a fault, context switch or scheduler
+ * column. Processes whose value is unknown sort below idle ones.
+ */
+static double event_sort_value(const proc_info_t *p) {
+    switch (g_sort_by) {
+    case SORT_BY_MINFLT:
+        return p->minflt_rate;
+    case SORT_BY_MAJFLT:
+        return p->majflt_rate;
+    case SORT_BY_VCSW:
+        return p->ctxsw_valid ? p->vcsw_rate : -1.0;
+    case SORT_BY_IVCSW:
+        return p->ctxsw_valid ? p->ivcsw_rate : -1.0;
+    case SORT_BY_SCHED_RUN:
+        return p->sched_valid ? p->sched_run_percent : -1.0;
+    default:
+        return p->sched_valid ? p->sched_wait_percent : -1.0;
+    }
+}
+
+/**
+ * The value compared when sorting by a cumulative total.
+ */
+static unsigned long long total_sort_value(const proc_info_t *p) {
+    switch (g_sort_by) {
+    case SORT_BY_TOTAL_CPU:
+        return p->totals.cpu_ticks;
+    case SORT_BY_TOTAL_READ:
+        return p->totals.read_bytes;
+    case SORT_BY_TOTAL_WRITE:
+        return p->totals.write_bytes;
+    case SORT_BY_TOTAL_MINFLT:
+        return p->totals.minflt;
+    default:
+        return p->totals.majflt;
+    }
+}
+
 int compare_procs(const void *a, const void *b) {
     const proc_info_t *p1 = (const proc_info_t *)a;
     const proc_info_t *p2 = (const proc_info_t *)b;
@@ -27,24 +106,25 @@ int compare_procs(const void *a, const void *b) {
 
     switch (g_sort_by) {
     case SORT_BY_CPU:
-        // For numerical values, descending order is usually preferred.
-        if (p2->cpu_percent > p1->cpu_percent)
+        // Natural (ascending) order; the DESCENDING default puts the
+        // busiest processes first.
+        if (p1->cpu_percent > p2->cpu_percent)
             result = 1;
-        if (p2->cpu_percent < p1->cpu_percent)
+        if (p1->cpu_percent < p2->cpu_percent)
             result = -1;
         break;
 
     case SORT_BY_MEM:
-        if (p2->mem_percent > p1->mem_percent)
+        if (p1->mem_percent > p2->mem_percent)
             result = 1;
-        if (p2->mem_percent < p1->mem_percent)
+        if (p1->mem_percent < p2->mem_percent)
             result = -1;
         break;
 
     case SORT_BY_TIME:
-        if (p2->uptime_ticks > p1->uptime_ticks)
+        if (p1->uptime_ticks > p2->uptime_ticks)
             result = 1;
-        if (p2->uptime_ticks < p1->uptime_ticks)
+        if (p1->uptime_ticks < p2->uptime_ticks)
             result = -1;
         break;
 
@@ -58,6 +138,87 @@ int compare_procs(const void *a, const void *b) {
         result = strncmp(p1->command, p2->command, sizeof(p1->command));
         break;
 
+    case SORT_BY_IO_READ:
+    case SORT_BY_IO_WRITE:
+        if (io_sort_value(p1) > io_sort_value(p2))
+            result = 1;
+        if (io_sort_value(p1) < io_sort_value(p2))
+            result = -1;
+        break;
+
+    case SORT_BY_PSS:
+        if (pss_sort_value(p1) > pss_sort_value(p2))
+            result = 1;
+        if (pss_sort_value(p1) < pss_sort_value(p2))
+            result = -1;
+        break;
+
+    case SORT_BY_MINFLT:
+    case SORT_BY_MAJFLT:
+    case SORT_BY_VCSW:
+    case SORT_BY_IVCSW:
+    case SORT_BY_SCHED_RUN:
+    case SORT_BY_SCHED_WAIT:
+        if (event_sort_value(p1) > event_sort_value(p2))
+            result = 1;
+        if (event_sort_value(p1) < event_sort_value(p2))
+            result = -1;
+        break;
+
+    case SORT_BY_TOTAL_CPU:
+    case SORT_BY_TOTAL_READ:
+    case SORT_BY_TOTAL_WRITE:
+    case SORT_BY_TOTAL_MINFLT:
+    case SORT_BY_TOTAL_MAJFLT:
+        if (total_sort_value(p1) > total_sort_value(p2))
+            result = 1;
+        if (total_sort_value(p1) < total_sort_value(p2))
+            result = -1;
+        break;
+
+    default:
+        result = 0;
+    }
+
+    // Apply the global sort direction(g_sort_direction)
+    return result * g_sort_direction;
+}
+
+int compare_groups(const void *a, const void *b) {
+    const cgroup_group_t *g1 = (const cgroup_group_t *)a;
+    const cgroup_group_t *g2 = (const cgroup_group_t *)b;
+    int result = 0;
+
+    switch (g_sort_by) {
+    case SORT_BY_CPU:
+        if (g1->cpu_percent > g2->cpu_percent)
+            result = 1;
+        if (g1->cpu_percent < g2->cpu_percent)
+            result = -1;
+        break;
+
+    case SORT_BY_MEM:
+        if (g1->res_mem > g2->res_mem)
+            result = 1;
+        if (g1->res_mem < g2->res_mem)
+            result = -1;
+        break;
+
+    case SORT_BY_TIME:
+        if (g1->cpu_ticks > g2->cpu_ticks)
+            result = 1;
+        if (g1->cpu_ticks < g2->cpu_ticks)
+            result = -1;
+        break;
+
+    case SORT_BY_PID:
+        result = (int)g1->nprocs - (int)g2->nprocs;
+        break;
+
+    case SORT_BY_COMMAND:
+        result = strcmp(g1->cgroup, g2->cgroup);
+        break;
+
     default:
         result = 0;
     }
@@ -1,15 +1,31 @@
 // src/core/sorting.h
 #pragma once
+#include "grouping.h"
 #include "process.h"
+#include <stdbool.h>
 
 typedef enum {
-    SORT_BY_NONE = 1, // A marker for non-sortable columns
+    SORT_BY_NONE = 1,     // A marker for non-sortable columns
     SORT_BY_PID,
     SORT_BY_CPU,
     SORT_BY_MEM,
     SORT_BY_TIME,
     SORT_BY_COMMAND,
-    SORT_COLUMN_COUNT, // How many modes?
+    SORT_BY_IO_READ,      // Storage read rate (PROC_FIELD_IO)
+    SORT_BY_IO_WRITE,     // Storage write rate (PROC_FIELD_IO)
+    SORT_BY_PSS,          // Proportional set size (smaps_rollup)
+    SORT_BY_MINFLT,       // Minor page fault rate
+    SORT_BY_MAJFLT,       // Major page fault rate
+    SORT_BY_VCSW,         // Voluntary context switch rate (PROC_FIELD_CTXSW)
+    SORT_BY_IVCSW,        // Involuntary context switch rate (PROC_FIELD_CTXSW)
+    SORT_BY_SCHED_RUN,    // On-CPU time from schedstat (PROC_FIELD_SCHED)
+    SORT_BY_SCHED_WAIT,   // Run queue wait from schedstat (PROC_FIELD_SCHED)
+    SORT_BY_TOTAL_CPU,    // CPU time since the baseline (cumulative mode)
+    SORT_BY_TOTAL_READ,   // Bytes read since the baseline (cumulative mode)
+    SORT_BY_TOTAL_WRITE,  // Bytes written since the baseline (cumulative mode)
+    SORT_BY_TOTAL_MINFLT, // Minor faults since the baseline (cumulative mode)
+    SORT_BY_TOTAL_MAJFLT, // Major faults since the baseline (cumulative mode)
+    SORT_COLUMN_COUNT,    // How many modes?
 } sort_by_t;
 
 typedef enum {
@@ -18,17 +34,33 @@ typedef enum {
 } sort_direction_t;
 
 /**
- * @brief Change the current sorting column to the next one.
- *        (e.g. SORT_BY_PID(0) -> SORT_BY_CPU(1) -> SORT_BY_MEM(2) ...)
+ * @brief Set which columns sorting_next_column() and sorting_prev_column()
+ *        step through.
+ *
+ * @param shown Tells whether the column of a sort key is shown, or NULL to
+ *              step through every column.
+ */
+void sorting_set_column_filter(bool (*shown)(sort_by_t column));
+
+/**
+ * @brief Change the current sorting column to the next one that is shown.
+ *        (e.g. SORT_BY_PID -> SORT_BY_CPU -> SORT_BY_MEM ...)
  */
 void sorting_next_column(void);
 
 /**
- * @brief Change the current sorting column to the previous one.
- *        (e.g. SORT_BY_MEM(2) -> SORT_BY_CPU(1) -> SORT_BY_PID(0) ...)
+ * @brief Change the current sorting column to the previous one that is
+ *        shown. (e.g. SORT_BY_MEM -> SORT_BY_CPU -> SORT_BY_PID ...)
  */
 void sorting_prev_column(void);
 
+/**
+ * @brief Change the current sorting column to the given one.
+ *
+ * @param column The new sort_by_t value.
+ */
+void sorting_set_column(sort_by_t column);
+
 /**
  * @brief Flip the current sorting direction.
  *        (e.g. ASCENDING -> DESCENDING, DESCENDING -> ASCENDING)
@@ -53,3 +85,18 @@ sort_by_t sorting_get_current_column(void);
  *         0 if they are equal.
  */
 int compare_procs(const void *a, const void *b);
+
+/**
+ * @brief The comparison function used by qsort for cgroup groups
+ * @details Same as compare_procs(), but for cgroup_group_t structs. The
+ *          process columns map to their aggregated counterparts: PID sorts by
+ *          the number of processes, TIME by the summed CPU time and COMMAND by
+ *          the cgroup path.
+ *
+ * @param a Pointer to the first cgroup_group_t struct.
+ * @param b Pointer to the second cgroup_group_t struct.
+ * @return < 0 if a should come before b,
+ *         > 0 if a should come after b,
+ *         0 if they are equal.
+ */
+int compare_groups(const void *a, const void *b);
@@ -0,0 +1,252 @@
+// src/core/tree.c
+#include "tree.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uthash.h>
+
+/**
+ * A process whose subtree is collapsed.
+ */
+typedef struct {
+    pid_t pid; // Process ID (hash key)
+    UT_hash_handle hh;
+} collapsed_t;
+
+// Collapsed subtrees, keyed by the PID at their top
+static collapsed_t *g_collapsed = NULL;
+
+void init_process_tree(proc_tree_t *tree) { memset(tree, 0, sizeof(*tree)); }
+
+void free_process_tree(proc_tree_t *tree) {
+    free(tree->nodes);
+    free(tree->order);
+    free(tree->pid_index);
+    init_process_tree(tree);
+}
+
+static size_t pid_slot(pid_t pid, size_t index_size) {
+    // Fibonacci hashing spreads consecutive PIDs over the table
+    return ((uint32_t)pid * 2654435761u) & (index_size - 1);
+}
+
+static int lookup_pid(const proc_tree_t *tree, const proc_info_t *procs,
+                      pid_t pid) {
+    size_t mask = tree->index_size - 1;
+    for (size_t s = pid_slot(pid, tree->index_size);; s = (s + 1) & mask) {
+        int idx = tree->pid_index[s];
+        if (idx < 0 || procs[idx].pid == pid) {
+            return idx;
+        }
+    }
+}
+
+/**
+ * Makes sure there is room for n nodes and a PID index with at most 50% load.
+ */
+static int reserve_tree(proc_tree_t *tree, size_t n) {
+    if (n > tree->capacity) {
+        size_t new_capacity = (tree->capacity == 0) ? 64 : tree->capacity;
+        while (new_capacity < n) {
+            new_capacity *= 2;
+        }
+        tree_node_t *nodes =
+            realloc(tree->nodes, new_capacity * sizeof(tree_node_t));
+        if (!nodes) {
+            perror("Failed to allocate memory for process tree");
+            return -1;
+        }
+        tree->nodes = nodes;
+        int *order = realloc(tree->order, new_capacity * sizeof(int));
+        if (!order) {
+            perror("Failed to allocate memory for process tree");
+            return -1;
+        }
+        tree->order = order;
+        tree->capacity = new_capacity;
+    }
+
+    if (tree->index_size < 2 * n || tree->index_size == 0) {
+        size_t new_size = (tree->index_size == 0) ? 128 : tree->index_size;
+        while (new_size < 2 * n) {
+            new_size *= 2;
+        }
+        int *index = realloc(tree->pid_index, new_size * sizeof(int));
+        if (!index) {
+            perror("Failed to allocate memory for process tree");
+            return -1;
+        }
+        tree->pid_index = index;
+        tree->index_size = new_size;
+    }
+    return 0;
+}
+
+/**
+ * Returns the node after 'node' in depth-first order, or -1 at the end.
+ * Descendants of collapsed nodes are skipped if skip_collapsed is set.
+ * 'depth' (optional) is adjusted by the levels moved.
+ */
+static int next_node(const proc_tree_t *tree, int node, int skip_collapsed,
+                     unsigned *depth) {
+    const tree_node_t *n = &tree->nodes[node];
+    if (n->first_child >= 0 && !(skip_collapsed && n->collapsed)) {
+        if (depth) {
+            (*depth)++;
+        }
+        return n->first_child;
+    }
+
+    // No (visible) children: move to the next sibling of the closest
+    // ancestor that has one
+    while (node >= 0) {
+        if (tree->nodes[node].next_sibling >= 0) {
+            return tree->nodes[node].next_sibling;
+        }
+        node = tree->nodes[node].parent;
+        if (node >= 0 && depth) {
+            (*depth)--;
+        }
+    }
+    return -1;
+}
+
+int build_process_tree(const proc_list_t *list, proc_tree_t *tree) {
+    size_t n = list->count;
+    tree->count = 0;
+    tree->first_root = -1;
+    if (reserve_tree(tree, n) != 0) {
+        return -1;
+    }
+    tree->count = n;
+
+    // Index every process by PID (-1 marks an empty slot)
+    memset(tree->pid_index, 0xff, tree->index_size * sizeof(int));
+    size_t mask = tree->index_size - 1;
+    for (size_t i = 0; i < n; i++) {
+        size_t s = pid_slot(list->procs[i].pid, tree->index_size);
+        while (tree->pid_index[s] >= 0) {
+            s = (s + 1) & mask;
+        }
+        tree->pid_index[s] = (int)i;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        const proc_info_t *p = &list->procs[i];
+        tree_node_t *node = &tree->nodes[i];
+        node->parent = node->first_child = node->next_sibling = -1;
+        node->descendants = 0;
+        node->subtree_cpu = p->cpu_percent;
+        node->subtree_mem = p->mem_percent;
+        node->subtree_res = p->res_mem;
+        node->collapsed = 0;
+    }
+
+    // Link back to front: prepending keeps the children in list order
+    for (size_t i = n; i-- > 0;) {
+        const proc_info_t *p = &list->procs[i];
+        int parent = (p->ppid > 0 && p->ppid != p->pid)
+                         ? lookup_pid(tree, list->procs, p->ppid)
+                         : -1;
+        if (parent >= 0) {
+            tree->nodes[i].parent = parent;
+            tree->nodes[i].next_sibling = tree->nodes[parent].first_child;
+            tree->nodes[parent].first_child = (int)i;
+        } else {
+            tree->nodes[i].next_sibling = tree->first_root;
+            tree->first_root = (int)i;
+        }
+    }
+
+    // Mark collapsed subtrees, forgetting processes that are gone
+    collapsed_t *c, *tmp;
+    HASH_ITER(hh, g_collapsed, c, tmp) {
+        int idx = lookup_pid(tree, list->procs, c->pid);
+        if (idx >= 0) {
+            tree->nodes[idx].collapsed = 1;
+        } else {
+            HASH_DEL(g_collapsed, c);
+            free(c);
+        }
+    }
+
+    // Sum up subtrees: children come after their parent in depth-first
+    // order, so walking that order backwards visits children first
+    size_t ordered = 0;
+    for (int node = tree->first_root; node >= 0;
+         node = next_node(tree, node, 0, NULL)) {
+        tree->order[ordered++] = node;
+    }
+    for (size_t i = ordered; i-- > 0;) {
+        const tree_node_t *node = &tree->nodes[tree->order[i]];
+        if (node->parent >= 0) {
+            tree_node_t *parent = &tree->nodes[node->parent];
+            parent->descendants += node->descendants + 1;
+            parent->subtree_cpu += node->subtree_cpu;
+            parent->subtree_mem += node->subtree_mem;
+            parent->subtree_res += node->subtree_res;
+        }
+    }
+
+    return 0;
+}
+
+void tree_iter_begin(const proc_tree_t *tree, tree_iter_t *it) {
+    it->node = tree->first_root;
+    it->depth = 0;
+}
+
+void tree_iter_next(const proc_tree_t *tree, tree_iter_t *it) {
+    if (it->node >= 0) {
+        it->node = next_node(tree, it->node, 1, &it->depth);
+    }
+}
+
+int tree_visible_row(const proc_tree_t *tree, size_t row) {
+    tree_iter_t it;
+    tree_iter_begin(tree, &it);
+    for (size_t i = 0; i < row && it.node >= 0; i++) {
+        tree_iter_next(tree, &it);
+    }
+    return it.node;
+}
+
+long tree_node_row(const proc_tree_t *tree, int node) {
+    tree_iter_t it;
+    tree_iter_begin(tree, &it);
+    for (long row = 0; it.node >= 0; row++) {
+        if (it.node == node) {
+            return row;
+        }
+        tree_iter_next(tree, &it);
+    }
+    return -1;
+}
+
+size_t tree_visible_count(const proc_tree_t *tree) {
+    size_t rows = 0;
+    tree_iter_t it;
+    for (tree_iter_begin(tree, &it); it.node >= 0; tree_iter_next(tree, &it)) {
+        rows++;
+    }
+    return rows;
+}
+
+void tree_toggle_collapsed(pid_t pid) {
+    collapsed_t *c = NULL;
+    HASH_FIND_INT(g_collapsed, &pid, c);
+    if (c) {
+        HASH_DEL(g_collapsed, c);
+        free(c);
+        return;
+    }
+
+    c = calloc(1, sizeof(*c));
+    if (!c) {
+        perror("Failed to allocate memory for collapsed subtree");
+        return;
+    }
+    c->pid = pid;
+    HASH_ADD_INT(g_collapsed, pid, c);
+}
@@ -0,0 +1,120 @@
+// src/core/tree.h
+#pragma once
+#include "process.h"
+#include <stddef.h>
+
+/**
+ * A node of the process tree. The links are indices into the process list
+ * the tree was built from (-1 if none); siblings are chained through
+ * next_sibling, and so are the roots.
+ */
+typedef struct {
+    int parent;                // Parent process
+    int first_child;           // First child process
+    int next_sibling;          // Next process with the same parent
+    unsigned descendants;      // Number of processes below this one
+    double subtree_cpu;        // %CPU of the process and its descendants
+    double subtree_mem;        // %MEM of the process and its descendants
+    unsigned long subtree_res; // RES (KiB) of the process and descendants
+    int collapsed;             // Descendants are hidden
+} tree_node_t;
+
+/**
+ * Represents the process forest of one collection.
+ */
+typedef struct {
+    tree_node_t *nodes; // One node per process, same order as the list
+    size_t count;       // Number of nodes
+    size_t capacity;    // Allocated nodes
+    int first_root;     // First root (process without a known parent)
+    int *order;         // All nodes in depth-first order (scratch)
+    int *pid_index;     // Open-addressing table: PID -> node index
+    size_t index_size;  // Number of slots in pid_index (a power of two)
+} proc_tree_t;
+
+/**
+ * Walks the visible rows of a tree in display (depth-first) order.
+ */
+typedef struct {
+    int node;       // Current node, or -1 when the walk is over
+    unsigned depth; // Depth of the current node (roots are 0)
+} tree_iter_t;
+
+/**
+ * @brief Initializes a process tree (proc_tree_t).
+ *
+ * @param tree Pointer to the proc_tree_t to initialize.
+ */
+void init_process_tree(proc_tree_t *tree);
+
+/**
+ * @brief Frees the memory allocated for a process tree (proc_tree_t).
+ *
+ * @param tree Pointer to the proc_tree_t to free.
+ */
+void free_process_tree(proc_tree_t *tree);
+
+/**
+ * @brief Builds the process forest of a collection in O(n).
+ * @details Children are linked in the order of the list, so a list sorted
+ *          with compare_procs() gives siblings sorted by the current sort
+ *          key. Subtree totals are filled in for every node.
+ *
+ * @param list Pointer to the (sorted) proc_list_t to build the tree from.
+ * @param tree Pointer to the proc_tree_t to fill (reset first).
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+int build_process_tree(const proc_list_t *list, proc_tree_t *tree);
+
+/**
+ * @brief Starts a walk over the visible rows, beginning at the first root.
+ *
+ * @param tree Pointer to the built proc_tree_t.
+ * @param it Pointer to the tree_iter_t to initialize.
+ */
+void tree_iter_begin(const proc_tree_t *tree, tree_iter_t *it);
+
+/**
+ * @brief Advances a walk to the next visible row, skipping the descendants
+ *        of collapsed nodes.
+ *
+ * @param tree Pointer to the built proc_tree_t.
+ * @param it Pointer to the tree_iter_t to advance; it->node becomes -1 at the
+ *           end of the tree.
+ */
+void tree_iter_next(const proc_tree_t *tree, tree_iter_t *it);
+
+/**
+ * @brief Finds the node shown on a given visible row.
+ *
+ * @param tree Pointer to the built proc_tree_t.
+ * @param row Zero-based visible row.
+ * @return The node index, or -1 if the tree has fewer visible rows.
+ */
+int tree_visible_row(const proc_tree_t *tree, size_t row);
+
+/**
+ * @brief Finds the visible row a node is shown on.
+ *
+ * @param tree Pointer to the built proc_tree_t.
+ * @param node The node index.
+ * @return The zero-based row, or -1 if the node is inside a collapsed subtree.
+ */
+long tree_node_row(const proc_tree_t *tree, int node);
+
+/**
+ * @brief Counts the visible rows (nodes not hidden by a collapsed ancestor).
+ *
+ * @param tree Pointer to the built proc_tree_t.
+ * @return The number of visible rows.
+ */
+size_t tree_visible_count(const proc_tree_t *tree);
+
+/**
+ * @brief Collapses or expands the subtree of a process.
+ * @details The setting is remembered across collections for as long as the
+ *          process exists.
+ *
+ * @param pid The process ID at the top of the subtree.
+ */
+void tree_toggle_collapsed(pid_t pid);
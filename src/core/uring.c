@@ -0,0 +1,329 @@
+// src/core/uring.c
+#include "uring.h"
+#include <stddef.h>
+
+#ifdef TOPLITE_IO_URING
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+struct uring {
+    int fd;                     // io_uring file descriptor
+    unsigned entries;           // Submission queue size
+    void *sq_ring;              // Mapped submission ring
+    size_t sq_ring_size;        // Its size
+    void *cq_ring;              // Mapped completion ring (may be sq_ring)
+    size_t cq_ring_size;        // Its size
+    struct io_uring_sqe *sqes;  // Mapped submission queue entries
+    unsigned *sq_head;          // Consumed by the kernel
+    unsigned *sq_tail;          // Produced by us
+    unsigned *sq_mask;          // entries - 1
+    unsigned *sq_array;         // Index of each submitted entry
+    unsigned *cq_head;          // Consumed by us
+    unsigned *cq_tail;          // Produced by the kernel
+    unsigned *cq_mask;          // Completion ring size - 1
+    struct io_uring_cqe *cqes;  // Completion queue entries
+    unsigned sqe_tail;          // Entries queued locally (not yet visible)
+    unsigned inflight;          // Submitted but not completed
+};
+
+static int sys_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_enter(int fd, unsigned to_submit, unsigned min_complete,
+                     unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                        flags, NULL, 0);
+}
+
+static int sys_register(int fd, unsigned opcode, void *arg, unsigned nr) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr);
+}
+
+uring_t *uring_open(unsigned entries, unsigned nfiles) {
+#ifndef IORING_FEAT_LINKED_FILE
+    (void)entries;
+    (void)nfiles;
+    return NULL;
+#else
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    int fd = sys_setup(entries, &p);
+    if (fd < 0) {
+        return NULL; // ENOSYS, EPERM (disabled or filtered), ...
+    }
+    // A read linked to the open of its file needs LINKED_FILE (Linux 5.17)
+    if (!(p.features & IORING_FEAT_LINKED_FILE)) {
+        close(fd);
+        return NULL;
+    }
+
+    uring_t *r = calloc(1, sizeof(*r));
+    if (!r) {
+        perror("Failed to allocate memory for io_uring");
+        close(fd);
+        return NULL;
+    }
+    r->fd = fd;
+    r->entries = p.sq_entries;
+    r->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_ring_size =
+        p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (r->cq_ring_size > r->sq_ring_size) {
+            r->sq_ring_size = r->cq_ring_size;
+        }
+        r->cq_ring_size = r->sq_ring_size;
+    }
+
+    r->sq_ring = mmap(NULL, r->sq_ring_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    r->cq_ring = r->sq_ring;
+    if (r->sq_ring != MAP_FAILED && !(p.features & IORING_FEAT_SINGLE_MMAP)) {
+        r->cq_ring = mmap(NULL, r->cq_ring_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    }
+    r->sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe),
+                   PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                   IORING_OFF_SQES);
+    if (r->sq_ring == MAP_FAILED || r->cq_ring == MAP_FAILED ||
+        r->sqes == MAP_FAILED) {
+        if (r->sq_ring != MAP_FAILED) {
+            r->sq_ring = NULL; // uring_close() unmaps what was mapped
+        }
+        uring_close(r);
+        return NULL;
+    }
+
+    char *sq = r->sq_ring, *cq = r->cq_ring;
+    r->sq_head = (unsigned *)(sq + p.sq_off.head);
+    r->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned *)(sq + p.sq_off.array);
+    r->cq_head = (unsigned *)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    r->sqe_tail = *r->sq_tail;
+
+    // Empty direct descriptor table for the linked open/read/close chains
+    struct io_uring_rsrc_register files;
+    memset(&files, 0, sizeof(files));
+    files.nr = nfiles;
+    files.flags = IORING_RSRC_REGISTER_SPARSE;
+    if (sys_register(fd, IORING_REGISTER_FILES2, &files, sizeof(files)) < 0) {
+        uring_close(r);
+        return NULL;
+    }
+    return r;
+#endif
+}
+
+void uring_close(uring_t *r) {
+    if (!r) {
+        return;
+    }
+    if (r->sqes && r->sqes != MAP_FAILED) {
+        munmap(r->sqes, r->entries * sizeof(struct io_uring_sqe));
+    }
+    if (r->cq_ring && r->cq_ring != MAP_FAILED && r->cq_ring != r->sq_ring) {
+        munmap(r->cq_ring, r->cq_ring_size);
+    }
+    if (r->sq_ring && r->sq_ring != MAP_FAILED) {
+        munmap(r->sq_ring, r->sq_ring_size);
+    }
+    close(r->fd);
+    free(r);
+}
+
+unsigned uring_space(const uring_t *r) {
+    unsigned head = __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+    return r->entries - (r->sqe_tail - head);
+}
+
+/**
+ * Takes the next free submission queue entry, cleared.
+ */
+static struct io_uring_sqe *get_sqe(uring_t *r) {
+    if (uring_space(r) == 0) {
+        return NULL;
+    }
+    struct io_uring_sqe *sqe = &r->sqes[r->sqe_tail & *r->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    r->sqe_tail++;
+    return sqe;
+}
+
+int uring_prep_statx(uring_t *r, const char *path, unsigned mask,
+                     struct statx *out, uint64_t user_data) {
+    struct io_uring_sqe *sqe = get_sqe(r);
+    if (!sqe) {
+        return -1;
+    }
+    sqe->opcode = IORING_OP_STATX;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (uintptr_t)path;
+    sqe->len = mask;
+    sqe->off = (uintptr_t)out;
+    sqe->user_data = user_data;
+    return 0;
+}
+
+int uring_prep_read_file(uring_t *r, const char *path, void *buf,
+                         unsigned len, unsigned slot, uint64_t user_data) {
+    if (uring_space(r) < 3) {
+        return -1;
+    }
+
+    // A failed open cancels the read; the close always runs (hard link)
+    struct io_uring_sqe *sqe = get_sqe(r);
+    sqe->opcode = IORING_OP_OPENAT;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (uintptr_t)path;
+    sqe->open_flags = O_RDONLY; // O_CLOEXEC is invalid for direct opens
+    sqe->file_index = slot + 1; // 0 means "not direct"
+    sqe->flags = IOSQE_IO_LINK;
+    sqe->user_data = URING_IGNORE;
+
+    sqe = get_sqe(r);
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = (int)slot;
+    sqe->addr = (uintptr_t)buf;
+    sqe->len = len;
+    sqe->flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+    sqe->user_data = user_data;
+
+    sqe = get_sqe(r);
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->file_index = slot + 1;
+    sqe->user_data = URING_IGNORE;
+    return 0;
+}
+
+/**
+ * Delivers the completions that are ready (drops them if 'complete' is
+ * NULL).
+ */
+static void reap(uring_t *r,
+                 void (*complete)(void *ctx, uint64_t user_data, int res),
+                 void *ctx) {
+    unsigned head = *r->cq_head;
+    unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+        if (complete && cqe->user_data != URING_IGNORE) {
+            complete(ctx, cqe->user_data, cqe->res);
+        }
+        head++;
+        r->inflight--;
+    }
+    __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+}
+
+static bool retryable(int err) {
+    return err == EINTR || err == EAGAIN || err == EBUSY;
+}
+
+/**
+ * Waits for every submitted request without reporting it, so the kernel is
+ * done with the callers' buffers. If even waiting fails, uring_close()
+ * cancels what is left.
+ */
+static void drain(uring_t *r) {
+    while (r->inflight > 0) {
+        if (sys_enter(r->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 &&
+            !retryable(errno)) {
+            return;
+        }
+        reap(r, NULL, NULL);
+    }
+}
+
+int uring_run(uring_t *r, void (*complete)(void *ctx, uint64_t user_data,
+                                           int res),
+              void *ctx) {
+    // Publish the queued entries
+    unsigned tail = *r->sq_tail;
+    unsigned to_submit = r->sqe_tail - tail;
+    for (; tail != r->sqe_tail; tail++) {
+        r->sq_array[tail & *r->sq_mask] = tail & *r->sq_mask;
+    }
+    __atomic_store_n(r->sq_tail, tail, __ATOMIC_RELEASE);
+
+    while (to_submit > 0 || r->inflight > 0) {
+        int ret = sys_enter(r->fd, to_submit, r->inflight + to_submit > 0,
+                            IORING_ENTER_GETEVENTS);
+        if (ret < 0) {
+            if (retryable(errno)) {
+                continue;
+            }
+            // Take back the entries that didn't go out, so they aren't
+            // submitted with the next batch, and wait for those that did
+            __atomic_store_n(r->sq_tail, *r->sq_tail - to_submit,
+                             __ATOMIC_RELEASE);
+            r->sqe_tail -= to_submit;
+            drain(r);
+            return -1;
+        }
+        r->inflight += (unsigned)ret;
+        to_submit -= (unsigned)ret;
+        reap(r, complete, ctx);
+    }
+    return 0;
+}
+
+#else // !TOPLITE_IO_URING
+
+uring_t *uring_open(unsigned entries, unsigned nfiles) {
+    (void)entries;
+    (void)nfiles;
+    return NULL;
+}
+
+void uring_close(uring_t *r) { (void)r; }
+
+unsigned uring_space(const uring_t *r) {
+    (void)r;
+    return 0;
+}
+
+int uring_prep_statx(uring_t *r, const char *path, unsigned mask,
+                     struct statx *out, uint64_t user_data) {
+    (void)r;
+    (void)path;
+    (void)mask;
+    (void)out;
+    (void)user_data;
+    return -1;
+}
+
+int uring_prep_read_file(uring_t *r, const char *path, void *buf,
+                         unsigned len, unsigned slot, uint64_t user_data) {
+    (void)r;
+    (void)path;
+    (void)buf;
+    (void)len;
+    (void)slot;
+    (void)user_data;
+    return -1;
+}
+
+int uring_run(uring_t *r, void (*complete)(void *ctx, uint64_t user_data,
+                                           int res),
+              void *ctx) {
+    (void)r;
+    (void)complete;
+    (void)ctx;
+    return -1;
+}
+
+#endif
@@ -0,0 +1,83 @@
+// src/core/uring.h
+#pragma once
+#include <stdint.h>
+
+// Completions of requests queued with this user data are not reported
+#define URING_IGNORE UINT64_MAX
+
+struct statx;
+
+/**
+ * A minimal io_uring (submission and completion rings) for batching small
+ * file reads. Only available if toplite was built with TOPLITE_IO_URING.
+ */
+typedef struct uring uring_t;
+
+/**
+ * @brief Sets up an io_uring.
+ * @details Fails if io_uring is not compiled in, not supported by the
+ *          kernel (linked requests must be able to use a file opened
+ *          earlier in the chain), or disabled (e.g. by a seccomp filter or
+ *          the kernel.io_uring_disabled sysctl).
+ *
+ * @param entries Size of the submission queue.
+ * @param nfiles Number of direct descriptor slots to register.
+ * @return The ring, or NULL if io_uring can't be used.
+ */
+uring_t *uring_open(unsigned entries, unsigned nfiles);
+
+/**
+ * @brief Tears down an io_uring.
+ */
+void uring_close(uring_t *r);
+
+/**
+ * @brief Get the number of requests that can still be queued.
+ */
+unsigned uring_space(const uring_t *r);
+
+/**
+ * @brief Queues a statx() of a path.
+ *
+ * @param r The ring.
+ * @param path The path (must stay valid until uring_run() returns).
+ * @param mask The STATX_* fields wanted.
+ * @param out Where the result is stored.
+ * @param user_data Passed to the completion callback.
+ * @return 0 on success, -1 if the queue is full.
+ */
+int uring_prep_statx(uring_t *r, const char *path, unsigned mask,
+                     struct statx *out, uint64_t user_data);
+
+/**
+ * @brief Queues reading the start of a file: a linked openat(), read() and
+ *        close() on direct descriptor 'slot', so no file descriptor is
+ *        ever installed in the process.
+ * @details Only the read reports its completion (bytes read, or a negative
+ *          errno if the open or the read failed).
+ *
+ * @param r The ring.
+ * @param path The path (must stay valid until uring_run() returns).
+ * @param buf Where the data is read to.
+ * @param len Size of buf.
+ * @param slot Direct descriptor slot (below the nfiles of uring_open()).
+ * @param user_data Passed to the completion callback.
+ * @return 0 on success, -1 if the queue is full.
+ */
+int uring_prep_read_file(uring_t *r, const char *path, void *buf,
+                         unsigned len, unsigned slot, uint64_t user_data);
+
+/**
+ * @brief Submits the queued requests and waits for all of them.
+ *
+ * @param r The ring.
+ * @param complete Called for every completion (except URING_IGNORE ones)
+ *                 with the user data and the result.
+ * @param ctx Passed to the callback.
+ * @return 0 on success, -1 if not all requests could be submitted: the
+ *         submitted ones have completed (unreported) and the rest are
+ *         dropped. Results of earlier callbacks must be ignored.
+ */
+int uring_run(uring_t *r, void (*complete)(void *ctx, uint64_t user_data,
+                                           int res),
+              void *ctx);
@@ -0,0 +1,121 @@
+// src/core/vmstat.c
+#include "vmstat.h"
+#include "../util/util.h"
+#include <stddef.h>
+#include <string.h>
+
+// /proc/vmstat has ~180 lines of "name value"; leaves room for growth
+#define VMSTAT_BUF_SIZE 16384
+
+static int g_vmstat_fd = -1;
+static char g_buf[VMSTAT_BUF_SIZE];
+
+/**
+ * A counter to pick out of /proc/vmstat.
+ */
+typedef struct {
+    const char *name; // Line prefix
+    size_t len;       // strlen(name)
+    size_t offset;    // Where the value goes in vmstat_t
+    int zoned;        // Also sum "name_<zone>" lines (older kernels)
+} vmstat_key_t;
+
+#define KEY(field, zoned)                                                      \
+    {#field, sizeof(#field) - 1, offsetof(vmstat_t, field), zoned}
+
+// The counters shown; their names start with 'a', 'o' or 'p'
+static const vmstat_key_t g_keys[] = {
+    KEY(allocstall, 1),     KEY(oom_kill, 0),       KEY(pgmajfault, 0),
+    KEY(pgscan_kswapd, 1),  KEY(pgscan_direct, 1),  KEY(pgsteal_kswapd, 1),
+    KEY(pgsteal_direct, 1), KEY(pswpin, 0),         KEY(pswpout, 0),
+};
+
+#define KEY_COUNT (sizeof(g_keys) / sizeof(g_keys[0]))
+
+/**
+ * Whether what follows a counter name ends it: the separator, or a zone
+ * suffix for zoned counters. pgscan_direct_throttle is not a zone.
+ */
+static int ends_name(const char *s, int zoned) {
+    if (*s == ' ') {
+        return 1;
+    }
+    if (!zoned || *s != '_') {
+        return 0;
+    }
+    static const char *const zones[] = {"dma ", "dma32 ", "normal ",
+                                        "high ", "movable ", "device "};
+    for (size_t i = 0; i < sizeof(zones) / sizeof(zones[0]); i++) {
+        if (strncmp(s + 1, zones[i], strlen(zones[i])) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Finds the counter a line belongs to, or NULL if it is not one of ours.
+ */
+static const vmstat_key_t *find_key(const char *line) {
+    if (*line != 'a' && *line != 'o' && *line != 'p') {
+        return NULL;
+    }
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        const vmstat_key_t *k = &g_keys[i];
+        if (k->name[0] == line[0] && strncmp(line, k->name, k->len) == 0 &&
+            ends_name(line + k->len, k->zoned)) {
+            return k;
+        }
+    }
+    return NULL;
+}
+
+int read_vmstat(vmstat_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->timestamp = monotonic_seconds();
+    long len = read_file_at(&g_vmstat_fd, "/proc/vmstat", g_buf, sizeof(g_buf));
+    if (len <= 0) {
+        return -1;
+    }
+
+    const char *end = g_buf + len;
+    for (const char *p = g_buf; p < end;) {
+        const char *nl = memchr(p, '\n', (size_t)(end - p));
+        const vmstat_key_t *k = find_key(p);
+        if (k) {
+            const char *v = strchr(p + k->len, ' ');
+            unsigned long long *field =
+                (unsigned long long *)((char *)out + k->offset);
+            *field += strtoull_safe(&v);
+        }
+        p = nl ? nl + 1 : end;
+    }
+    return 0;
+}
+
+void vmstat_rates(const vmstat_t *prev, const vmstat_t *now,
+                  vmstat_rate_t *out) {
+    memset(out, 0, sizeof(*out));
+    double elapsed = now->timestamp - prev->timestamp;
+    if (elapsed <= 0) {
+        return;
+    }
+
+#define RATE(field)                                                            \
+    out->field = now->field > prev->field                                      \
+                     ? (double)(now->field - prev->field) / elapsed            \
+                     : 0.0
+
+    RATE(pgmajfault);
+    RATE(pswpin);
+    RATE(pswpout);
+    RATE(pgscan_kswapd);
+    RATE(pgscan_direct);
+    RATE(pgsteal_kswapd);
+    RATE(pgsteal_direct);
+    RATE(allocstall);
+    out->oom_kill =
+        now->oom_kill > prev->oom_kill ? now->oom_kill - prev->oom_kill : 0;
+
+#undef RATE
+}
@@ -0,0 +1,56 @@
+// src/core/vmstat.h
+#pragma once
+
+/**
+ * The paging and reclaim counters of /proc/vmstat at one point in time.
+ * Counters split by zone on older kernels (e.g. allocstall_normal) are
+ * summed up.
+ */
+typedef struct {
+    unsigned long long pgmajfault;     // Major page faults
+    unsigned long long pswpin;         // Pages swapped in
+    unsigned long long pswpout;        // Pages swapped out
+    unsigned long long pgscan_kswapd;  // Pages scanned by kswapd
+    unsigned long long pgscan_direct;  // Pages scanned by direct reclaim
+    unsigned long long pgsteal_kswapd; // Pages reclaimed by kswapd
+    unsigned long long pgsteal_direct; // Pages reclaimed by direct reclaim
+    unsigned long long allocstall;     // Allocations stalled in direct reclaim
+    unsigned long long oom_kill;       // Processes killed by the OOM killer
+    double timestamp;                  // Monotonic time of the sample
+} vmstat_t;
+
+/**
+ * The paging and reclaim activity between two samples, per second.
+ */
+typedef struct {
+    double pgmajfault;           // Major page faults
+    double pswpin;               // Pages swapped in
+    double pswpout;              // Pages swapped out
+    double pgscan_kswapd;        // Pages scanned by kswapd
+    double pgscan_direct;        // Pages scanned by direct reclaim
+    double pgsteal_kswapd;       // Pages reclaimed by kswapd
+    double pgsteal_direct;       // Pages reclaimed by direct reclaim
+    double allocstall;           // Allocations stalled in direct reclaim
+    unsigned long long oom_kill; // OOM kills (a count, not a rate)
+} vmstat_rate_t;
+
+/**
+ * @brief Reads the paging and reclaim counters from /proc/vmstat.
+ * @details The file stays open between calls and nothing is allocated. Only
+ *          the lines starting with one of the counters' first letters are
+ *          compared, the rest are skipped with memchr().
+ *
+ * @param out Pointer to a vmstat_t structure to populate.
+ * @return 0 on success, -1 on failure.
+ */
+int read_vmstat(vmstat_t *out);
+
+/**
+ * @brief Calculates the paging and reclaim rates between two samples.
+ *
+ * @param prev Pointer to the previous vmstat_t sample.
+ * @param now Pointer to the current vmstat_t sample.
+ * @param out Pointer to a vmstat_rate_t structure to populate.
+ */
+void vmstat_rates(const vmstat_t *prev, const vmstat_t *now,
+                  vmstat_rate_t *out);
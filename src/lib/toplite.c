@@ -0,0 +1,334 @@
+// src/lib/toplite.c
+#include "toplite.h"
+#include "../core/cgroup.h"
+#include "../core/proc_iter.h"
+#include "../core/process.h"
+#include "../core/system.h"
+#include "../util/util.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The public field bits are the internal ones
+_Static_assert(TOPLITE_FIELD_CGROUP == (unsigned)PROC_FIELD_CGROUP &&
+                   TOPLITE_FIELD_IO == (unsigned)PROC_FIELD_IO &&
+                   TOPLITE_FIELD_DETAILS == (unsigned)PROC_FIELD_DETAILS &&
+                   TOPLITE_FIELD_CTXSW == (unsigned)PROC_FIELD_CTXSW &&
+                   TOPLITE_FIELD_SCHED == (unsigned)PROC_FIELD_SCHED,
+               "TOPLITE_FIELD_* must match proc_field_t");
+
+struct toplite_collector {
+    unsigned fields;            // Optional fields to read
+    bool scoped;                // Only the processes of cgroup_dir
+    char cgroup_dir[PATH_MAX];  // Resolved cgroup directory
+    pid_list_t pids;            // PIDs of the cgroup
+    proc_list_t procs;          // Last collection
+    cpu_times_t prev_cpu;       // CPU times of the previous snapshot
+};
+
+struct toplite_snapshot {
+    toplite_system_t system;
+    toplite_process_t *procs; // Sorted by PID
+    size_t count;
+    char *strings; // User names, command lines and cgroups of procs
+};
+
+struct toplite_iter {
+    const toplite_snapshot_t *snapshot;
+    size_t next; // Index of the next process
+};
+
+// Size of the first toplite_config_t; later members are read only when the
+// program's config has them
+#define CONFIG_MIN_SIZE (offsetof(toplite_config_t, cgroup) + sizeof(char *))
+
+// The process state is module-global, so is the collector
+static bool g_collector_exists = false;
+
+toplite_collector_t *toplite_collector_new(const toplite_config_t *config) {
+    if (g_collector_exists) {
+        errno = EBUSY;
+        return NULL;
+    }
+    if (config && config->size < CONFIG_MIN_SIZE) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    toplite_collector_t *c = calloc(1, sizeof(*c));
+    if (!c) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    if (config) {
+        c->fields = config->fields;
+        if (config->cgroup) {
+            if (cgroup_resolve_path(config->cgroup, c->cgroup_dir,
+                                    sizeof(c->cgroup_dir)) != 0) {
+                free(c);
+                errno = ENOENT;
+                return NULL;
+            }
+            c->scoped = true;
+        }
+    }
+    init_pid_list(&c->pids);
+    init_process_list(&c->procs);
+    read_cpu_times(&c->prev_cpu);
+    g_collector_exists = true;
+    return c;
+}
+
+void toplite_collector_free(toplite_collector_t *collector) {
+    if (!collector) {
+        return;
+    }
+    free_pid_list(&collector->pids);
+    free_process_list(&collector->procs);
+    free(collector);
+    g_collector_exists = false;
+}
+
+static int compare_pid(const void *a, const void *b) {
+    pid_t pa = ((const proc_info_t *)a)->pid;
+    pid_t pb = ((const proc_info_t *)b)->pid;
+    return (pa > pb) - (pa < pb);
+}
+
+/**
+ * Fills the system-wide part of a snapshot.
+ */
+static void take_system(toplite_collector_t *c, toplite_system_t *sys,
+                        mem_info_t *mem, task_counts_t *tc) {
+    cpu_times_t now_cpu;
+    cpu_percent_t cpu = {0};
+    if (read_cpu_times(&now_cpu) == 0) {
+        cpu_percent(&c->prev_cpu, &now_cpu, &cpu);
+        c->prev_cpu = now_cpu;
+    }
+    load_avg_t ld = {0};
+    read_loadavg(&ld);
+
+    sys->timestamp = monotonic_seconds();
+    sys->cpu_user = cpu.us;
+    sys->cpu_system = cpu.sy;
+    sys->cpu_nice = cpu.ni;
+    sys->cpu_idle = cpu.id;
+    sys->cpu_iowait = cpu.wa;
+    sys->cpu_irq = cpu.hi;
+    sys->cpu_softirq = cpu.si;
+    sys->cpu_steal = cpu.st;
+    sys->mem_total = mem->mem_total;
+    sys->mem_free = mem->mem_free;
+    sys->mem_available = mem->mem_available;
+    sys->mem_cached =
+        mem->buffers + mem->cached + mem->sreclaimable - mem->shmem;
+    sys->swap_total = mem->swap_total;
+    sys->swap_free = mem->swap_free;
+    sys->load1 = ld.load1;
+    sys->load5 = ld.load5;
+    sys->load15 = ld.load15;
+    read_uptime(&sys->uptime);
+    sys->tasks_total = tc->total;
+    sys->tasks_running = tc->running;
+    sys->tasks_sleeping = tc->sleeping;
+    sys->tasks_stopped = tc->stopped;
+    sys->tasks_zombie = tc->zombie;
+    sys->hz = sys_hz();
+}
+
+/**
+ * Copies a string into the string block of a snapshot.
+ */
+static const char *put_string(char **pos, const char *s) {
+    const char *start = *pos;
+    size_t len = strlen(s) + 1;
+    memcpy(*pos, s, len);
+    *pos += len;
+    return start;
+}
+
+toplite_snapshot_t *toplite_snapshot_take(toplite_collector_t *collector) {
+    toplite_collector_t *c = collector;
+    mem_info_t mem = {0};
+    task_counts_t tc = {0};
+    if (read_meminfo(&mem) != 0) {
+        return NULL;
+    }
+
+    process_set_optional_fields(c->fields);
+    if (c->scoped) {
+        if (cgroup_collect_pids(c->cgroup_dir, &c->pids) != 0) {
+            return NULL;
+        }
+        scan_task_states_pids(c->pids.pids, c->pids.count, &tc);
+        if (collect_processes(&c->procs, c->pids.pids, c->pids.count,
+                              mem.mem_total) != 0) {
+            return NULL;
+        }
+    } else {
+        scan_task_states(&tc);
+        if (collect_all_processes(&c->procs, mem.mem_total) != 0) {
+            return NULL;
+        }
+    }
+    qsort(c->procs.procs, c->procs.count, sizeof(proc_info_t), compare_pid);
+
+    // One block for all strings, so a snapshot is three allocations
+    size_t strings_len = 0;
+    for (size_t i = 0; i < c->procs.count; i++) {
+        const proc_info_t *p = &c->procs.procs[i];
+        strings_len += strlen(p->user) + strlen(p->command) + 2;
+        if (p->cgroup) {
+            strings_len += strlen(p->cgroup) + 1;
+        }
+    }
+
+    toplite_snapshot_t *s = calloc(1, sizeof(*s));
+    if (s) {
+        s->procs = calloc(c->procs.count ? c->procs.count : 1,
+                          sizeof(*s->procs));
+        s->strings = malloc(strings_len ? strings_len : 1);
+    }
+    if (!s || !s->procs || !s->strings) {
+        toplite_snapshot_free(s);
+        errno = ENOMEM;
+        return NULL;
+    }
+    take_system(c, &s->system, &mem, &tc);
+
+    char *pos = s->strings;
+    for (size_t i = 0; i < c->procs.count; i++) {
+        const proc_info_t *p = &c->procs.procs[i];
+        toplite_process_t *r = &s->procs[i];
+        r->pid = p->pid;
+        r->ppid = p->ppid;
+        r->uid = p->uid;
+        r->state = p->state;
+        r->priority = strcmp(p->priority, "rt") == 0 ? -1 : atoi(p->priority);
+        r->nice = p->nice;
+        r->num_threads = p->num_threads;
+        r->last_cpu = p->last_cpu;
+        r->start_ticks = p->uptime_ticks;
+        r->cpu_ticks = p->cpu_ticks;
+        r->virt = p->virt_mem;
+        r->res = p->res_mem;
+        r->shr = p->shr_mem;
+        r->cpu_percent = p->cpu_percent;
+        r->mem_percent = p->mem_percent;
+        r->minflt_rate = p->minflt_rate;
+        r->majflt_rate = p->majflt_rate;
+        r->io_read_rate = p->io_read_rate;
+        r->io_write_rate = p->io_write_rate;
+        r->vcsw_rate = p->vcsw_rate;
+        r->ivcsw_rate = p->ivcsw_rate;
+        r->sched_run_percent = p->sched_run_percent;
+        r->sched_wait_percent = p->sched_wait_percent;
+        r->user = put_string(&pos, p->user);
+        r->command = put_string(&pos, p->command);
+        r->cgroup = p->cgroup ? put_string(&pos, p->cgroup) : NULL;
+    }
+    s->count = c->procs.count;
+    return s;
+}
+
+void toplite_snapshot_free(toplite_snapshot_t *snapshot) {
+    if (!snapshot) {
+        return;
+    }
+    free(snapshot->procs);
+    free(snapshot->strings);
+    free(snapshot);
+}
+
+const toplite_system_t *toplite_snapshot_system(const toplite_snapshot_t *s) {
+    return &s->system;
+}
+
+size_t toplite_snapshot_count(const toplite_snapshot_t *s) { return s->count; }
+
+const toplite_process_t *toplite_snapshot_at(const toplite_snapshot_t *s,
+                                             size_t index) {
+    return index < s->count ? &s->procs[index] : NULL;
+}
+
+const toplite_process_t *toplite_snapshot_find(const toplite_snapshot_t *s,
+                                               pid_t pid) {
+    size_t lo = 0, hi = s->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (s->procs[mid].pid < pid) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo < s->count && s->procs[lo].pid == pid) ? &s->procs[lo] : NULL;
+}
+
+toplite_iter_t *toplite_iter_new(const toplite_snapshot_t *s) {
+    toplite_iter_t *it = malloc(sizeof(*it));
+    if (!it) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    it->snapshot = s;
+    it->next = 0;
+    return it;
+}
+
+void toplite_iter_free(toplite_iter_t *it) { free(it); }
+
+const toplite_process_t *toplite_iter_next(toplite_iter_t *it) {
+    return toplite_snapshot_at(it->snapshot, it->next++);
+}
+
+/**
+ * Tells whether anything a viewer would notice changed.
+ */
+static bool process_changed(const toplite_process_t *a,
+                            const toplite_process_t *b) {
+    return a->state != b->state || a->cpu_ticks != b->cpu_ticks ||
+           a->res != b->res || a->virt != b->virt ||
+           a->num_threads != b->num_threads || a->nice != b->nice ||
+           a->priority != b->priority || strcmp(a->command, b->command) != 0;
+}
+
+int toplite_snapshot_diff(const toplite_snapshot_t *old,
+                          const toplite_snapshot_t *cur, toplite_diff_fn fn,
+                          void *ctx) {
+    // Both process arrays are sorted by PID: merge them
+    size_t i = 0, j = 0;
+    int ret = 0;
+    while (ret == 0 && (i < old->count || j < cur->count)) {
+        const toplite_process_t *a = i < old->count ? &old->procs[i] : NULL;
+        const toplite_process_t *b = j < cur->count ? &cur->procs[j] : NULL;
+
+        if (b && (!a || b->pid < a->pid)) {
+            ret = fn(ctx, TOPLITE_DIFF_ADDED, NULL, b);
+            j++;
+        } else if (a && (!b || a->pid < b->pid)) {
+            ret = fn(ctx, TOPLITE_DIFF_REMOVED, a, NULL);
+            i++;
+        } else if (a->start_ticks != b->start_ticks) {
+            // The PID was reused by another process
+            ret = fn(ctx, TOPLITE_DIFF_REMOVED, a, NULL);
+            if (ret == 0) {
+                ret = fn(ctx, TOPLITE_DIFF_ADDED, NULL, b);
+            }
+            i++;
+            j++;
+        } else {
+            if (process_changed(a, b)) {
+                ret = fn(ctx, TOPLITE_DIFF_CHANGED, a, b);
+            }
+            i++;
+            j++;
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,238 @@
+// src/lib/toplite.h
+#pragma once
+#include <stddef.h>
+#include <sys/types.h>
+
+/**
+ * libtoplite: the collector behind toplite as a C library.
+ *
+ * A collector takes snapshots of the system statistics and the process
+ * table. Records are read in place through the snapshot, and two snapshots
+ * can be compared process by process. Rates (%CPU, I/O, faults) are
+ * computed against the previous snapshot of the same collector, so the
+ * first snapshot reports them as 0.
+ *
+ * Compatibility: structures are only ever extended at the end. The library
+ * allocates all of them except toplite_config_t, which carries its own
+ * size, so a program built against an older header keeps working.
+ * Everything not declared here is internal.
+ */
+
+// Bumped whenever something is added to this header
+#define TOPLITE_API_VERSION 1
+
+// Marks the functions the shared library exports; everything else is hidden
+#if defined(__GNUC__)
+#define TOPLITE_EXPORT __attribute__((visibility("default")))
+#else
+#define TOPLITE_EXPORT
+#endif
+
+/**
+ * Optional per-process fields, read only when asked for because they cost
+ * one more file per process. They can be combined as a bit mask.
+ */
+#define TOPLITE_FIELD_CGROUP (1u << 0)  // cgroup (cgroup v2 path)
+#define TOPLITE_FIELD_IO (1u << 1)      // io_* rates
+#define TOPLITE_FIELD_DETAILS (1u << 2) // user name and full command line
+#define TOPLITE_FIELD_CTXSW (1u << 3)   // Context switch rates
+#define TOPLITE_FIELD_SCHED (1u << 4)   // Run queue statistics
+
+/**
+ * How a collector is set up. Start from TOPLITE_CONFIG_INIT ("whole system,
+ * no optional fields"), so size tells the library which members the
+ * program knows about.
+ */
+typedef struct {
+    size_t size;        // sizeof(toplite_config_t)
+    unsigned fields;    // TOPLITE_FIELD_* bit mask
+    const char *cgroup; // Only this cgroup v2 subtree (NULL: everything)
+} toplite_config_t;
+
+#define TOPLITE_CONFIG_INIT {sizeof(toplite_config_t), 0, NULL}
+
+/**
+ * System-wide statistics of a snapshot.
+ */
+typedef struct {
+    double timestamp;                 // Monotonic time of the snapshot (s)
+    double cpu_user;                  // User CPU time in % (since the
+                                      // previous snapshot, like %Cpu(s))
+    double cpu_system;                // System CPU time in %
+    double cpu_nice;                  // Nice CPU time in %
+    double cpu_idle;                  // Idle time in %
+    double cpu_iowait;                // I/O wait time in %
+    double cpu_irq;                   // Hardware interrupt time in %
+    double cpu_softirq;               // Software interrupt time in %
+    double cpu_steal;                 // Steal time in %
+    unsigned long long mem_total;     // Total memory in KiB
+    unsigned long long mem_free;      // Free memory in KiB
+    unsigned long long mem_available; // Available memory in KiB
+    unsigned long long mem_cached;    // buff/cache in KiB
+    unsigned long long swap_total;    // Total swap in KiB
+    unsigned long long swap_free;     // Free swap in KiB
+    double load1;                     // Load average over 1 minute
+    double load5;                     // Load average over 5 minutes
+    double load15;                    // Load average over 15 minutes
+    double uptime;                    // Seconds since boot
+    unsigned tasks_total;             // Processes (of the cgroup, if any)
+    unsigned tasks_running;           // ... running
+    unsigned tasks_sleeping;          // ... sleeping
+    unsigned tasks_stopped;           // ... stopped
+    unsigned tasks_zombie;            // ... zombies
+    long hz;                          // Clock ticks per second
+} toplite_system_t;
+
+/**
+ * One process of a snapshot. The strings belong to the snapshot.
+ */
+typedef struct {
+    pid_t pid;                       // Process ID
+    pid_t ppid;                      // Parent process ID
+    uid_t uid;                       // Effective UID
+    char state;                      // R, S, D, Z, T, ...
+    int priority;                    // Priority, or -1 for real-time
+    long nice;                       // Nice value
+    long num_threads;                // Number of threads
+    int last_cpu;                    // CPU the process last ran on
+    unsigned long long start_ticks;  // Start time in ticks after boot
+    unsigned long long cpu_ticks;    // utime + stime in ticks
+    unsigned long virt;              // Virtual memory in KiB
+    unsigned long res;               // Resident memory in KiB
+    unsigned long shr;               // Shared memory in KiB
+    double cpu_percent;              // %CPU since the previous snapshot
+    double mem_percent;              // %MEM
+    double minflt_rate;              // Minor page faults per second
+    double majflt_rate;              // Major page faults per second
+    double io_read_rate;             // Bytes read per second (IO)
+    double io_write_rate;            // Bytes written per second (IO)
+    double vcsw_rate;                // Voluntary switches/s (CTXSW)
+    double ivcsw_rate;               // Involuntary switches/s (CTXSW)
+    double sched_run_percent;        // On-CPU time in % (SCHED)
+    double sched_wait_percent;       // Run queue wait time in % (SCHED)
+    const char *user;                // User name ("" without DETAILS)
+    const char *command;             // Command line (comm without DETAILS)
+    const char *cgroup;              // cgroup path (NULL without CGROUP)
+} toplite_process_t;
+
+/**
+ * How a process differs between two snapshots.
+ */
+typedef enum {
+    TOPLITE_DIFF_ADDED,   // Only in the newer snapshot
+    TOPLITE_DIFF_REMOVED, // Only in the older snapshot (it exited)
+    TOPLITE_DIFF_CHANGED, // In both, with different state, CPU time, memory,
+                          // threads or command
+} toplite_diff_kind_t;
+
+/**
+ * Called by toplite_snapshot_diff() for every difference. 'old' is NULL for
+ * added processes and 'cur' for removed ones. A non-zero return value stops
+ * the diff.
+ */
+typedef int (*toplite_diff_fn)(void *ctx, toplite_diff_kind_t kind,
+                               const toplite_process_t *old,
+                               const toplite_process_t *cur);
+
+typedef struct toplite_collector toplite_collector_t;
+typedef struct toplite_snapshot toplite_snapshot_t;
+
+/**
+ * Cursor over the processes of a snapshot; see toplite_iter_next().
+ */
+typedef struct toplite_iter toplite_iter_t;
+
+/**
+ * @brief Creates a collector.
+ * @details The per-process state lives in the library, so only one
+ *          collector can exist at a time.
+ *
+ * @param config The setup, or NULL for the defaults.
+ * @return The collector, or NULL (errno EBUSY if another collector exists,
+ *         EINVAL if config->size is too small, ENOENT if the cgroup doesn't
+ *         exist, ENOMEM).
+ */
+TOPLITE_EXPORT toplite_collector_t *
+toplite_collector_new(const toplite_config_t *config);
+
+/**
+ * @brief Frees a collector. Its snapshots stay valid.
+ */
+TOPLITE_EXPORT void toplite_collector_free(toplite_collector_t *collector);
+
+/**
+ * @brief Takes a snapshot of the system and the process table.
+ *
+ * @param collector The collector.
+ * @return The snapshot (free it with toplite_snapshot_free()), or NULL on
+ *         failure.
+ */
+TOPLITE_EXPORT toplite_snapshot_t *
+toplite_snapshot_take(toplite_collector_t *collector);
+
+/**
+ * @brief Frees a snapshot.
+ */
+TOPLITE_EXPORT void toplite_snapshot_free(toplite_snapshot_t *snapshot);
+
+/**
+ * @brief Get the system-wide statistics of a snapshot.
+ */
+TOPLITE_EXPORT const toplite_system_t *
+toplite_snapshot_system(const toplite_snapshot_t *s);
+
+/**
+ * @brief Get the number of processes in a snapshot.
+ */
+TOPLITE_EXPORT size_t toplite_snapshot_count(const toplite_snapshot_t *s);
+
+/**
+ * @brief Get a process of a snapshot by index (processes are sorted by PID).
+ *
+ * @return The process, or NULL if the index is out of range.
+ */
+TOPLITE_EXPORT const toplite_process_t *
+toplite_snapshot_at(const toplite_snapshot_t *s, size_t index);
+
+/**
+ * @brief Finds a process of a snapshot by PID.
+ *
+ * @return The process, or NULL if the snapshot doesn't have it.
+ */
+TOPLITE_EXPORT const toplite_process_t *
+toplite_snapshot_find(const toplite_snapshot_t *s, pid_t pid);
+
+/**
+ * @brief Starts iterating over the processes of a snapshot.
+ *
+ * @return The iterator (free it with toplite_iter_free()), or NULL (errno
+ *         ENOMEM).
+ */
+TOPLITE_EXPORT toplite_iter_t *toplite_iter_new(const toplite_snapshot_t *s);
+
+/**
+ * @brief Frees an iterator.
+ */
+TOPLITE_EXPORT void toplite_iter_free(toplite_iter_t *it);
+
+/**
+ * @brief Get the next process (in PID order) without copying it.
+ *
+ * @return The process, or NULL at the end.
+ */
+TOPLITE_EXPORT const toplite_process_t *toplite_iter_next(toplite_iter_t *it);
+
+/**
+ * @brief Compares two snapshots process by process.
+ * @details A PID that was reused by a new process counts as removed and
+ *          added. Differences are reported in PID order.
+ *
+ * @param old The older snapshot.
+ * @param cur The newer snapshot.
+ * @param fn Called for every difference.
+ * @param ctx Passed to fn.
+ * @return 0 when done, or the non-zero value fn stopped with.
+ */
+TOPLITE_EXPORT int toplite_snapshot_diff(const toplite_snapshot_t *old,
+                                         const toplite_snapshot_t *cur,
+                                         toplite_diff_fn fn, void *ctx);
@@ -1,92 +1,780 @@
 // src/main.c
+#include "core/capture.h"
+#include "core/cgroup.h"
+#include "core/grouping.h"
+#include "core/history.h"
+#include "core/iostat.h"
+#include "core/numa.h"
+#include "core/proc_events.h"
 #include "core/proc_iter.h"
 #include "core/process.h"
+#include "core/psi.h"
+#include "core/refresh.h"
+#include "core/search.h"
 #include "core/sorting.h"
 #include "core/system.h"
+#include "core/tree.h"
+#include "net/agent.h"
+#include "net/client.h"
+#include "options.h"
 #include "ui/input.h"
 #include "ui/render.h"
 #include "ui/terminal.h"
+#include "ui/viewport.h"
 #include "util/util.h"
+#include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <sys/select.h>
-#include <sys/time.h>
+#include <string.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
-#define HEADER_ROW_COUNT 7
+// Rows below the header reserved for the column header and the cursor
+#define LIST_RESERVED_ROWS 2
+
+// Time a frame may spend reading smaps_rollup
+#define SMAPS_FRAME_BUDGET_SEC 0.02
+
+// Times each step of --bench-search is repeated
+#define BENCH_SEARCH_ROUNDS 100
+
+typedef enum {
+    VIEW_PROCESSES, // One row per process
+    VIEW_CGROUPS,   // One row per cgroup
+    VIEW_TREE,      // Processes as a parent/child forest
+    VIEW_IRQS,      // Interrupt sources and the CPUs they land on
+} view_mode_t;
+
+/**
+ * What the main loop should do after a key press.
+ */
+typedef enum {
+    INPUT_NONE,    // Nothing changed
+    INPUT_REDRAW,  // Draw the last snapshot again (e.g. after scrolling)
+    INPUT_REFRESH, // Collect a new snapshot right away
+} input_action_t;
+
+// View state shared between the input handler and the main loop
+static view_mode_t g_view = VIEW_PROCESSES;
+static viewport_t g_vp;           // Window and cursor of the current view
+static pid_t g_selected_pid = -1; // Process under the cursor (-1: none)
+static proc_list_t g_proc_list;   // Processes shown in the last frame
+static group_list_t g_group_list; // Groups shown in the last frame
+static proc_tree_t g_tree;        // Tree shown in the last frame
+
+// Incremental search over the user and command of the last snapshot
+static char g_search[SEARCH_MAX_LEN + 1]; // Search text ("": no search)
+static bool g_search_editing = false;     // The search text is being typed
+static search_index_t g_search_index;     // Index of the last snapshot
+static size_t g_search_matches = 0;       // Matches of g_search
+
+static bool g_show_history = false; // History panel of the selected process
+static bool g_show_vmstat = false;  // Paging and reclaim rates
+
+// Disk and network header sections; the samples are too large for the stack
+static bool g_show_disks = false; // Busiest block devices
+static bool g_show_net = false;   // Busiest network interfaces
+static disk_stats_t g_prev_disks, g_disks;
+static net_stats_t g_prev_net, g_net;
+
+// Interrupt view; its rates point into g_prev_irqs after a collection
+static irq_stats_t g_prev_irqs, g_irqs;
+static irq_view_t g_irq_view;
+
+// smaps_rollup reads (PSS/USS/SWAP) are spread over frames; what is left of
+// the current frame's budget
+static unsigned g_smaps_reads = SMAPS_DEFAULT_READS; // Reads per frame
+static size_t g_smaps_left = 0;                      // Reads left
+static double g_smaps_deadline = 0; // No reads are started after this
+
+/**
+ * @brief Switches to a view, or back to the process list if it is active.
+ */
+static void toggle_view(view_mode_t view) {
+    g_view = (g_view == view) ? VIEW_PROCESSES : view;
+    g_vp.first = 0;
+    g_vp.cursor = 0;
+    g_selected_pid = -1;
+}
 
 /**
- * @brief Checks for and handles user keyboard input in a non-blocking way.
- * @details Uses select() to poll stdin for available data. If a key is pressed,
- *          it updates the global sorting state accordingly.
+ * @brief Turns cumulative mode on or off, along with its columns, and sorts
+ *        by the total CPU time while it is on.
  */
-void handle_input(void) {
-    fd_set read_fds;
-    struct timeval timeout;
-    int ret;
+static void toggle_cumulative(void) {
+    render_toggle_columns(COLUMNS_TOTALS);
+    int on = (render_get_columns() & COLUMNS_TOTALS) != 0;
+    process_set_cumulative(on);
+    sorting_set_column(on ? SORT_BY_TOTAL_CPU : SORT_BY_CPU);
+}
 
-    FD_ZERO(&read_fds);
-    FD_SET(STDIN_FILENO, &read_fds);
+/**
+ * @brief Whether the current view has a row per process. The search, the
+ *        history panel and smaps_rollup reads only apply to those.
+ */
+static bool view_has_processes(void) {
+    return g_view == VIEW_PROCESSES || g_view == VIEW_TREE;
+}
 
-    // Set a zero-timeout.
-    timeout.tv_sec = 0;
-    timeout.tv_usec = 0;
+/**
+ * @brief Tells the collector which optional fields the current view, columns
+ *        and sort key need, so nothing else is read from /proc.
+ *
+ * @param all_rows true if every row will be shown (batch mode), so the
+ *                 details are read during the collection.
+ */
+static void update_optional_fields(bool all_rows) {
+    unsigned fields = 0;
+    sort_by_t sort = sorting_get_current_column();
 
-    // Use select to check if there is input available on stdin
-    ret = select(STDIN_FILENO + 1, &read_fds, NULL, NULL, &timeout);
-    if (ret < 0) {
-        perror("select");
-        exit(EXIT_FAILURE);
+    if (g_view == VIEW_CGROUPS) {
+        fields |= PROC_FIELD_CGROUP;
+    }
+    // Cumulative mode counts I/O even while its columns are hidden
+    if ((render_get_columns() & (COLUMNS_IO | COLUMNS_TOTALS)) ||
+        sort == SORT_BY_IO_READ || sort == SORT_BY_IO_WRITE) {
+        fields |= PROC_FIELD_IO;
+    }
+    if ((render_get_columns() & COLUMNS_EVENTS) || sort == SORT_BY_VCSW ||
+        sort == SORT_BY_IVCSW) {
+        fields |= PROC_FIELD_CTXSW;
     }
+    if ((render_get_columns() & COLUMNS_SCHED) || sort == SORT_BY_SCHED_RUN ||
+        sort == SORT_BY_SCHED_WAIT) {
+        fields |= PROC_FIELD_SCHED;
+    }
+    // Otherwise only the rows in the window get their details loaded
+    if (all_rows || g_view == VIEW_CGROUPS || sort == SORT_BY_COMMAND ||
+        g_search_editing || g_search[0] != '\0') {
+        fields |= PROC_FIELD_DETAILS;
+    }
+    process_set_optional_fields(fields);
+}
 
-    if (ret > 0 && FD_ISSET(STDIN_FILENO, &read_fds)) {
-        // Data is available, now we can read without blocking.
-        char c = '\0';
-        if (read(STDIN_FILENO, &c, 1) == 1) {
-            switch (c) {
-            case 'q':
-                // disable_raw_mode() is registered with atexit and will be
-                // called automatically on exit().
-                exit(0);
-                break;
-            case '<':
-            case ',':
-                sorting_prev_column();
-                break;
-            case '>':
-            case '.':
-                sorting_next_column();
+/**
+ * @brief Counts the rows the cursor can be on in the current view.
+ */
+static size_t selectable_rows(void) {
+    if (g_view == VIEW_CGROUPS) {
+        return g_group_list.count;
+    } else if (g_view == VIEW_TREE) {
+        return tree_visible_count(&g_tree);
+    } else if (g_view == VIEW_IRQS) {
+        return g_irq_view.count;
+    }
+    return g_proc_list.count;
+}
+
+/**
+ * @brief Finds the screen row of the cursor and the total number of rows.
+ * @details Only differs from the cursor in the cgroup view, where the members
+ *          of expanded groups take rows but can't be selected.
+ */
+static size_t cursor_screen_row(size_t *total) {
+    if (g_view != VIEW_CGROUPS) {
+        *total = selectable_rows();
+        return g_vp.cursor;
+    }
+
+    size_t row = 0;
+    *total = 0;
+    for (size_t i = 0; i < g_group_list.count; i++) {
+        if (i == g_vp.cursor) {
+            row = *total;
+        }
+        *total += 1 + (g_group_list.groups[i].expanded
+                           ? g_group_list.groups[i].nprocs
+                           : 0);
+    }
+    return row;
+}
+
+/**
+ * @brief Finds the process on a row of the process or tree view.
+ *
+ * @return Its index in g_proc_list, or -1 if there is none.
+ */
+static long process_at_row(size_t row) {
+    if (g_view == VIEW_TREE) {
+        return tree_visible_row(&g_tree, row);
+    } else if (g_view == VIEW_PROCESSES && row < g_proc_list.count) {
+        return (long)row;
+    }
+    return -1;
+}
+
+/**
+ * @brief Clamps the cursor and scrolls the window so the cursor is visible.
+ */
+static void update_viewport(unsigned rows) {
+    g_vp.rows = rows;
+    viewport_move(&g_vp, 0, selectable_rows());
+
+    size_t total;
+    size_t row = cursor_screen_row(&total);
+    viewport_show(&g_vp, row, total);
+
+    long idx = process_at_row(g_vp.cursor);
+    g_selected_pid = idx >= 0 ? g_proc_list.procs[idx].pid : -1;
+}
+
+/**
+ * @brief Moves the cursor back onto the selected process after a collection
+ *        re-sorted the list. The cursor keeps its row if the process is gone.
+ */
+static void follow_selection(void) {
+    if (g_selected_pid < 0 || g_view == VIEW_CGROUPS) {
+        return;
+    }
+
+    for (size_t i = 0; i < g_proc_list.count; i++) {
+        if (g_proc_list.procs[i].pid != g_selected_pid) {
+            continue;
+        }
+        long row = (g_view == VIEW_TREE) ? tree_node_row(&g_tree, (int)i)
+                                         : (long)i;
+        if (row >= 0) {
+            g_vp.cursor = (size_t)row;
+        }
+        return;
+    }
+}
+
+/**
+ * @brief Loads what a visible row shows but the collection skipped.
+ * @details PSS/USS/SWAP are refreshed here first, while the frame's
+ *          smaps_rollup budget lasts.
+ */
+static void load_row(proc_info_t *p) {
+    process_load_details(p);
+    if (g_smaps_left > 0 && monotonic_seconds() >= p->smaps_due &&
+        monotonic_seconds() < g_smaps_deadline) {
+        process_load_smaps(p);
+        g_smaps_left--;
+    }
+}
+
+/**
+ * @brief Loads the user name and command line of the processes in the window.
+ */
+static void load_visible_details(void) {
+    if (g_view == VIEW_TREE) {
+        tree_iter_t it;
+        tree_iter_begin(&g_tree, &it);
+        for (size_t row = 0; row < g_vp.first + g_vp.rows && it.node >= 0;
+             row++) {
+            if (row >= g_vp.first) {
+                load_row(&g_proc_list.procs[it.node]);
+            }
+            tree_iter_next(&g_tree, &it);
+        }
+    } else if (g_view == VIEW_PROCESSES) {
+        for (size_t i = g_vp.first;
+             i < g_proc_list.count && i - g_vp.first < g_vp.rows; i++) {
+            load_row(&g_proc_list.procs[i]);
+        }
+    }
+}
+
+/**
+ * @brief Marks the processes that match the search text.
+ *
+ * @param rebuild true after a new collection, to index the new snapshot.
+ */
+static void update_search(bool rebuild) {
+    g_search_matches = 0;
+    if ((!g_search_editing && g_search[0] == '\0') || !view_has_processes()) {
+        render_set_matches(NULL);
+        return;
+    }
+    if (rebuild && build_search_index(&g_proc_list, &g_search_index) != 0) {
+        render_set_matches(NULL);
+        return;
+    }
+    g_search_matches = search_index_match(&g_search_index, g_search);
+    render_set_matches(g_search_index.matches);
+}
+
+/**
+ * @brief Moves the cursor to the next (or previous) matching row, wrapping
+ *        around at the end of the list.
+ *
+ * @param dir 1 to search down, -1 to search up.
+ * @param include_current true if the row under the cursor may be the match.
+ */
+static void jump_to_match(int dir, bool include_current) {
+    if (g_search_matches == 0 || !view_has_processes()) {
+        return;
+    }
+
+    // One pass over the rows in display order
+    long first = -1, last = -1, before = -1, after = -1;
+    size_t cursor = g_vp.cursor;
+    tree_iter_t it;
+    tree_iter_begin(&g_tree, &it);
+    for (size_t row = 0;; row++) {
+        long idx;
+        if (g_view == VIEW_TREE) {
+            idx = it.node;
+            if (idx < 0) {
                 break;
-            case 'R':
-                sorting_flip_direction();
+            }
+            tree_iter_next(&g_tree, &it);
+        } else if (row < g_proc_list.count) {
+            idx = (long)row;
+        } else {
+            break;
+        }
+        if (!g_search_index.matches[idx]) {
+            continue;
+        }
+
+        if (first < 0) {
+            first = (long)row;
+        }
+        last = (long)row;
+        if (row < cursor) {
+            before = (long)row;
+        } else if (after < 0 && (row > cursor || include_current)) {
+            after = (long)row;
+        }
+    }
+
+    long target;
+    if (dir > 0) {
+        target = after >= 0 ? after : first;
+    } else {
+        target = before >= 0 ? before : last;
+    }
+    if (target >= 0) {
+        g_vp.cursor = (size_t)target;
+        long idx = process_at_row(g_vp.cursor);
+        g_selected_pid = idx >= 0 ? g_proc_list.procs[idx].pid : -1;
+    }
+}
+
+/**
+ * @brief Handles a key while the search text is being typed.
+ */
+static input_action_t handle_search_key(int key) {
+    size_t len = strlen(g_search);
+
+    if (key == '\n') {
+        g_search_editing = false;
+    } else if (key == '\033') {
+        g_search[0] = '\0'; // Cancel the search
+        g_search_editing = false;
+    } else if (key == 127 || key == '\b') {
+        if (len > 0) {
+            g_search[len - 1] = '\0';
+        }
+    } else if (key >= ' ' && key <= '~' && len < SEARCH_MAX_LEN) {
+        g_search[len] = (char)key;
+        g_search[len + 1] = '\0';
+    } else {
+        return INPUT_NONE;
+    }
+
+    update_search(false);
+    jump_to_match(1, true);
+    return INPUT_REDRAW;
+}
+
+/**
+ * @brief Expands/collapses the group or subtree under the cursor.
+ */
+static void toggle_selected(void) {
+    if (g_view == VIEW_CGROUPS && g_vp.cursor < g_group_list.count) {
+        grouping_toggle_expanded(g_group_list.groups[g_vp.cursor].cgroup);
+    } else if (g_view == VIEW_TREE) {
+        int node = tree_visible_row(&g_tree, g_vp.cursor);
+        if (node >= 0) {
+            tree_toggle_collapsed(g_proc_list.procs[node].pid);
+        }
+    }
+}
+
+/**
+ * @brief Moves the cursor and remembers the process it lands on.
+ */
+static input_action_t move_cursor(long delta) {
+    viewport_move(&g_vp, delta, selectable_rows());
+    long idx = process_at_row(g_vp.cursor);
+    g_selected_pid = idx >= 0 ? g_proc_list.procs[idx].pid : -1;
+    return INPUT_REDRAW;
+}
+
+/**
+ * @brief Handles a pending key press.
+ * @details Navigation only redraws the last snapshot; anything that changes
+ *          what is collected or how it is sorted asks for a new collection.
+ *
+ * @return What the main loop should do next.
+ */
+static input_action_t handle_input(void) {
+    long page = g_vp.rows > 1 ? (long)g_vp.rows - 1 : 1;
+
+    int key = read_key();
+    if (g_search_editing) {
+        return handle_search_key(key);
+    }
+
+    switch (key) {
+    case 'q':
+        // disable_raw_mode() is registered with atexit and will be
+        // called automatically on exit().
+        exit(0);
+        break;
+    case '<':
+    case ',':
+        sorting_prev_column();
+        return INPUT_REFRESH;
+    case '>':
+    case '.':
+        sorting_next_column();
+        return INPUT_REFRESH;
+    case 'R':
+        sorting_flip_direction();
+        return INPUT_REFRESH;
+    case 'g':
+        toggle_view(VIEW_CGROUPS);
+        return INPUT_REFRESH;
+    case 't':
+        toggle_view(VIEW_TREE);
+        return INPUT_REFRESH;
+    case 'I':
+        toggle_view(VIEW_IRQS);
+        return INPUT_REFRESH;
+    case 'i':
+        render_toggle_columns(COLUMNS_IO);
+        return INPUT_REFRESH;
+    case 's':
+        render_toggle_columns(COLUMNS_HISTORY);
+        return INPUT_REDRAW;
+    case 'm':
+        render_toggle_columns(COLUMNS_SMAPS);
+        return INPUT_REDRAW;
+    case 'f':
+        render_toggle_columns(COLUMNS_EVENTS);
+        return INPUT_REFRESH;
+    case 'w':
+        render_toggle_columns(COLUMNS_SCHED);
+        return INPUT_REFRESH;
+    case 'c':
+        render_toggle_columns(COLUMNS_NUMA);
+        return INPUT_REDRAW;
+    case 'a':
+        toggle_cumulative();
+        return INPUT_REFRESH;
+    case 'b':
+        // New baseline: the totals start again from zero
+        process_reset_totals();
+        return INPUT_REFRESH;
+    case 'd':
+        g_show_history = !g_show_history;
+        return INPUT_REDRAW;
+    case 'D':
+        g_show_disks = !g_show_disks;
+        return INPUT_REFRESH;
+    case 'T':
+        g_show_net = !g_show_net;
+        return INPUT_REFRESH;
+    case 'v':
+        g_show_vmstat = !g_show_vmstat;
+        return INPUT_REFRESH;
+    case 'j':
+    case KEY_ARROW_DOWN:
+        return move_cursor(1);
+    case 'k':
+    case KEY_ARROW_UP:
+        return move_cursor(-1);
+    case KEY_PAGE_DOWN:
+        return move_cursor(page);
+    case KEY_PAGE_UP:
+        return move_cursor(-page);
+    case KEY_HOME:
+        return move_cursor(LONG_MIN / 2);
+    case KEY_END:
+        return move_cursor(LONG_MAX / 2);
+    case 'e':
+    case '\n':
+        toggle_selected();
+        return INPUT_REFRESH;
+    case '/':
+        // The new search needs the full command lines of every process
+        g_search[0] = '\0';
+        g_search_editing = true;
+        return INPUT_REFRESH;
+    case 'n':
+        jump_to_match(1, false);
+        return INPUT_REDRAW;
+    case 'N':
+        jump_to_match(-1, false);
+        return INPUT_REDRAW;
+    }
+    return INPUT_NONE;
+}
+
+/**
+ * @brief Draws a frame from the last snapshot.
+ *
+ * @param header The header data of the snapshot; the search fields are
+ *               filled in here.
+ * @param hz The system clock frequency in Hertz.
+ * @param batch true to print every row instead of a window of the screen.
+ */
+static void render_frame(header_data_t *header, long hz, bool batch) {
+    terminal_t term;
+    get_term_size(&term);
+
+    bool searching = g_search_editing || g_search[0] != '\0';
+    header->search = (searching && view_has_processes()) ? g_search : NULL;
+    header->search_matches = g_search_matches;
+    header->search_editing = g_search_editing;
+
+    if (!batch) {
+        printf("\033[H\033[J"); // Clear screen
+    }
+    unsigned header_rows = render_header(header) + LIST_RESERVED_ROWS;
+
+    // The panel describes the process selected in the previous frame
+    if (g_show_history && !batch && view_has_processes()) {
+        for (size_t i = 0; i < g_proc_list.count; i++) {
+            if (g_proc_list.procs[i].pid == g_selected_pid) {
+                process_load_details(&g_proc_list.procs[i]);
+                header_rows += render_history_panel(&g_proc_list.procs[i]);
                 break;
             }
         }
     }
 
-    // If ret is 0, it means timeout was reached (no input), so we do nothing.
+    // Visible rows get the smaps_rollup budget first, the rest goes
+    // round-robin through the others
+    bool smaps = (render_get_columns() & COLUMNS_SMAPS) ||
+                 sorting_get_current_column() == SORT_BY_PSS;
+    g_smaps_left = (smaps && view_has_processes()) ? g_smaps_reads : 0;
+    g_smaps_deadline = monotonic_seconds() + SMAPS_FRAME_BUDGET_SEC;
+
+    if (batch) {
+        // Batch output is not paged and has no cursor
+        g_vp = (viewport_t){.first = 0, .cursor = SIZE_MAX, .rows = UINT_MAX};
+    } else {
+        update_viewport(term.rows > header_rows ? term.rows - header_rows
+                                                : 0);
+        load_visible_details();
+    }
+    if (g_smaps_left > 0) {
+        process_refresh_smaps(&g_proc_list, g_smaps_left, g_smaps_deadline);
+    }
+
+    if (g_view == VIEW_CGROUPS) {
+        render_group_list(&g_group_list, &g_proc_list, hz, &g_vp, term.cols);
+    } else if (g_view == VIEW_TREE) {
+        render_tree_list(&g_tree, &g_proc_list, hz, &g_vp, term.cols);
+    } else if (g_view == VIEW_IRQS) {
+        render_irq_list(&g_irq_view, &g_vp, term.cols);
+    } else {
+        render_process_list(&g_proc_list, hz, &g_vp, term.cols);
+    }
+    fflush(stdout);
+}
+
+/**
+ * Returns the CPU time (user + system) used so far, in seconds. io_uring
+ * workers are threads of this process and are included.
+ */
+static double cpu_seconds(void) {
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) {
+        return 0.0;
+    }
+    return (double)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+           (double)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+/**
+ * Times 'runs' collections of all processes with every collector and prints
+ * the average wall clock and CPU time per collection.
+ *
+ * @return 0 on success, 1 on failure.
+ */
+static int bench_collectors(unsigned runs, unsigned fields) {
+    static const proc_collector_t collectors[] = {PROC_COLLECTOR_SYNC,
+                                                  PROC_COLLECTOR_URING};
+    mem_info_t mem;
+    if (read_meminfo(&mem) != 0) {
+        return 1;
+    }
+    process_set_optional_fields(fields);
+
+    printf("%-10s %9s %12s %12s\n", "COLLECTOR", "PROCS", "WALL ms/run",
+           "CPU ms/run");
+    for (size_t c = 0; c < sizeof(collectors) / sizeof(collectors[0]); c++) {
+        if (process_set_collector(collectors[c]) != 0) {
+            printf("%-10s %9s\n", "io_uring", "n/a");
+            continue;
+        }
+
+        // The first collection creates the per-process state
+        int ret = collect_all_processes(&g_proc_list, mem.mem_total);
+        double wall = monotonic_seconds(), cpu = cpu_seconds();
+        for (unsigned i = 0; i < runs && ret == 0; i++) {
+            ret = collect_all_processes(&g_proc_list, mem.mem_total);
+        }
+        if (ret != 0) {
+            free_process_list(&g_proc_list);
+            return 1;
+        }
+        wall = monotonic_seconds() - wall;
+        cpu = cpu_seconds() - cpu;
+
+        // The name tells if io_uring fell back to synchronous reads
+        printf("%-10s %9zu %12.3f %12.3f\n", process_collector_name(),
+               g_proc_list.count, wall * 1000.0 / runs, cpu * 1000.0 / runs);
+    }
+    free_process_list(&g_proc_list);
+    process_set_collector(PROC_COLLECTOR_SYNC);
+    return 0;
+}
+
+/**
+ * Builds the search index of a synthetic list of 'procs' processes, then
+ * types a search text one key at a time, and prints the average time of
+ * each step.
+ *
+ * @return 0 on success, 1 on failure.
+ */
+static int bench_search(unsigned procs) {
+    static const char *const users[] = {"root", "postgres", "www-data",
+                                        "alice"};
+    static const char typed[] = "worker-12";
+
+    proc_list_t list = {calloc(procs, sizeof(proc_info_t)), procs, procs};
+    if (!list.procs) {
+        perror("Failed to allocate memory for the process list");
+        return 1;
+    }
+    for (unsigned i = 0; i < procs; i++) {
+        proc_info_t *p = &list.procs[i];
+        p->pid = (pid_t)(i + 1);
+        snprintf(p->user, sizeof(p->user), "%s", users[i % 4]);
+        snprintf(p->command, sizeof(p->command),
+                 "/usr/lib/app/Worker-%u --queue=%u --log-level=info", i,
+                 i % 97);
+    }
+
+    search_index_t idx;
+    init_search_index(&idx);
+    int ret = 0;
+    double wall = monotonic_seconds();
+    for (unsigned r = 0; r < BENCH_SEARCH_ROUNDS && ret == 0; r++) {
+        ret = build_search_index(&list, &idx);
+    }
+    if (ret != 0) {
+        free_search_index(&idx);
+        free(list.procs);
+        return 1;
+    }
+    wall = monotonic_seconds() - wall;
+
+    printf("%-12s %9s %9s %12s\n", "STEP", "PROCS", "MATCHES", "us/run");
+    printf("%-12s %9u %9s %12.3f\n", "build", procs, "-",
+           wall * 1e6 / BENCH_SEARCH_ROUNDS);
+
+    // Every key typed searches the whole index again
+    char needle[sizeof(typed)];
+    for (size_t len = 1; len < sizeof(typed); len++) {
+        memcpy(needle, typed, len);
+        needle[len] = '\0';
+        size_t matches = 0;
+        wall = monotonic_seconds();
+        for (unsigned r = 0; r < BENCH_SEARCH_ROUNDS; r++) {
+            matches = search_index_match(&idx, needle);
+        }
+        wall = monotonic_seconds() - wall;
+        printf("%-12s %9u %9zu %12.3f\n", needle, procs, matches,
+               wall * 1e6 / BENCH_SEARCH_ROUNDS);
+    }
+
+    free_search_index(&idx);
+    free(list.procs);
+    return 0;
 }
 
 int main(int argc, char **argv) {
-    unsigned interval_ms = 2000; // 2 sec
-
-    // If a user wants to specify a different interval, they can do so
-    if (argc == 2) {
-        char *endptr;
-        long val = strtol(argv[1], &endptr, 10);
-        // Check for conversion errors and non-numeric input
-        if (endptr == argv[1] || *endptr != '\0' || val <= 0) {
-            fprintf(stderr, "Usage: %s [interval_ms]\n", argv[0]);
+    options_t opts;
+    if (parse_options(argc, argv, &opts) != 0) {
+        return 1;
+    }
+
+    if (opts.bench_collect > 0) {
+        return bench_collectors(opts.bench_collect,
+                                opts.io_columns ? PROC_FIELD_IO : 0);
+    }
+    if (opts.bench_search > 0) {
+        return bench_search(opts.bench_search);
+    }
+    if (process_set_collector(opts.collector) != 0 && opts.collector_set) {
+        fprintf(stderr, "io_uring is not available, reading /proc "
+                        "synchronously.\n");
+    }
+
+    // Remote modes: collect for others, or show what others collected
+    if (opts.serve_addr) {
+        unsigned fields = opts.io_columns ? PROC_FIELD_IO : 0;
+        return agent_run(opts.serve_addr, opts.interval_ms, fields);
+    }
+    if (opts.connect_count > 0) {
+        return client_run(opts.connect_addrs, opts.connect_count,
+                          opts.interval_ms, opts.batch, opts.iterations);
+    }
+    if (opts.trigger_count > 0) {
+        rule_set_t rules = {0};
+        for (size_t i = 0; i < opts.trigger_count; i++) {
+            if (rules_compile(opts.triggers[i], &rules) != 0) {
+                return 1;
+            }
+        }
+        capture_config_t cfg = {
+            .dir = opts.trigger_dir,
+            .keep = opts.trigger_keep,
+            .cooldown_sec = opts.trigger_cooldown,
+            .interval_ms = opts.interval_ms,
+            .iterations = opts.iterations,
+        };
+        return capture_run(&rules, &cfg);
+    }
+
+    // Scope everything to a cgroup if requested
+    char cgroup_dir[PATH_MAX] = {0};
+    if (opts.cgroup_path &&
+        cgroup_resolve_path(opts.cgroup_path, cgroup_dir,
+                            sizeof(cgroup_dir)) != 0) {
+        fprintf(stderr, "%s: not a cgroup v2 directory.\n", opts.cgroup_path);
+        return 1;
+    }
+
+    // Arm the PSI triggers before anything else so a bad spec fails early
+    psi_trigger_t triggers[PSI_MAX_TRIGGERS];
+    size_t ntriggers = 0;
+    for (size_t i = 0; i < opts.psi_trigger_count; i++) {
+        if (psi_trigger_open(opts.psi_triggers[i],
+                             opts.cgroup_path ? cgroup_dir : NULL,
+                             &triggers[ntriggers]) != 0) {
             return 1;
         }
-        interval_ms = (unsigned)val;
-    } else if (argc > 2) {
-        fprintf(stderr, "Usage: %s [interval_ms]\n", argv[0]);
+        ntriggers++;
+    }
+
+    if (opts.sched_idle && refresh_set_idle() != 0) {
         return 1;
     }
 
-    enable_raw_mode(); // Ready to handle input to change sorting
+    if (!opts.batch) {
+        enable_raw_mode(); // Ready to handle input to change sorting
+    }
 
     cpu_times_t prev_cpu_times = {0}, now_cpu_times = {0};
     mem_info_t mem;
@@ -94,26 +782,111 @@ int main(int argc, char **argv) {
     uptime_fmt_t up;
     cpu_percent_t cpu;
     task_counts_t tc;
-    terminal_t term;
 
-    proc_list_t proc_list;
-    init_process_list(&proc_list);
+    init_process_list(&g_proc_list);
     long hz = sys_hz();
 
+    init_group_list(&g_group_list);
+    init_process_tree(&g_tree);
+    init_search_index(&g_search_index);
+    if (history_init(opts.history_samples, opts.history_pids) != 0) {
+        return 1;
+    }
+    if (opts.group_by_cgroup) {
+        toggle_view(VIEW_CGROUPS);
+    }
+    if (opts.irqs) {
+        toggle_view(VIEW_IRQS);
+    }
+    if (opts.io_columns) {
+        render_toggle_columns(COLUMNS_IO);
+    }
+    if (opts.event_columns) {
+        render_toggle_columns(COLUMNS_EVENTS);
+    }
+    if (opts.sched_columns) {
+        render_toggle_columns(COLUMNS_SCHED);
+    }
+    if (opts.numa_columns) {
+        render_toggle_columns(COLUMNS_NUMA);
+    }
+    if (opts.smaps_columns) {
+        render_toggle_columns(COLUMNS_SMAPS);
+    }
+    g_smaps_reads = opts.smaps_reads;
+    if (opts.sample_period > 0) {
+        if (process_set_sampling(opts.sample_period, opts.sample_top) != 0) {
+            return 1;
+        }
+        render_toggle_columns(COLUMNS_STALE);
+    }
+    if (opts.cumulative) {
+        toggle_cumulative();
+    }
+    // '<' and '>' only step through the columns on screen
+    sorting_set_column_filter(render_sort_column_shown);
+    g_show_disks = opts.disks;
+    g_show_net = opts.net;
+    g_show_vmstat = opts.vmstat;
+
+    pid_list_t cgroup_pids;
+    init_pid_list(&cgroup_pids);
+    cgroup_view_t cgroup_view = {.path = cgroup_dir};
+    cgroup_stats_t prev_cgroup_stats = {0};
+    long ncpu = sys_ncpu();
+
+    psi_stats_t prev_psi = {0}, psi = {0};
+    psi_percent_t psi_now = {0};
+    int fired = -1; // Trigger that woke us up, if any
+
+    // Nothing is read on single-node machines
+    numa_stats_t prev_numa, numa;
+    numa_view_t numa_view;
+    int have_numa = read_numa_stats(&prev_numa);
+
+    // Without events (or until they are lost), /proc is scanned every frame
+    proc_events_t events = {0};
+    bool have_events = false;
+    double next_rescan = 0;
+    if (opts.proc_events) {
+        have_events = proc_events_open() == 0;
+        if (!have_events) {
+            fprintf(stderr, "The proc connector is not available (kernels "
+                            "before 6.6 require CAP_NET_ADMIN), scanning "
+                            "/proc instead.\n");
+        }
+    }
+
+    // Sampled only while shown; a section shows zero rates for the first
+    // frame after it is turned on
+    disk_view_t disk_view;
+    net_view_t net_view;
+    vmstat_t prev_vmstat, vmstat;
+    vmstat_rate_t vmstat_view;
+    bool had_disks = false, had_net = false, had_vmstat = false;
+    bool had_irqs = false;
+
+    refresh_t refresh;
+    refresh_init(&refresh, opts.interval_ms, opts.min_interval_ms,
+                 opts.max_interval_ms, opts.cpu_budget);
+
     // Prime CPU times
     if (read_cpu_times(&prev_cpu_times) != 0) {
         fprintf(stderr, "Error reading initial CPU times(/proc/stat).\n");
         return 1;
     }
+    if (opts.cgroup_path) {
+        read_cgroup_stats(cgroup_dir, &prev_cgroup_stats);
+    }
+    read_psi(opts.cgroup_path ? cgroup_dir : NULL, &prev_psi);
 
-    while (true) {
-        handle_input(); // Check for user input on each frame
+    int status = 0;
+    for (unsigned frame = 0; !opts.iterations || frame < opts.iterations;
+         frame++) {
+        refresh_frame_begin(&refresh);
 
-        // Ger the current terminal size
-        get_term_size(&term);
-        unsigned int available_rows =
-            (term.rows > HEADER_ROW_COUNT) ? term.rows - HEADER_ROW_COUNT : 0;
         // Collect data
+        update_optional_fields(opts.batch);
         read_cpu_times(&now_cpu_times);
         cpu_percent(&prev_cpu_times, &now_cpu_times, &cpu);
         prev_cpu_times = now_cpu_times;
@@ -126,24 +899,215 @@ int main(int argc, char **argv) {
         fmt_uptime(uptimeSeconds, &up);
 
         int users = count_logged_in_users();
-        scan_task_states(&tc);
 
-        collect_all_processes(&proc_list, mem.mem_total);
+        int have_psi = read_psi(opts.cgroup_path ? cgroup_dir : NULL, &psi);
+        if (have_psi == 0) {
+            psi_percent(&prev_psi, &psi, &psi_now);
+            prev_psi = psi;
+        }
+
+        if (have_numa == 0 && read_numa_stats(&numa) == 0) {
+            numa_cpu_percent(&prev_numa, &numa, &numa_view);
+            prev_numa = numa;
+        }
+
+        bool have_disks =
+            g_show_disks && read_disk_stats(&g_disks, opts.all_devices) == 0;
+        if (have_disks) {
+            disk_rates(had_disks ? &g_prev_disks : &g_disks, &g_disks,
+                       opts.top_devices, &disk_view);
+            g_prev_disks = g_disks;
+        }
+        had_disks = have_disks;
+
+        bool have_net =
+            g_show_net && read_net_stats(&g_net, opts.all_devices) == 0;
+        if (have_net) {
+            net_rates(had_net ? &g_prev_net : &g_net, &g_net,
+                      opts.top_devices, &net_view);
+            g_prev_net = g_net;
+        }
+        had_net = have_net;
+
+        bool have_vmstat = g_show_vmstat && read_vmstat(&vmstat) == 0;
+        if (have_vmstat) {
+            vmstat_rates(had_vmstat ? &prev_vmstat : &vmstat, &vmstat,
+                         &vmstat_view);
+            prev_vmstat = vmstat;
+        }
+        had_vmstat = have_vmstat;
+
+        bool have_irqs = g_view == VIEW_IRQS && read_irq_stats(&g_irqs) == 0 &&
+                         irq_rates(had_irqs ? &g_prev_irqs : &g_irqs, &g_irqs,
+                                   &g_irq_view) == 0;
+        if (have_irqs) {
+            // The next sample is read into the older arrays
+            irq_stats_t older = g_prev_irqs;
+            g_prev_irqs = g_irqs;
+            g_irqs = older;
+        } else {
+            g_irq_view.count = 0;
+        }
+        had_irqs = have_irqs;
+
+        // The interrupt view only shows the task counts of the processes.
+        // Cumulative mode keeps collecting, so no exited process is missed.
+        bool skip_procs = g_view == VIEW_IRQS &&
+                          !(render_get_columns() & COLUMNS_TOTALS);
+        int collected = 0;
+        if (opts.cgroup_path) {
+            // Source PIDs from cgroup.procs instead of walking /proc
+            if (cgroup_collect_pids(cgroup_dir, &cgroup_pids) != 0) {
+                fprintf(stderr, "Failed to read cgroup.procs.\n");
+                status = 1;
+                break;
+            }
+            scan_task_states_pids(cgroup_pids.pids, cgroup_pids.count, &tc);
+            if (!skip_procs) {
+                collected = collect_processes(&g_proc_list, cgroup_pids.pids,
+                                              cgroup_pids.count, mem.mem_total);
+            }
+
+            read_cgroup_stats(cgroup_dir, &cgroup_view.stats);
+            cgroup_cpu_percent(&prev_cgroup_stats, &cgroup_view.stats, ncpu,
+                               &cgroup_view.cpu);
+            prev_cgroup_stats = cgroup_view.stats;
+            cgroup_view.nprocs = cgroup_pids.count;
+        } else if (have_events) {
+            // The events keep the PID set, so only the known processes are
+            // read; a periodic full scan catches anything they missed
+            bool exact = proc_events_read(&events) == 0;
+            double now = monotonic_seconds();
+            size_t npids = 0;
+            const pid_t *pids = NULL;
+            if (exact && now < next_rescan) {
+                pids = proc_events_pids(&npids);
+            }
+            if (pids) {
+                scan_task_states_pids(pids, npids, &tc);
+                if (!skip_procs) {
+                    collected = collect_processes(&g_proc_list, pids, npids,
+                                                  mem.mem_total);
+                }
+            } else if (skip_procs) {
+                scan_task_states(&tc);
+            } else {
+                scan_task_states(&tc);
+                collected = collect_all_processes(&g_proc_list, mem.mem_total);
+                proc_events_reconcile(&g_proc_list);
+                next_rescan = now + PROC_EVENTS_RECONCILE_SEC;
+            }
+        } else {
+            scan_task_states(&tc);
+            if (!skip_procs) {
+                collected = collect_all_processes(&g_proc_list, mem.mem_total);
+            }
+        }
+        if (collected != 0) {
+            fprintf(stderr, "Failed to collect the process list.\n");
+            status = 1;
+            break;
+        }
+
+        proc_sampling_t sampling;
+        int have_sampling = process_get_sampling(&sampling);
+        proc_cumulative_t totals;
+        int have_totals = process_get_cumulative(&totals);
 
         // --- Sort the process list ---
-        qsort(proc_list.procs, proc_list.count, sizeof(proc_info_t),
+        qsort(g_proc_list.procs, g_proc_list.count, sizeof(proc_info_t),
               compare_procs);
 
+        if (g_view == VIEW_CGROUPS) {
+            if (group_processes_by_cgroup(&g_proc_list, &g_group_list) != 0) {
+                status = 1;
+                break;
+            }
+            qsort(g_group_list.groups, g_group_list.count,
+                  sizeof(cgroup_group_t), compare_groups);
+        } else if (g_view == VIEW_TREE) {
+            if (build_process_tree(&g_proc_list, &g_tree) != 0) {
+                status = 1;
+                break;
+            }
+        }
+        update_search(true);
+        follow_selection();
+
         // --- Render Output ---
-        printf("\033[H\033[J"); // Clear screen
-        render_header(&cpu, &mem, &ld, &up, users, &tc);
-        render_process_list(&proc_list, hz, available_rows, term.cols);
-        fflush(stdout);
+        if (opts.batch) {
+            if (frame > 0) {
+                printf("\n");
+            }
+            if (fired >= 0) {
+                printf("*** PSI trigger fired: %s\n", triggers[fired].spec);
+            }
+        }
+        header_data_t header = {
+            .cpu = &cpu,
+            .mem = &mem,
+            .ld = &ld,
+            .up = &up,
+            .users = users,
+            .tc = &tc,
+            .cg = opts.cgroup_path ? &cgroup_view : NULL,
+            .psi = have_psi == 0 ? &psi : NULL,
+            .psi_now = &psi_now,
+            .vm = have_vmstat ? &vmstat_view : NULL,
+            .numa = have_numa == 0 ? &numa_view : NULL,
+            .events = have_events ? &events : NULL,
+            .disks = have_disks ? &disk_view : NULL,
+            .net = have_net ? &net_view : NULL,
+            .irqs = have_irqs ? &g_irq_view : NULL,
+            .refresh = opts.cpu_budget > 0 ? &refresh : NULL,
+            .sample = have_sampling == 0 ? &sampling : NULL,
+            .totals = have_totals == 0 ? &totals : NULL,
+        };
+        render_frame(&header, hz, opts.batch);
+        unsigned interval_ms = refresh_frame_end(&refresh);
 
-        usleep(interval_ms * 1000);
+        if (opts.iterations && frame + 1 == opts.iterations) {
+            break;
+        }
+        if (ntriggers > 0) {
+            // Wake up early, and take a snapshot right away, under pressure
+            fired = psi_wait(triggers, ntriggers, interval_ms);
+        } else if (opts.batch) {
+            usleep(interval_ms * 1000);
+        } else {
+            // Keys are handled while waiting; scrolling redraws at once
+            double deadline = monotonic_seconds() + interval_ms / 1000.0;
+            while (true) {
+                double left = deadline - monotonic_seconds();
+                if (left <= 0 || !wait_for_input((unsigned)(left * 1000))) {
+                    break;
+                }
+                input_action_t action = handle_input();
+                if (action == INPUT_REFRESH) {
+                    break;
+                }
+                if (action == INPUT_REDRAW) {
+                    render_frame(&header, hz, false);
+                }
+            }
+        }
     }
 
     // cleanup
-    free_process_list(&proc_list);
-    return 0;
+    for (size_t i = 0; i < ntriggers; i++) {
+        psi_trigger_close(&triggers[i]);
+    }
+    free_search_index(&g_search_index);
+    free_process_tree(&g_tree);
+    free_group_list(&g_group_list);
+    free_pid_list(&cgroup_pids);
+    free_process_list(&g_proc_list);
+    free_irq_view(&g_irq_view);
+    free_irq_stats(&g_prev_irqs);
+    free_irq_stats(&g_irqs);
+    if (have_events) {
+        proc_events_close();
+    }
+    history_free();
+    return status;
 }
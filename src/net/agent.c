@@ -0,0 +1,193 @@
+// src/net/agent.c
+#include "agent.h"
+#include "../core/proc_iter.h"
+#include "../util/util.h"
+#include "socket.h"
+#include "wire.h"
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// A client gets this long to send a request or take a reply
+#define AGENT_IO_TIMEOUT_MS 1000
+
+/**
+ * A connected client and the last snapshot sent to it.
+ */
+typedef struct {
+    int fd;          // Socket (-1: free slot)
+    snapshot_t sent; // Last snapshot sent (the base of the next delta)
+    bool has_sent;   // 'sent' is valid
+} agent_client_t;
+
+static int compare_pid(const void *a, const void *b) {
+    pid_t pa = ((const proc_info_t *)a)->pid;
+    pid_t pb = ((const proc_info_t *)b)->pid;
+    return (pa > pb) - (pa < pb);
+}
+
+/**
+ * Collects a new snapshot of the host.
+ *
+ * @return 0 on success, -1 if the process list could not be collected.
+ */
+static int collect_snapshot(snapshot_t *snap, cpu_times_t *prev_cpu) {
+    cpu_times_t now_cpu;
+    read_cpu_times(&now_cpu);
+    cpu_percent(prev_cpu, &now_cpu, &snap->cpu);
+    *prev_cpu = now_cpu;
+
+    read_meminfo(&snap->mem);
+    read_loadavg(&snap->ld);
+    double uptime;
+    read_uptime(&uptime);
+    fmt_uptime(uptime, &snap->up);
+    snap->users = count_logged_in_users();
+    snap->hz = sys_hz();
+    gethostname(snap->hostname, sizeof(snap->hostname) - 1);
+
+    scan_task_states(&snap->tc);
+    if (collect_all_processes(&snap->procs, snap->mem.mem_total) != 0) {
+        return -1;
+    }
+    // Deltas are computed by merging PID-sorted lists
+    qsort(snap->procs.procs, snap->procs.count, sizeof(proc_info_t),
+          compare_pid);
+    snap->seq++;
+    return 0;
+}
+
+static void drop_client(agent_client_t *c) {
+    close(c->fd);
+    c->fd = -1;
+    c->has_sent = false;
+}
+
+/**
+ * Answers one request of a client.
+ *
+ * @return 0 on success, -1 if the client should be dropped.
+ */
+static int serve_client(agent_client_t *c, const snapshot_t *cur,
+                        wire_buf_t *in, wire_buf_t *out) {
+    wire_msg_t type;
+    if (wire_recv(c->fd, &type, in) != 0 || type != MSG_REQUEST ||
+        in->len < 8) {
+        return -1;
+    }
+    uint64_t ack = 0;
+    for (int i = 0; i < 8; i++) {
+        ack |= (uint64_t)in->data[i] << (8 * i);
+    }
+
+    // Without a matching base (new client, missed reply), send everything
+    const snapshot_t *base =
+        (c->has_sent && ack != 0 && c->sent.seq == ack) ? &c->sent : NULL;
+    out->len = 0;
+    if (encode_snapshot(cur, base, out) != 0 ||
+        wire_send(c->fd, MSG_SNAPSHOT, out->data, out->len) != 0) {
+        return -1;
+    }
+    if (copy_snapshot(&c->sent, cur) != 0) {
+        return -1;
+    }
+    c->has_sent = true;
+    return 0;
+}
+
+int agent_run(const char *addr, unsigned interval_ms, unsigned fields) {
+    int listen_fd = net_listen(addr);
+    if (listen_fd < 0) {
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN); // A vanished client is handled by write()
+
+    // Clients display every process, so read the details up front
+    process_set_optional_fields(fields | PROC_FIELD_DETAILS);
+
+    agent_client_t clients[AGENT_MAX_CLIENTS];
+    for (int i = 0; i < AGENT_MAX_CLIENTS; i++) {
+        clients[i].fd = -1;
+        clients[i].has_sent = false;
+        init_snapshot(&clients[i].sent);
+    }
+    snapshot_t cur;
+    init_snapshot(&cur);
+    wire_buf_t in = {0}, out = {0};
+
+    cpu_times_t prev_cpu;
+    read_cpu_times(&prev_cpu);
+    int collected = collect_snapshot(&cur, &prev_cpu);
+    double next = monotonic_seconds() + interval_ms / 1000.0;
+
+    while (collected == 0) {
+        double left = next - monotonic_seconds();
+        if (left <= 0) {
+            collected = collect_snapshot(&cur, &prev_cpu);
+            next += interval_ms / 1000.0;
+            if (next < monotonic_seconds()) {
+                next = monotonic_seconds() + interval_ms / 1000.0;
+            }
+            continue;
+        }
+
+        struct pollfd fds[AGENT_MAX_CLIENTS + 1];
+        fds[0].fd = listen_fd;
+        fds[0].events = POLLIN;
+        for (int i = 0; i < AGENT_MAX_CLIENTS; i++) {
+            fds[i + 1].fd = clients[i].fd; // Negative fds are ignored
+            fds[i + 1].events = POLLIN;
+            fds[i + 1].revents = 0;
+        }
+        if (poll(fds, AGENT_MAX_CLIENTS + 1, (int)(left * 1000.0) + 1) <= 0) {
+            continue;
+        }
+
+        for (int i = 0; i < AGENT_MAX_CLIENTS; i++) {
+            if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) {
+                if (serve_client(&clients[i], &cur, &in, &out) != 0) {
+                    drop_client(&clients[i]);
+                }
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+            if (fd < 0) {
+                continue;
+            }
+            int slot = -1;
+            for (int i = 0; i < AGENT_MAX_CLIENTS && slot < 0; i++) {
+                slot = clients[i].fd < 0 ? i : -1;
+            }
+            if (slot < 0) {
+                close(fd); // Full
+                continue;
+            }
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            net_set_timeout(fd, AGENT_IO_TIMEOUT_MS);
+            clients[slot].fd = fd;
+        }
+    }
+
+    fprintf(stderr, "Failed to collect the process list.\n");
+    for (int i = 0; i < AGENT_MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0) {
+            close(clients[i].fd);
+        }
+        free_snapshot(&clients[i].sent);
+    }
+    free_snapshot(&cur);
+    free_wire_buf(&in);
+    free_wire_buf(&out);
+    close(listen_fd);
+    return 1;
+}
@@ -0,0 +1,21 @@
+// src/net/agent.h
+#pragma once
+
+// Most clients an agent serves at once
+#define AGENT_MAX_CLIENTS 16
+
+/**
+ * @brief Runs toplite as a headless collector (agent).
+ * @details Collects a snapshot every interval and answers MSG_REQUEST
+ *          messages with the newest snapshot, delta-encoded against the
+ *          snapshot the client acknowledged (see wire.h). Each client costs
+ *          one snapshot copy. Only returns on a fatal error, such as a
+ *          collection that fails.
+ *
+ * @param addr The address to listen on (see net_listen()).
+ * @param interval_ms Collection interval in milliseconds.
+ * @param fields Optional process fields (proc_field_t) to collect in
+ *               addition to the user name and command line.
+ * @return 1 on error.
+ */
+int agent_run(const char *addr, unsigned interval_ms, unsigned fields);
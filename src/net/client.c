@@ -0,0 +1,217 @@
+// src/net/client.c
+#include "client.h"
+#include "../core/sorting.h"
+#include "../ui/input.h"
+#include "../ui/render.h"
+#include "../ui/terminal.h"
+#include "../ui/viewport.h"
+#include "../util/util.h"
+#include "socket.h"
+#include "wire.h"
+#include <limits.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// How long an agent may take to answer before it is considered down
+#define CLIENT_IO_TIMEOUT_MS 5000
+
+// Rows taken by each host besides its header and process rows
+#define HOST_RESERVED_ROWS 3
+
+/**
+ * The connection to one agent and the last snapshot it sent.
+ */
+typedef struct {
+    const char *addr;  // Address of the agent
+    int fd;            // Socket (-1: not connected)
+    snapshot_t snap;   // Snapshot as of the last reply
+    size_t last_bytes; // Size of the last reply
+    const char *error; // Why the last update failed (NULL: it didn't)
+} remote_t;
+
+static void disconnect(remote_t *r, const char *error) {
+    if (r->fd >= 0) {
+        close(r->fd);
+        r->fd = -1;
+    }
+    r->error = error;
+}
+
+/**
+ * Fetches the newest snapshot of an agent, connecting first if needed.
+ */
+static void update_remote(remote_t *r, wire_buf_t *buf) {
+    if (r->fd < 0) {
+        r->fd = net_connect(r->addr);
+        if (r->fd < 0) {
+            r->error = "unreachable";
+            return;
+        }
+        net_set_timeout(r->fd, CLIENT_IO_TIMEOUT_MS);
+    }
+
+    // A new connection starts from the last snapshot too; the agent
+    // replies with a full one if it can't encode against it
+    uint8_t ack[8];
+    for (int i = 0; i < 8; i++) {
+        ack[i] = (uint8_t)(r->snap.seq >> (8 * i));
+    }
+    wire_msg_t type;
+    if (wire_send(r->fd, MSG_REQUEST, ack, sizeof(ack)) != 0 ||
+        wire_recv(r->fd, &type, buf) != 0 || type != MSG_SNAPSHOT) {
+        disconnect(r, "connection lost");
+        return;
+    }
+    if (decode_snapshot(buf->data, buf->len, &r->snap) != 0) {
+        // Start over with a full snapshot
+        free_snapshot(&r->snap);
+        init_snapshot(&r->snap);
+        disconnect(r, "bad snapshot");
+        return;
+    }
+    r->last_bytes = buf->len;
+    r->error = NULL;
+}
+
+/**
+ * Draws one host: a title line, its header and its top processes.
+ */
+static void render_remote(const remote_t *r, proc_list_t *view,
+                          unsigned rows, unsigned cols, bool batch) {
+    printf("== %s (%s)", r->snap.seq ? r->snap.hostname : "?", r->addr);
+    if (r->error) {
+        printf("  [%s]\n", r->error);
+    } else {
+        printf("  snapshot #%llu, %zu bytes\n",
+               (unsigned long long)r->snap.seq, r->last_bytes);
+    }
+    if (r->snap.seq == 0) {
+        return;
+    }
+
+    header_data_t header = {
+        .cpu = &r->snap.cpu,
+        .mem = &r->snap.mem,
+        .ld = &r->snap.ld,
+        .up = &r->snap.up,
+        .users = r->snap.users,
+        .tc = &r->snap.tc,
+    };
+    unsigned used = render_header(&header) + HOST_RESERVED_ROWS;
+
+    // The snapshot stays sorted by PID for the next delta; sort a copy
+    if (view->capacity < r->snap.procs.count) {
+        proc_info_t *procs =
+            realloc(view->procs, r->snap.procs.count * sizeof(proc_info_t));
+        if (!procs) {
+            perror("Failed to allocate memory for process list");
+            return;
+        }
+        view->procs = procs;
+        view->capacity = r->snap.procs.count;
+    }
+    memcpy(view->procs, r->snap.procs.procs,
+           r->snap.procs.count * sizeof(proc_info_t));
+    view->count = r->snap.procs.count;
+    qsort(view->procs, view->count, sizeof(proc_info_t), compare_procs);
+
+    viewport_t vp = {
+        .first = 0,
+        .cursor = SIZE_MAX,
+        .rows = batch ? UINT_MAX : (rows > used ? rows - used : 0),
+    };
+    render_process_list(view, r->snap.hz, &vp, cols);
+}
+
+/**
+ * Handles a key press.
+ *
+ * @return false if the client should quit.
+ */
+static bool handle_key(int key) {
+    switch (key) {
+    case 'q':
+        return false;
+    case '<':
+    case ',':
+        sorting_prev_column();
+        break;
+    case '>':
+    case '.':
+        sorting_next_column();
+        break;
+    case 'R':
+        sorting_flip_direction();
+        break;
+    }
+    return true;
+}
+
+int client_run(const char *const *addrs, size_t count, unsigned interval_ms,
+               bool batch, unsigned iterations) {
+    remote_t remotes[CLIENT_MAX_AGENTS];
+    for (size_t i = 0; i < count; i++) {
+        remotes[i] = (remote_t){.addr = addrs[i], .fd = -1};
+        init_snapshot(&remotes[i].snap);
+    }
+    signal(SIGPIPE, SIG_IGN); // A vanished agent is handled by write()
+
+    if (!batch) {
+        enable_raw_mode();
+    }
+    wire_buf_t buf = {0};
+    proc_list_t view;
+    init_process_list(&view);
+
+    bool running = true;
+    for (unsigned frame = 0; running && (!iterations || frame < iterations);
+         frame++) {
+        for (size_t i = 0; i < count; i++) {
+            update_remote(&remotes[i], &buf);
+        }
+
+        terminal_t term;
+        get_term_size(&term);
+        if (batch) {
+            if (frame > 0) {
+                printf("\n");
+            }
+        } else {
+            printf("\033[H\033[J"); // Clear screen
+        }
+        // Every host gets an equal share of the screen
+        for (size_t i = 0; i < count; i++) {
+            render_remote(&remotes[i], &view, term.rows / (unsigned)count,
+                          term.cols, batch);
+        }
+        fflush(stdout);
+
+        if (iterations && frame + 1 == iterations) {
+            break;
+        }
+        if (batch) {
+            usleep(interval_ms * 1000);
+            continue;
+        }
+        double deadline = monotonic_seconds() + interval_ms / 1000.0;
+        while (running) {
+            double left = deadline - monotonic_seconds();
+            if (left <= 0 || !wait_for_input((unsigned)(left * 1000))) {
+                break;
+            }
+            running = handle_key(read_key());
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        disconnect(&remotes[i], NULL);
+        free_snapshot(&remotes[i].snap);
+    }
+    free(view.procs);
+    free_wire_buf(&buf);
+    return 0;
+}
@@ -0,0 +1,25 @@
+// src/net/client.h
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+// Most agents a client shows at once
+#define CLIENT_MAX_AGENTS 8
+
+/**
+ * @brief Runs toplite as a client of one or more agents.
+ * @details Every interval, each agent is asked for its newest snapshot
+ *          (acknowledging the last one applied, so only a delta comes back)
+ *          and the hosts are drawn one below the other, each with its own
+ *          header and the top of its process list. Unreachable agents are
+ *          retried on the next interval.
+ *
+ * @param addrs Addresses of the agents (see net_connect()).
+ * @param count Number of addresses (at most CLIENT_MAX_AGENTS).
+ * @param interval_ms Refresh interval in milliseconds.
+ * @param batch true to print plain frames instead of driving the terminal.
+ * @param iterations Number of frames to show (0: until 'q').
+ * @return 0 on success, 1 on error.
+ */
+int client_run(const char *const *addrs, size_t count, unsigned interval_ms,
+               bool batch, unsigned iterations);
@@ -0,0 +1,158 @@
+// src/net/socket.c
+#include "socket.h"
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define UNIX_PREFIX "unix:"
+
+/**
+ * Fills a unix socket address.
+ *
+ * @return 0 on success, -1 if the path is too long.
+ */
+static int unix_address(const char *path, struct sockaddr_un *sun) {
+    memset(sun, 0, sizeof(*sun));
+    sun->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(sun->sun_path)) {
+        fprintf(stderr, "%s: socket path too long\n", path);
+        return -1;
+    }
+    strcpy(sun->sun_path, path);
+    return 0;
+}
+
+/**
+ * Resolves "host:port" ("[v6]:port" for IPv6 literals).
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int tcp_address(const char *addr, int passive, struct addrinfo **out) {
+    char host[256];
+    const char *colon = strrchr(addr, ':');
+    if (!colon || (size_t)(colon - addr) >= sizeof(host)) {
+        fprintf(stderr, "%s: expected host:port or unix:/path\n", addr);
+        return -1;
+    }
+    memcpy(host, addr, (size_t)(colon - addr));
+    host[colon - addr] = '\0';
+
+    char *h = host;
+    size_t hlen = strlen(h);
+    if (hlen >= 2 && h[0] == '[' && h[hlen - 1] == ']') {
+        h[hlen - 1] = '\0';
+        h++;
+    }
+
+    struct addrinfo hints = {0};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+    int err = getaddrinfo(h[0] ? h : NULL, colon + 1, &hints, out);
+    if (err != 0) {
+        fprintf(stderr, "%s: %s\n", addr, gai_strerror(err));
+        return -1;
+    }
+    return 0;
+}
+
+int net_listen(const char *addr) {
+    if (strncmp(addr, UNIX_PREFIX, strlen(UNIX_PREFIX)) == 0) {
+        const char *path = addr + strlen(UNIX_PREFIX);
+        struct sockaddr_un sun;
+        if (unix_address(path, &sun) != 0) {
+            return -1;
+        }
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            perror("socket");
+            return -1;
+        }
+        unlink(path); // A stale socket from an earlier run
+        if (bind(fd, (struct sockaddr *)&sun, sizeof(sun)) != 0 ||
+            listen(fd, 16) != 0) {
+            perror(path);
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    struct addrinfo *res;
+    if (tcp_address(addr, 1, &res) != 0) {
+        return -1;
+    }
+    int fd = -1;
+    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC,
+                    ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, 16) == 0) {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd < 0) {
+        perror(addr);
+    }
+    return fd;
+}
+
+int net_connect(const char *addr) {
+    if (strncmp(addr, UNIX_PREFIX, strlen(UNIX_PREFIX)) == 0) {
+        struct sockaddr_un sun;
+        if (unix_address(addr + strlen(UNIX_PREFIX), &sun) != 0) {
+            return -1;
+        }
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, (struct sockaddr *)&sun, sizeof(sun)) != 0) {
+            close(fd);
+            fd = -1;
+        }
+        return fd;
+    }
+
+    struct addrinfo *res;
+    if (tcp_address(addr, 0, &res) != 0) {
+        return -1;
+    }
+    int fd = -1;
+    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC,
+                    ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            // Requests and replies are single small writes; don't delay them
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+void net_set_timeout(int fd, unsigned timeout_ms) {
+    struct timeval tv = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000,
+    };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
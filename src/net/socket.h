@@ -0,0 +1,29 @@
+// src/net/socket.h
+#pragma once
+
+/**
+ * @brief Opens a listening socket.
+ * @details "unix:/path/to/socket" listens on a unix socket (an existing
+ *          socket file is replaced); anything else is "host:port" for TCP,
+ *          e.g. "127.0.0.1:7070", "[::1]:7070" or ":7070" for every address.
+ *
+ * @param addr The address to listen on.
+ * @return The socket, or -1 on error (a message is printed).
+ */
+int net_listen(const char *addr);
+
+/**
+ * @brief Connects to an address in the net_listen() format.
+ *
+ * @param addr The address to connect to.
+ * @return The socket, or -1 on error.
+ */
+int net_connect(const char *addr);
+
+/**
+ * @brief Limits how long a blocking send or receive may take on a socket.
+ *
+ * @param fd The socket.
+ * @param timeout_ms The timeout in milliseconds.
+ */
+void net_set_timeout(int fd, unsigned timeout_ms);
@@ -0,0 +1,608 @@
+// src/net/wire.c
+#include "wire.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Per-process fields that can be sent in a delta record
+enum {
+    F_PPID = 1 << 0,
+    F_USER = 1 << 1,
+    F_PRIO = 1 << 2,
+    F_NICE = 1 << 3,
+    F_VIRT = 1 << 4,
+    F_RES = 1 << 5,
+    F_SHR = 1 << 6,
+    F_STATE = 1 << 7,
+    F_CPU = 1 << 8,
+    F_MEM = 1 << 9,
+    F_START = 1 << 10,
+    F_TICKS = 1 << 11,
+    F_THREADS = 1 << 12,
+    F_COMMAND = 1 << 13,
+    F_IO = 1 << 14,
+    F_ALL = (1 << 15) - 1,
+};
+
+void init_snapshot(snapshot_t *snap) {
+    memset(snap, 0, sizeof(*snap));
+    init_process_list(&snap->procs);
+}
+
+void free_snapshot(snapshot_t *snap) {
+    free(snap->procs.procs);
+    init_snapshot(snap);
+}
+
+int copy_snapshot(snapshot_t *dst, const snapshot_t *src) {
+    proc_list_t procs = dst->procs;
+    if (procs.capacity < src->procs.count) {
+        proc_info_t *p =
+            realloc(procs.procs, src->procs.count * sizeof(proc_info_t));
+        if (!p) {
+            perror("Failed to allocate memory for snapshot");
+            return -1;
+        }
+        procs.procs = p;
+        procs.capacity = src->procs.count;
+    }
+    if (src->procs.count > 0) {
+        memcpy(procs.procs, src->procs.procs,
+               src->procs.count * sizeof(proc_info_t));
+    }
+    procs.count = src->procs.count;
+
+    *dst = *src;
+    dst->procs = procs;
+    return 0;
+}
+
+void free_wire_buf(wire_buf_t *buf) {
+    free(buf->data);
+    memset(buf, 0, sizeof(*buf));
+}
+
+// --- Encoding (little-endian) ---
+
+static void put_bytes(wire_buf_t *b, const void *data, size_t len) {
+    if (b->error) {
+        return;
+    }
+    if (b->len + len > b->capacity) {
+        size_t cap = b->capacity ? b->capacity : 4096;
+        while (cap < b->len + len) {
+            cap *= 2;
+        }
+        uint8_t *data_new = realloc(b->data, cap);
+        if (!data_new) {
+            perror("Failed to allocate memory for message");
+            b->error = 1;
+            return;
+        }
+        b->data = data_new;
+        b->capacity = cap;
+    }
+    memcpy(b->data + b->len, data, len);
+    b->len += len;
+}
+
+static void put_uint(wire_buf_t *b, uint64_t v, int size) {
+    uint8_t bytes[8];
+    for (int i = 0; i < size; i++) {
+        bytes[i] = (uint8_t)(v >> (8 * i));
+    }
+    put_bytes(b, bytes, (size_t)size);
+}
+
+#define put_u8(b, v) put_uint(b, (uint64_t)(v), 1)
+#define put_u16(b, v) put_uint(b, (uint64_t)(v), 2)
+#define put_u32(b, v) put_uint(b, (uint64_t)(v), 4)
+#define put_u64(b, v) put_uint(b, (uint64_t)(v), 8)
+
+static void put_f64(wire_buf_t *b, double v) {
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    put_u64(b, bits);
+}
+
+static void put_str(wire_buf_t *b, const char *s) {
+    size_t len = strlen(s);
+    put_u16(b, len);
+    put_bytes(b, s, len);
+}
+
+// --- Decoding ---
+
+/**
+ * Reads values out of a payload; any overrun sets 'error' and makes every
+ * later read return zeros.
+ */
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+    int error;
+} reader_t;
+
+static uint64_t get_uint(reader_t *r, int size) {
+    if (r->error || r->end - r->p < size) {
+        r->error = 1;
+        return 0;
+    }
+    uint64_t v = 0;
+    for (int i = 0; i < size; i++) {
+        v |= (uint64_t)r->p[i] << (8 * i);
+    }
+    r->p += size;
+    return v;
+}
+
+#define get_u8(r) ((uint8_t)get_uint(r, 1))
+#define get_u16(r) ((uint16_t)get_uint(r, 2))
+#define get_u32(r) ((uint32_t)get_uint(r, 4))
+#define get_u64(r) get_uint(r, 8)
+
+static double get_f64(reader_t *r) {
+    uint64_t bits = get_u64(r);
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+/**
+ * Reads a string, truncating it to the destination buffer.
+ */
+static void get_str(reader_t *r, char *out, size_t size) {
+    size_t len = get_u16(r);
+    if (r->error || (size_t)(r->end - r->p) < len) {
+        r->error = 1;
+        out[0] = '\0';
+        return;
+    }
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(out, r->p, n);
+    out[n] = '\0';
+    r->p += len;
+}
+
+// --- Snapshots ---
+
+/**
+ * Finds which fields of a process differ from its previous version.
+ */
+static unsigned changed_fields(const proc_info_t *a, const proc_info_t *b) {
+    if (!a) {
+        return F_ALL;
+    }
+
+    unsigned mask = 0;
+    mask |= (a->ppid != b->ppid) ? F_PPID : 0;
+    mask |= strcmp(a->user, b->user) ? F_USER : 0;
+    mask |= strcmp(a->priority, b->priority) ? F_PRIO : 0;
+    mask |= (a->nice != b->nice) ? F_NICE : 0;
+    mask |= (a->virt_mem != b->virt_mem) ? F_VIRT : 0;
+    mask |= (a->res_mem != b->res_mem) ? F_RES : 0;
+    mask |= (a->shr_mem != b->shr_mem) ? F_SHR : 0;
+    mask |= (a->state != b->state) ? F_STATE : 0;
+    mask |= (a->cpu_percent != b->cpu_percent) ? F_CPU : 0;
+    mask |= (a->mem_percent != b->mem_percent) ? F_MEM : 0;
+    mask |= (a->uptime_ticks != b->uptime_ticks) ? F_START : 0;
+    mask |= (a->cpu_ticks != b->cpu_ticks) ? F_TICKS : 0;
+    mask |= (a->num_threads != b->num_threads) ? F_THREADS : 0;
+    mask |= strcmp(a->command, b->command) ? F_COMMAND : 0;
+    mask |= (a->io_valid != b->io_valid ||
+             a->io_read_rate != b->io_read_rate ||
+             a->io_write_rate != b->io_write_rate ||
+             a->io_syscr_rate != b->io_syscr_rate ||
+             a->io_syscw_rate != b->io_syscw_rate)
+                ? F_IO
+                : 0;
+    return mask;
+}
+
+static void put_process(wire_buf_t *b, const proc_info_t *p, unsigned mask) {
+    put_u32(b, p->pid);
+    put_u16(b, mask);
+    if (mask & F_PPID) {
+        put_u32(b, p->ppid);
+    }
+    if (mask & F_USER) {
+        put_str(b, p->user);
+    }
+    if (mask & F_PRIO) {
+        put_str(b, p->priority);
+    }
+    if (mask & F_NICE) {
+        put_u64(b, p->nice);
+    }
+    if (mask & F_VIRT) {
+        put_u64(b, p->virt_mem);
+    }
+    if (mask & F_RES) {
+        put_u64(b, p->res_mem);
+    }
+    if (mask & F_SHR) {
+        put_u64(b, p->shr_mem);
+    }
+    if (mask & F_STATE) {
+        put_u8(b, p->state);
+    }
+    if (mask & F_CPU) {
+        put_f64(b, p->cpu_percent);
+    }
+    if (mask & F_MEM) {
+        put_f64(b, p->mem_percent);
+    }
+    if (mask & F_START) {
+        put_u64(b, p->uptime_ticks);
+    }
+    if (mask & F_TICKS) {
+        put_u64(b, p->cpu_ticks);
+    }
+    if (mask & F_THREADS) {
+        put_u64(b, p->num_threads);
+    }
+    if (mask & F_COMMAND) {
+        put_str(b, p->command);
+    }
+    if (mask & F_IO) {
+        put_u8(b, p->io_valid);
+        put_f64(b, p->io_read_rate);
+        put_f64(b, p->io_write_rate);
+        put_f64(b, p->io_syscr_rate);
+        put_f64(b, p->io_syscw_rate);
+    }
+}
+
+static void get_process(reader_t *r, proc_info_t *p, unsigned mask) {
+    if (mask & F_PPID) {
+        p->ppid = (pid_t)get_u32(r);
+    }
+    if (mask & F_USER) {
+        get_str(r, p->user, sizeof(p->user));
+    }
+    if (mask & F_PRIO) {
+        get_str(r, p->priority, sizeof(p->priority));
+    }
+    if (mask & F_NICE) {
+        p->nice = (long)get_u64(r);
+    }
+    if (mask & F_VIRT) {
+        p->virt_mem = (unsigned long)get_u64(r);
+    }
+    if (mask & F_RES) {
+        p->res_mem = (unsigned long)get_u64(r);
+    }
+    if (mask & F_SHR) {
+        p->shr_mem = (unsigned long)get_u64(r);
+    }
+    if (mask & F_STATE) {
+        p->state = (char)get_u8(r);
+    }
+    if (mask & F_CPU) {
+        p->cpu_percent = get_f64(r);
+    }
+    if (mask & F_MEM) {
+        p->mem_percent = get_f64(r);
+    }
+    if (mask & F_START) {
+        p->uptime_ticks = get_u64(r);
+    }
+    if (mask & F_TICKS) {
+        p->cpu_ticks = get_u64(r);
+    }
+    if (mask & F_THREADS) {
+        p->num_threads = (long)get_u64(r);
+    }
+    if (mask & F_COMMAND) {
+        get_str(r, p->command, sizeof(p->command));
+    }
+    if (mask & F_IO) {
+        p->io_valid = get_u8(r);
+        p->io_read_rate = get_f64(r);
+        p->io_write_rate = get_f64(r);
+        p->io_syscr_rate = get_f64(r);
+        p->io_syscw_rate = get_f64(r);
+    }
+}
+
+int encode_snapshot(const snapshot_t *cur, const snapshot_t *base,
+                    wire_buf_t *out) {
+    put_u64(out, cur->seq);
+    put_u64(out, base ? base->seq : 0);
+
+    // The header is small, so it is always sent in full
+    put_str(out, cur->hostname);
+    put_u32(out, cur->hz);
+    put_f64(out, cur->cpu.us);
+    put_f64(out, cur->cpu.sy);
+    put_f64(out, cur->cpu.ni);
+    put_f64(out, cur->cpu.id);
+    put_f64(out, cur->cpu.wa);
+    put_f64(out, cur->cpu.hi);
+    put_f64(out, cur->cpu.si);
+    put_f64(out, cur->cpu.st);
+    put_u64(out, cur->mem.mem_total);
+    put_u64(out, cur->mem.mem_free);
+    put_u64(out, cur->mem.buffers);
+    put_u64(out, cur->mem.cached);
+    put_u64(out, cur->mem.sreclaimable);
+    put_u64(out, cur->mem.shmem);
+    put_u64(out, cur->mem.mem_available);
+    put_u64(out, cur->mem.swap_total);
+    put_u64(out, cur->mem.swap_free);
+    put_f64(out, cur->ld.load1);
+    put_f64(out, cur->ld.load5);
+    put_f64(out, cur->ld.load15);
+    put_u32(out, cur->up.days);
+    put_u32(out, cur->up.hours);
+    put_u32(out, cur->up.minutes);
+    put_u32(out, cur->users);
+    put_u32(out, cur->tc.total);
+    put_u32(out, cur->tc.running);
+    put_u32(out, cur->tc.sleeping);
+    put_u32(out, cur->tc.stopped);
+    put_u32(out, cur->tc.zombie);
+
+    // Both lists are sorted by PID, so one merge finds removed, new and
+    // changed processes. Counts are patched in once known.
+    const proc_info_t *bp = base ? base->procs.procs : NULL;
+    size_t bn = base ? base->procs.count : 0;
+    const proc_info_t *cp = cur->procs.procs;
+    size_t cn = cur->procs.count;
+
+    size_t count_at = out->len;
+    put_u32(out, 0);
+    uint32_t removed = 0;
+    for (size_t i = 0, j = 0; i < bn; i++) {
+        while (j < cn && cp[j].pid < bp[i].pid) {
+            j++;
+        }
+        if (j == cn || cp[j].pid != bp[i].pid) {
+            put_u32(out, bp[i].pid);
+            removed++;
+        }
+    }
+
+    size_t records_at = out->len;
+    put_u32(out, 0);
+    uint32_t records = 0;
+    for (size_t i = 0, j = 0; j < cn; j++) {
+        while (i < bn && bp[i].pid < cp[j].pid) {
+            i++;
+        }
+        const proc_info_t *old = (i < bn && bp[i].pid == cp[j].pid) ? &bp[i]
+                                                                    : NULL;
+        unsigned mask = changed_fields(old, &cp[j]);
+        if (mask) {
+            put_process(out, &cp[j], mask);
+            records++;
+        }
+    }
+
+    if (out->error) {
+        return -1;
+    }
+    for (int k = 0; k < 4; k++) {
+        out->data[count_at + k] = (uint8_t)(removed >> (8 * k));
+        out->data[records_at + k] = (uint8_t)(records >> (8 * k));
+    }
+    return 0;
+}
+
+static int compare_pid(const void *a, const void *b) {
+    pid_t pa = ((const proc_info_t *)a)->pid;
+    pid_t pb = ((const proc_info_t *)b)->pid;
+    return (pa > pb) - (pa < pb);
+}
+
+/**
+ * Finds a process in a list sorted by PID.
+ */
+static proc_info_t *find_pid(proc_list_t *list, size_t n, pid_t pid) {
+    proc_info_t key = {.pid = pid};
+    return bsearch(&key, list->procs, n, sizeof(proc_info_t), compare_pid);
+}
+
+/**
+ * Appends a process to a list, growing it if necessary.
+ */
+static proc_info_t *append_process(proc_list_t *list) {
+    if (list->count == list->capacity) {
+        size_t cap = list->capacity ? list->capacity * 2 : 64;
+        proc_info_t *p = realloc(list->procs, cap * sizeof(proc_info_t));
+        if (!p) {
+            perror("Failed to allocate memory for snapshot");
+            return NULL;
+        }
+        list->procs = p;
+        list->capacity = cap;
+    }
+    proc_info_t *p = &list->procs[list->count++];
+    memset(p, 0, sizeof(*p));
+    return p;
+}
+
+int decode_snapshot(const uint8_t *data, size_t len, snapshot_t *snap) {
+    reader_t r = {data, data + len, 0};
+
+    uint64_t seq = get_u64(&r);
+    uint64_t base_seq = get_u64(&r);
+    if (r.error || (base_seq != 0 && base_seq != snap->seq)) {
+        return -1;
+    }
+    if (base_seq == 0) {
+        snap->procs.count = 0; // Full snapshot
+    }
+
+    get_str(&r, snap->hostname, sizeof(snap->hostname));
+    snap->hz = get_u32(&r);
+    snap->cpu.us = get_f64(&r);
+    snap->cpu.sy = get_f64(&r);
+    snap->cpu.ni = get_f64(&r);
+    snap->cpu.id = get_f64(&r);
+    snap->cpu.wa = get_f64(&r);
+    snap->cpu.hi = get_f64(&r);
+    snap->cpu.si = get_f64(&r);
+    snap->cpu.st = get_f64(&r);
+    snap->mem.mem_total = get_u64(&r);
+    snap->mem.mem_free = get_u64(&r);
+    snap->mem.buffers = get_u64(&r);
+    snap->mem.cached = get_u64(&r);
+    snap->mem.sreclaimable = get_u64(&r);
+    snap->mem.shmem = get_u64(&r);
+    snap->mem.mem_available = get_u64(&r);
+    snap->mem.swap_total = get_u64(&r);
+    snap->mem.swap_free = get_u64(&r);
+    snap->ld.load1 = get_f64(&r);
+    snap->ld.load5 = get_f64(&r);
+    snap->ld.load15 = get_f64(&r);
+    snap->up.days = get_u32(&r);
+    snap->up.hours = get_u32(&r);
+    snap->up.minutes = get_u32(&r);
+    snap->users = (int)get_u32(&r);
+    snap->tc.total = get_u32(&r);
+    snap->tc.running = get_u32(&r);
+    snap->tc.sleeping = get_u32(&r);
+    snap->tc.stopped = get_u32(&r);
+    snap->tc.zombie = get_u32(&r);
+
+    // Removed processes get a zero state (never a real one) and are
+    // compacted at the end, so lookups stay valid while the delta is applied
+    size_t known = snap->procs.count;
+    uint32_t removed = get_u32(&r);
+    for (uint32_t i = 0; i < removed && !r.error; i++) {
+        proc_info_t *p = find_pid(&snap->procs, known, (pid_t)get_u32(&r));
+        if (p) {
+            p->state = '\0';
+        }
+    }
+
+    uint32_t records = get_u32(&r);
+    for (uint32_t i = 0; i < records && !r.error; i++) {
+        pid_t pid = (pid_t)get_u32(&r);
+        unsigned mask = get_u16(&r);
+        proc_info_t *p = find_pid(&snap->procs, known, pid);
+        if (!p) {
+            if (mask != F_ALL || !(p = append_process(&snap->procs))) {
+                return -1; // A new process must come with every field
+            }
+            p->pid = pid;
+            p->history = -1; // Rings are local to the agent
+            p->has_details = 1;
+        }
+        get_process(&r, p, mask);
+    }
+    if (r.error) {
+        return -1;
+    }
+
+    // Drop the removed processes and restore the PID order
+    size_t n = 0;
+    for (size_t i = 0; i < snap->procs.count; i++) {
+        if (snap->procs.procs[i].state != '\0') {
+            snap->procs.procs[n++] = snap->procs.procs[i];
+        }
+    }
+    snap->procs.count = n;
+    qsort(snap->procs.procs, n, sizeof(proc_info_t), compare_pid);
+    snap->seq = seq;
+    return 0;
+}
+
+// --- Framing ---
+
+static int write_all(int fd, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int read_all(int fd, uint8_t *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = read(fd, data, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+int wire_send(int fd, wire_msg_t type, const uint8_t *payload, size_t len) {
+    uint8_t header[5];
+    for (int i = 0; i < 4; i++) {
+        header[i] = (uint8_t)(len >> (8 * i));
+    }
+    header[4] = (uint8_t)type;
+
+    // One writev() so the header and payload leave in the same segment
+    struct iovec iov[2] = {
+        {.iov_base = header, .iov_len = sizeof(header)},
+        {.iov_base = (void *)payload, .iov_len = len},
+    };
+    ssize_t n;
+    do {
+        n = writev(fd, iov, len > 0 ? 2 : 1);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        return -1;
+    }
+
+    // Finish a short write the slow way
+    size_t sent = (size_t)n;
+    if (sent < sizeof(header)) {
+        if (write_all(fd, header + sent, sizeof(header) - sent) != 0) {
+            return -1;
+        }
+        sent = sizeof(header);
+    }
+    sent -= sizeof(header);
+    return write_all(fd, payload + sent, len - sent);
+}
+
+int wire_recv(int fd, wire_msg_t *type, wire_buf_t *payload) {
+    uint8_t header[5];
+    if (read_all(fd, header, sizeof(header)) != 0) {
+        return -1;
+    }
+    size_t len = 0;
+    for (int i = 0; i < 4; i++) {
+        len |= (size_t)header[i] << (8 * i);
+    }
+    if (len > WIRE_MAX_MESSAGE) {
+        return -1;
+    }
+
+    payload->len = 0;
+    if (len > payload->capacity) {
+        uint8_t *data = realloc(payload->data, len);
+        if (!data) {
+            perror("Failed to allocate memory for message");
+            return -1;
+        }
+        payload->data = data;
+        payload->capacity = len;
+    }
+    if (read_all(fd, payload->data, len) != 0) {
+        return -1;
+    }
+    payload->len = len;
+    *type = (wire_msg_t)header[4];
+    return 0;
+}
@@ -0,0 +1,110 @@
+// src/net/wire.h
+#pragma once
+#include "../core/process.h"
+#include "../core/system.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Largest message either side accepts, so a bad peer can't exhaust memory
+#define WIRE_MAX_MESSAGE (64u << 20)
+
+/**
+ * Message types. Every message is framed as a 4-byte little-endian payload
+ * length, a 1-byte type and the payload.
+ */
+typedef enum {
+    MSG_REQUEST = 1,  // Client -> agent: u64 seq of the last snapshot applied
+    MSG_SNAPSHOT = 2, // Agent -> client: a snapshot, see encode_snapshot()
+} wire_msg_t;
+
+/**
+ * Everything an agent publishes about its host in one collection.
+ */
+typedef struct {
+    uint64_t seq;      // Collection number (0: no snapshot yet)
+    char hostname[64]; // Host name of the agent
+    long hz;           // Agent's clock ticks per second (for TIME+)
+    cpu_percent_t cpu; // CPU usage
+    mem_info_t mem;    // Memory and swap
+    load_avg_t ld;     // Load averages
+    uptime_fmt_t up;   // System uptime
+    int users;         // Number of logged-in users
+    task_counts_t tc;  // Task counts
+    proc_list_t procs; // Processes, sorted by PID
+} snapshot_t;
+
+/**
+ * A growable byte buffer messages are encoded into.
+ */
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    size_t capacity;
+    int error; // Set if an allocation failed; later writes are dropped
+} wire_buf_t;
+
+/**
+ * @brief Initializes an empty snapshot.
+ */
+void init_snapshot(snapshot_t *snap);
+
+/**
+ * @brief Frees the memory allocated for a snapshot.
+ */
+void free_snapshot(snapshot_t *snap);
+
+/**
+ * @brief Copies a snapshot, reusing the destination's process array.
+ *
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+int copy_snapshot(snapshot_t *dst, const snapshot_t *src);
+
+/**
+ * @brief Releases the memory of a wire buffer.
+ */
+void free_wire_buf(wire_buf_t *buf);
+
+/**
+ * @brief Encodes a snapshot as the delta against an older one.
+ * @details The header is always sent in full. For the processes, only the
+ *          PIDs that are gone, and the fields that changed since 'base' are
+ *          sent (every field of a process that is new). With a NULL base
+ *          the whole snapshot is sent.
+ *
+ * @param cur The snapshot to send.
+ * @param base The snapshot the client already has, or NULL.
+ * @param out Buffer the payload is appended to.
+ * @return 0 on success, -1 if memory allocation fails.
+ */
+int encode_snapshot(const snapshot_t *cur, const snapshot_t *base,
+                    wire_buf_t *out);
+
+/**
+ * @brief Applies an encoded snapshot onto the one the client has.
+ * @details A delta is only accepted if it was encoded against snap->seq;
+ *          a full snapshot replaces whatever snap holds.
+ *
+ * @param data The payload of a MSG_SNAPSHOT message.
+ * @param len Length of the payload.
+ * @param snap The client's snapshot, updated in place.
+ * @return 0 on success, -1 on a malformed payload or mismatched base.
+ */
+int decode_snapshot(const uint8_t *data, size_t len, snapshot_t *snap);
+
+/**
+ * @brief Sends one framed message.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int wire_send(int fd, wire_msg_t type, const uint8_t *payload, size_t len);
+
+/**
+ * @brief Receives one framed message.
+ *
+ * @param fd The socket.
+ * @param type Set to the message type.
+ * @param payload Buffer the payload is read into (grown as needed).
+ * @return 0 on success, -1 on error or if the peer closed the connection.
+ */
+int wire_recv(int fd, wire_msg_t *type, wire_buf_t *payload);
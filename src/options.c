@@ -0,0 +1,502 @@
+// src/options.c
+#include "options.h"
+#include "core/capture.h"
+#include "core/history.h"
+#include "core/iostat.h"
+#include "core/process.h"
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void print_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options] [interval_ms]\n"
+            "  -c, --cgroup PATH   show only the processes of a cgroup v2\n"
+            "                      (and its children)\n"
+            "  -g, --group-cgroups start with one row per cgroup ('g')\n"
+            "      --irqs          start with one row per interrupt source\n"
+            "                      and softirq, with the CPUs it lands on\n"
+            "                      ('I')\n"
+            "  -i, --io            show I/O rate columns ('i')\n"
+            "  -f, --faults        show page fault and context switch rate\n"
+            "                      columns ('f')\n"
+            "  -w, --schedstat     show on-CPU and run queue wait time\n"
+            "                      columns from schedstat ('w')\n"
+            "      --last-cpu      show the CPU each process last ran on\n"
+            "                      and its NUMA node ('c')\n"
+            "  -m, --smaps         show PSS/USS/SWAP columns ('m')\n"
+            "      --smaps-reads N read at most N smaps_rollup files per\n"
+            "                      frame, visible rows first (default 16)\n"
+            "      --disks         show the busiest block devices ('D')\n"
+            "      --net           show the busiest network interfaces ('T')\n"
+            "      --vmstat        show paging and reclaim rates ('v')\n"
+            "      --top-devices N show at most N devices of each kind, sum\n"
+            "                      up the rest (default 4)\n"
+            "      --all-devices   include loop and RAM disks and loopback\n"
+            "      --events        follow fork/exec/exit through the netlink\n"
+            "                      proc connector (CAP_NET_ADMIN before\n"
+            "                      Linux 6.6) and rescan /proc only every\n"
+            "                      30 seconds\n"
+            "      --sample N      on hosts with huge task counts, read only\n"
+            "                      the busiest processes and a rotating\n"
+            "                      slice of the others per frame, so each\n"
+            "                      process is read within N frames; the\n"
+            "                      others keep their values (STALE column)\n"
+            "      --sample-top K  busiest processes read every frame in\n"
+            "                      sampling mode (default 64)\n"
+            "      --cumulative    show CPU time, I/O and faults since start\n"
+            "                      or since 'b' was pressed (TCPU, TREAD,\n"
+            "                      ... columns), keeping exited processes\n"
+            "                      ('a')\n",
+            prog);
+    fprintf(stderr,
+            "  -b, --batch         print every frame to stdout, no UI\n"
+            "  -n, --iterations N  stop after N frames (batch mode)\n"
+            "      --psi-trigger R:some|full:STALL_US:WINDOW_US\n"
+            "                      in batch mode, print a frame as soon as\n"
+            "                      the pressure trigger fires (repeatable)\n"
+            "      --trigger RULE  run headless and write a detailed snapshot\n"
+            "                      when RULE holds, e.g. 'cpu.iowait>40' or\n"
+            "                      'proc.rss>8G' (repeatable, see below)\n"
+            "      --trigger-dir DIR\n"
+            "                      write the snapshots to DIR (default .)\n"
+            "      --trigger-keep N\n"
+            "                      rotate through N snapshot files\n"
+            "                      (default 10)\n"
+            "      --trigger-cooldown SEC\n"
+            "                      capture again for a rule only after SEC\n"
+            "                      seconds (default 60)\n"
+            "      --cpu-budget PCT\n"
+            "                      adapt the interval so toplite uses at\n"
+            "                      most PCT%% of one CPU\n"
+            "      --min-interval MS, --max-interval MS\n"
+            "                      bounds of the adaptive interval\n"
+            "                      (default 250 and 10000)\n"
+            "      --idle          run under the SCHED_IDLE policy\n"
+            "      --history-samples N\n"
+            "                      samples of %%CPU/RES/I/O kept per process\n"
+            "                      for the sparklines ('s', 'd'); 0 disables\n"
+            "                      (default 32, 12 bytes per sample)\n"
+            "      --history-pids N\n"
+            "                      processes that can have a history at the\n"
+            "                      same time (default 4096)\n"
+            "      --collector sync|io_uring\n"
+            "                      read /proc/[pid] with one syscall per\n"
+            "                      file, or batched through io_uring\n"
+            "                      (default sync, see --bench-collect)\n"
+            "      --bench-collect N\n"
+            "                      time N collections with every collector\n"
+            "                      and exit\n"
+            "      --bench-search N\n"
+            "                      time indexing and searching N made-up\n"
+            "                      processes and exit\n"
+            "      --serve ADDR    run headless and serve snapshots on ADDR\n"
+            "                      (host:port or unix:/path)\n"
+            "      --connect ADDR  show the hosts of the agents at ADDR\n"
+            "                      instead of this one (repeatable)\n"
+            "  -h, --help          show this help\n"
+            "\n"
+            "A RULE is METRIC>VALUE (or >=, <, <=); VALUE may end in K, M,\n"
+            "G or T. proc.* rules fire for any process. The metrics are:\n");
+    rules_print_metrics(stderr);
+}
+
+/**
+ * Parses a strictly positive integer.
+ *
+ * @return 0 on success, -1 on conversion errors or non-positive input.
+ */
+static int parse_positive(const char *s, unsigned *out) {
+    char *endptr;
+    long val = strtol(s, &endptr, 10);
+    // Check for conversion errors and non-numeric input
+    if (endptr == s || *endptr != '\0' || val <= 0) {
+        return -1;
+    }
+    *out = (unsigned)val;
+    return 0;
+}
+
+/**
+ * Parses a non-negative integer.
+ *
+ * @return 0 on success, -1 on conversion errors or negative input.
+ */
+static int parse_count(const char *s, unsigned *out) {
+    char *endptr;
+    long val = strtol(s, &endptr, 10);
+    if (endptr == s || *endptr != '\0' || val < 0) {
+        return -1;
+    }
+    *out = (unsigned)val;
+    return 0;
+}
+
+/**
+ * Parses a strictly positive percentage (fractions allowed, e.g. "0.5").
+ *
+ * @return 0 on success, -1 on conversion errors or out-of-range input.
+ */
+static int parse_percent(const char *s, double *out) {
+    char *endptr;
+    double val = strtod(s, &endptr);
+    if (endptr == s || *endptr != '\0' || val <= 0 || val > 100) {
+        return -1;
+    }
+    *out = val;
+    return 0;
+}
+
+// Long-only options
+enum {
+    OPT_PSI_TRIGGER = 256,
+    OPT_CPU_BUDGET,
+    OPT_MIN_INTERVAL,
+    OPT_MAX_INTERVAL,
+    OPT_IDLE,
+    OPT_HISTORY_SAMPLES,
+    OPT_HISTORY_PIDS,
+    OPT_LAST_CPU,
+    OPT_SMAPS_READS,
+    OPT_SERVE,
+    OPT_CONNECT,
+    OPT_COLLECTOR,
+    OPT_BENCH_COLLECT,
+    OPT_BENCH_SEARCH,
+    OPT_EVENTS,
+    OPT_DISKS,
+    OPT_NET,
+    OPT_VMSTAT,
+    OPT_IRQS,
+    OPT_TOP_DEVICES,
+    OPT_ALL_DEVICES,
+    OPT_SAMPLE,
+    OPT_SAMPLE_TOP,
+    OPT_CUMULATIVE,
+    OPT_TRIGGER,
+    OPT_TRIGGER_DIR,
+    OPT_TRIGGER_KEEP,
+    OPT_TRIGGER_COOLDOWN,
+};
+
+int parse_options(int argc, char **argv, options_t *opts) {
+    static const struct option long_opts[] = {
+        {"cgroup", required_argument, NULL, 'c'},
+        {"group-cgroups", no_argument, NULL, 'g'},
+        {"irqs", no_argument, NULL, OPT_IRQS},
+        {"io", no_argument, NULL, 'i'},
+        {"faults", no_argument, NULL, 'f'},
+        {"schedstat", no_argument, NULL, 'w'},
+        {"last-cpu", no_argument, NULL, OPT_LAST_CPU},
+        {"smaps", no_argument, NULL, 'm'},
+        {"smaps-reads", required_argument, NULL, OPT_SMAPS_READS},
+        {"events", no_argument, NULL, OPT_EVENTS},
+        {"disks", no_argument, NULL, OPT_DISKS},
+        {"net", no_argument, NULL, OPT_NET},
+        {"vmstat", no_argument, NULL, OPT_VMSTAT},
+        {"top-devices", required_argument, NULL, OPT_TOP_DEVICES},
+        {"all-devices", no_argument, NULL, OPT_ALL_DEVICES},
+        {"batch", no_argument, NULL, 'b'},
+        {"iterations", required_argument, NULL, 'n'},
+        {"psi-trigger", required_argument, NULL, OPT_PSI_TRIGGER},
+        {"sample", required_argument, NULL, OPT_SAMPLE},
+        {"sample-top", required_argument, NULL, OPT_SAMPLE_TOP},
+        {"cumulative", no_argument, NULL, OPT_CUMULATIVE},
+        {"trigger", required_argument, NULL, OPT_TRIGGER},
+        {"trigger-dir", required_argument, NULL, OPT_TRIGGER_DIR},
+        {"trigger-keep", required_argument, NULL, OPT_TRIGGER_KEEP},
+        {"trigger-cooldown", required_argument, NULL, OPT_TRIGGER_COOLDOWN},
+        {"cpu-budget", required_argument, NULL, OPT_CPU_BUDGET},
+        {"min-interval", required_argument, NULL, OPT_MIN_INTERVAL},
+        {"max-interval", required_argument, NULL, OPT_MAX_INTERVAL},
+        {"idle", no_argument, NULL, OPT_IDLE},
+        {"history-samples", required_argument, NULL, OPT_HISTORY_SAMPLES},
+        {"history-pids", required_argument, NULL, OPT_HISTORY_PIDS},
+        {"serve", required_argument, NULL, OPT_SERVE},
+        {"connect", required_argument, NULL, OPT_CONNECT},
+        {"collector", required_argument, NULL, OPT_COLLECTOR},
+        {"bench-collect", required_argument, NULL, OPT_BENCH_COLLECT},
+        {"bench-search", required_argument, NULL, OPT_BENCH_SEARCH},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+
+    opts->interval_ms = 2000; // 2 sec
+    opts->cpu_budget = 0;
+    opts->min_interval_ms = 250;
+    opts->max_interval_ms = 10000;
+    opts->sched_idle = 0;
+    opts->history_samples = HISTORY_DEFAULT_SAMPLES;
+    opts->history_pids = HISTORY_DEFAULT_PIDS;
+    opts->cgroup_path = NULL;
+    opts->group_by_cgroup = 0;
+    opts->irqs = 0;
+    opts->io_columns = 0;
+    opts->event_columns = 0;
+    opts->sched_columns = 0;
+    opts->numa_columns = 0;
+    opts->smaps_columns = 0;
+    opts->smaps_reads = SMAPS_DEFAULT_READS;
+    opts->proc_events = 0;
+    opts->sample_period = 0;
+    opts->sample_top = SAMPLING_DEFAULT_TOP;
+    opts->cumulative = 0;
+    opts->disks = 0;
+    opts->net = 0;
+    opts->vmstat = 0;
+    opts->top_devices = IOSTAT_DEFAULT_TOP;
+    opts->all_devices = 0;
+    opts->batch = 0;
+    opts->iterations = 0;
+    opts->psi_trigger_count = 0;
+    opts->trigger_count = 0;
+    opts->trigger_dir = ".";
+    opts->trigger_keep = CAPTURE_DEFAULT_KEEP;
+    opts->trigger_cooldown = CAPTURE_DEFAULT_COOLDOWN_SEC;
+    opts->serve_addr = NULL;
+    opts->connect_count = 0;
+    opts->collector = PROC_COLLECTOR_SYNC;
+    opts->collector_set = 0;
+    opts->bench_collect = 0;
+    opts->bench_search = 0;
+
+    int c;
+    while ((c = getopt_long(argc, argv, "c:gifwmbn:h", long_opts, NULL)) !=
+           -1) {
+        switch (c) {
+        case 'c':
+            opts->cgroup_path = optarg;
+            break;
+        case 'g':
+            opts->group_by_cgroup = 1;
+            break;
+        case 'i':
+            opts->io_columns = 1;
+            break;
+        case 'f':
+            opts->event_columns = 1;
+            break;
+        case 'w':
+            opts->sched_columns = 1;
+            break;
+        case OPT_LAST_CPU:
+            opts->numa_columns = 1;
+            break;
+        case 'm':
+            opts->smaps_columns = 1;
+            break;
+        case OPT_SMAPS_READS:
+            if (parse_positive(optarg, &opts->smaps_reads) != 0 ||
+                opts->smaps_reads > SMAPS_MAX_READS) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case OPT_EVENTS:
+            opts->proc_events = 1;
+            break;
+        case OPT_DISKS:
+            opts->disks = 1;
+            break;
+        case OPT_NET:
+            opts->net = 1;
+            break;
+        case OPT_VMSTAT:
+            opts->vmstat = 1;
+            break;
+        case OPT_IRQS:
+            opts->irqs = 1;
+            break;
+        case OPT_TOP_DEVICES:
+            if (parse_positive(optarg, &opts->top_devices) != 0 ||
+                opts->top_devices > IOSTAT_MAX_TOP) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case OPT_ALL_DEVICES:
+            opts->all_devices = 1;
+            break;
+        case 'b':
+            opts->batch = 1;
+            break;
+        case 'n':
+            if (parse_positive(optarg, &opts->iterations) != 0) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case OPT_PSI_TRIGGER:
+            if (opts->psi_trigger_count == PSI_MAX_TRIGGERS) {
+                fprintf(stderr, "At most %d PSI triggers are supported.\n",
+                        PSI_MAX_TRIGGERS);
+                return -1;
+            }
+            opts->psi_triggers[opts->psi_trigger_count++] = optarg;
+            break;
+        case OPT_SAMPLE:
+            if (parse_positive(optarg, &opts->sample_period) != 0) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case OPT_SAMPLE_TOP:
+            if (parse_positive(optarg, &opts->sample_top) != 0) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case OPT_CUMULATIVE:
+            opts->cumulative = 1;
+            break;
+        case OPT_TRIGGER:
+            if (opts->trigger_count == RULES_MAX) {
+                fprintf(stderr, "At most %d rules are supported.\n",
+                        RULES_MAX);
+                return -1;
+            }
+            opts->triggers[opts->trigger_count++] = optarg;
+            break;
+        case OPT_TRIGGER_DIR:
+            opts->trigger_dir = optarg;
+            break;
+        case OPT_TRIGGER_KEEP:
+            if (parse_positive(optarg, &opts->trigger_keep) != 0 ||
+                opts->trigger_keep > CAPTURE_MAX_KEEP) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case OPT_TRIGGER_COOLDOWN:
+            if (parse_count(optarg, &opts->trigger_cooldown) != 0) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case OPT_CPU_BUDGET:
+            if (parse_percent(optarg, &opts->cpu_budget) != 0) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case OPT_MIN_INTERVAL:
+            if (parse_positive(optarg, &opts->min_interval_ms) != 0) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case OPT_MAX_INTERVAL:
+            if (parse_positive(optarg, &opts->max_interval_ms) != 0) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case OPT_IDLE:
+            opts->sched_idle = 1;
+            break;
+        case OPT_HISTORY_SAMPLES:
+            if (parse_count(optarg, &opts->history_samples) != 0) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case OPT_HISTORY_PIDS:
+            if (parse_positive(optarg, &opts->history_pids) != 0) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case OPT_SERVE:
+            opts->serve_addr = optarg;
+            break;
+        case OPT_CONNECT:
+            if (opts->connect_count == CLIENT_MAX_AGENTS) {
+                fprintf(stderr, "At most %d agents are supported.\n",
+                        CLIENT_MAX_AGENTS);
+                return -1;
+            }
+            opts->connect_addrs[opts->connect_count++] = optarg;
+            break;
+        case OPT_COLLECTOR:
+            if (strcmp(optarg, "sync") == 0) {
+                opts->collector = PROC_COLLECTOR_SYNC;
+            } else if (strcmp(optarg, "io_uring") == 0) {
+                opts->collector = PROC_COLLECTOR_URING;
+            } else {
+                print_usage(argv[0]);
+                return -1;
+            }
+            opts->collector_set = 1;
+            break;
+        case OPT_BENCH_COLLECT:
+            if (parse_positive(optarg, &opts->bench_collect) != 0) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case OPT_BENCH_SEARCH:
+            if (parse_positive(optarg, &opts->bench_search) != 0) {
+                print_usage(argv[0]);
+                return -1;
+            }
+            break;
+        case 'h':
+        default:
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    // If a user wants to specify a different interval, they can do so
+    if (optind < argc) {
+        if (optind + 1 < argc ||
+            parse_positive(argv[optind], &opts->interval_ms) != 0) {
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (opts->min_interval_ms > opts->max_interval_ms) {
+        fprintf(stderr, "--min-interval must not exceed --max-interval.\n");
+        return -1;
+    }
+
+    // Triggers only make sense when frames are printed, not redrawn
+    if (opts->psi_trigger_count > 0 && !opts->batch) {
+        fprintf(stderr, "--psi-trigger requires --batch.\n");
+        return -1;
+    }
+
+    // cgroup.procs already lists exactly the processes to show
+    if (opts->proc_events && opts->cgroup_path) {
+        fprintf(stderr, "--events and --cgroup are mutually exclusive.\n");
+        return -1;
+    }
+
+    if (opts->serve_addr && opts->connect_count > 0) {
+        fprintf(stderr, "--serve and --connect are mutually exclusive.\n");
+        return -1;
+    }
+
+    // The agent serves the whole host; clients have no cgroup view
+    if (opts->serve_addr && opts->cgroup_path) {
+        fprintf(stderr, "--serve can't be combined with --cgroup.\n");
+        return -1;
+    }
+
+    // Rules are evaluated on this host, headless
+    if (opts->trigger_count > 0 && (opts->serve_addr || opts->connect_count)) {
+        fprintf(stderr, "--trigger can't be combined with --serve or "
+                        "--connect.\n");
+        return -1;
+    }
+
+    // Rules and captures cover the whole host
+    if (opts->trigger_count > 0 && opts->cgroup_path) {
+        fprintf(stderr, "--trigger can't be combined with --cgroup.\n");
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+// src/options.h
+#pragma once
+#include "core/process.h"
+#include "core/rules.h"
+#include "core/psi.h"
+#include "net/client.h"
+#include <stddef.h>
+
+/**
+ * Holds the settings given on the command line.
+ */
+typedef struct {
+    unsigned interval_ms;     // Refresh interval in milliseconds
+    double cpu_budget;        // Adaptive interval CPU budget in % (0: off)
+    unsigned min_interval_ms; // Lower bound of the adaptive interval
+    unsigned max_interval_ms; // Upper bound of the adaptive interval
+    int sched_idle;           // Run under SCHED_IDLE
+    const char *cgroup_path;  // Scope to this cgroup (NULL: whole system)
+    int group_by_cgroup;      // Start in the per-cgroup view
+    int irqs;                 // Start in the interrupt view
+    int io_columns;           // Start with the I/O columns shown
+    int event_columns;        // Start with the fault/ctxsw columns shown
+    int sched_columns;        // Start with the schedstat columns shown
+    int numa_columns;         // Start with the last CPU/node columns shown
+    int smaps_columns;        // Start with the PSS/USS/SWAP columns shown
+    unsigned smaps_reads;     // smaps_rollup reads per frame
+    int batch;                // Print frames to stdout without a UI
+    int proc_events;          // Track processes with the proc connector
+    unsigned sample_period;   // Sampling mode: read all within N frames
+    unsigned sample_top;      // Sampling mode: busiest processes always read
+    int cumulative;           // Start in cumulative mode
+    int disks;                // Start with the disk lines shown
+    int net;                  // Start with the network lines shown
+    int vmstat;               // Start with the paging line shown
+    unsigned top_devices;     // Devices shown per section
+    int all_devices;          // Include loop/RAM disks and loopback
+    unsigned iterations;      // Frames to print in batch mode (0: forever)
+    unsigned history_samples; // Samples kept per process (0: no history)
+    unsigned history_pids;    // Processes that can have a history at once
+
+    const char *psi_triggers[PSI_MAX_TRIGGERS]; // PSI trigger specs
+    size_t psi_trigger_count;                   // Entries in psi_triggers
+
+    const char *triggers[RULES_MAX]; // Capture rules (--trigger)
+    size_t trigger_count;            // Entries in triggers
+    const char *trigger_dir;         // Directory of the capture files
+    unsigned trigger_keep;           // Capture files to rotate through
+    unsigned trigger_cooldown;       // Seconds before a rule captures again
+
+    proc_collector_t collector; // How /proc/[pid] files are read
+    int collector_set;          // collector was given on the command line
+    unsigned bench_collect;     // Time this many collections and exit
+    unsigned bench_search;      // Time searching this many processes, exit
+
+    const char *serve_addr;                       // Run as an agent here
+    const char *connect_addrs[CLIENT_MAX_AGENTS]; // Agents to show
+    size_t connect_count;                         // Entries in connect_addrs
+} options_t;
+
+/**
+ * @brief Parses the command line into an options_t structure.
+ * @details Unset options keep their defaults. On error, a usage message is
+ *          printed to stderr.
+ *
+ * @param argc Argument count as passed to main().
+ * @param argv Argument vector as passed to main().
+ * @param opts Pointer to the options_t structure to populate.
+ * @return 0 on success, -1 on invalid arguments.
+ */
+int parse_options(int argc, char **argv, options_t *opts);
@@ -7,5 +7,8 @@
 // Swaps the foreground and background colors
 #define REVERSE "\033[7m"
 
+// Yellow foreground, used to highlight search matches and warnings
+#define YELLOW "\033[33m"
+
 // Resets all text formatting to the terminal default.
 #define RESET "\033[0m"
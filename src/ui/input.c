@@ -1,6 +1,7 @@
 // src/ui/input.c
 #include "input.h"
 #include <stdlib.h>
+#include <sys/select.h>
 #include <termios.h>
 #include <unistd.h>
 
@@ -24,3 +25,72 @@ void enable_raw_mode(void) {
     // Apply the new attributes immediately
     tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
 }
+
+bool wait_for_input(unsigned timeout_ms) {
+    fd_set read_fds;
+    FD_ZERO(&read_fds);
+    FD_SET(STDIN_FILENO, &read_fds);
+
+    struct timeval timeout = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000,
+    };
+
+    int ret = select(STDIN_FILENO + 1, &read_fds, NULL, NULL, &timeout);
+    if (ret < 0) {
+        return false; // Interrupted (e.g. SIGWINCH); the caller retries
+    }
+    return ret > 0;
+}
+
+int read_key(void) {
+    unsigned char c;
+    if (read(STDIN_FILENO, &c, 1) != 1) {
+        return -1;
+    }
+    if (c != '\033') {
+        return c;
+    }
+
+    // The rest of an escape sequence arrives together with the ESC
+    char seq[3];
+    if (!wait_for_input(0) || read(STDIN_FILENO, &seq[0], 1) != 1) {
+        return c;
+    }
+    if (!wait_for_input(0) || read(STDIN_FILENO, &seq[1], 1) != 1) {
+        return -1;
+    }
+    if (seq[0] != '[' && seq[0] != 'O') {
+        return -1;
+    }
+
+    switch (seq[1]) {
+    case 'A':
+        return KEY_ARROW_UP;
+    case 'B':
+        return KEY_ARROW_DOWN;
+    case 'H':
+        return KEY_HOME;
+    case 'F':
+        return KEY_END;
+    }
+
+    // "ESC [ n ~" for the paging and editing keys
+    if (seq[1] < '0' || seq[1] > '9' || !wait_for_input(0) ||
+        read(STDIN_FILENO, &seq[2], 1) != 1 || seq[2] != '~') {
+        return -1;
+    }
+    switch (seq[1]) {
+    case '1':
+    case '7':
+        return KEY_HOME;
+    case '4':
+    case '8':
+        return KEY_END;
+    case '5':
+        return KEY_PAGE_UP;
+    case '6':
+        return KEY_PAGE_DOWN;
+    }
+    return -1;
+}
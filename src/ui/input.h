@@ -1,5 +1,19 @@
 // src/ui/input.h
 #pragma once
+#include <stdbool.h>
+
+/**
+ * Keys that arrive as escape sequences, numbered past the ASCII range so
+ * read_key() can return them alongside plain characters.
+ */
+typedef enum {
+    KEY_ARROW_UP = 256,
+    KEY_ARROW_DOWN,
+    KEY_PAGE_UP,
+    KEY_PAGE_DOWN,
+    KEY_HOME,
+    KEY_END,
+} input_key_t;
 
 /**
  * @brief Enables raw mode for the terminal.
@@ -14,3 +28,20 @@ void enable_raw_mode(void);
  *          user's terminal in a broken state.
  */
 void disable_raw_mode(void);
+
+/**
+ * @brief Waits until a key is available on stdin.
+ *
+ * @param timeout_ms How long to wait at most, in milliseconds (0 to poll).
+ * @return true if input is available, false on timeout.
+ */
+bool wait_for_input(unsigned timeout_ms);
+
+/**
+ * @brief Reads a single key from stdin.
+ * @details Escape sequences for the arrow, paging, Home and End keys are
+ *          decoded into input_key_t values.
+ *
+ * @return The character or input_key_t value, or -1 if nothing was read.
+ */
+int read_key(void);
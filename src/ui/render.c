@@ -1,13 +1,24 @@
 // src/ui/render.c
 #include "render.h"
+#include "../core/history.h"
 #include "../core/sorting.h"
+#include "../util/util.h"
 #include "color.h"
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 
 // Define a max width for the command column for clearer UI output
 #define COMMAND_WIDTH 40
 
+// Deeper tree levels are drawn at this indentation
+#define TREE_MAX_INDENT 16
+
+// Samples shown by a sparkline column
+#define SPARK_COLUMN_WIDTH 12
+// Most samples shown by the history panel
+#define SPARK_PANEL_WIDTH 64
+
 static void print_mem(const mem_info_t *mem) {
     // The "buff/cache" line in 'top' is a sum of Buffers, Cached, and
     // SReclaimable, which represents memory that can be quickly freed
@@ -16,12 +27,15 @@ static void print_mem(const mem_info_t *mem) {
     unsigned long long buffcache =
         mem->buffers + mem->cached + mem->sreclaimable - mem->shmem;
     unsigned long long used = mem->mem_total - mem->mem_free - buffcache;
-    unsigned long long swap_used = mem->swap_total - mem->swap_free;
 
     printf("KiB Mem : " BOLD "%8llu" RESET " total, " BOLD "%8llu" RESET
            " free, " BOLD "%8llu" RESET " used, " BOLD "%8llu" RESET
            " buff/cache\n",
            mem->mem_total, mem->mem_free, used, buffcache);
+}
+
+static void print_swap(const mem_info_t *mem) {
+    unsigned long long swap_used = mem->swap_total - mem->swap_free;
 
     printf("KiB Swap: " BOLD "%8llu" RESET " total, " BOLD "%8llu" RESET
            " free, " BOLD "%8llu" RESET " used, " BOLD "%8llu" RESET
@@ -29,9 +43,266 @@ static void print_mem(const mem_info_t *mem) {
            mem->swap_total, mem->swap_free, swap_used, mem->mem_available);
 }
 
-void render_header(const cpu_percent_t *cpu, const mem_info_t *mem,
-                   const load_avg_t *ld, const uptime_fmt_t *up, int users,
-                   const task_counts_t *tc) {
+static void print_cgroup_mem(const cgroup_view_t *cg) {
+    // Without a limit, the cgroup can grow up to the host's memory
+    unsigned long long limit = cg->stats.mem_max;
+    unsigned long long free_kib =
+        (limit > cg->stats.mem_current) ? limit - cg->stats.mem_current : 0;
+
+    if (limit > 0) {
+        printf("KiB Mem : " BOLD "%8llu" RESET " limit, " BOLD "%8llu" RESET
+               " free, " BOLD "%8llu" RESET " used, " BOLD "%8llu" RESET
+               " file\n",
+               limit, free_kib, cg->stats.mem_current, cg->stats.mem_file);
+    } else {
+        printf("KiB Mem :      max limit,          - free, " BOLD "%8llu" RESET
+               " used, " BOLD "%8llu" RESET " file\n",
+               cg->stats.mem_current, cg->stats.mem_file);
+    }
+}
+
+static void print_psi(const psi_stats_t *psi, const psi_percent_t *now) {
+    static const char *const labels[PSI_RESOURCE_COUNT] = {"cpu", "mem",
+                                                           "io"};
+
+    printf("PSI some:");
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        if (!psi->res[r].valid) {
+            continue;
+        }
+        // avg10 / avg60 from the kernel, plus the share since the last frame
+        printf("  %s " BOLD "%5.2f" RESET " " BOLD "%5.2f" RESET " [" BOLD
+               "%5.1f%%" RESET "]",
+               labels[r], psi->res[r].some.avg10, psi->res[r].some.avg60,
+               now ? now->some[r] : 0.0);
+    }
+    printf("\n");
+}
+
+// A node with less free memory than this (in %) is highlighted
+#define NUMA_LOW_FREE_PERCENT 10.0
+
+static void print_numa(const numa_view_t *numa) {
+    for (size_t n = 0; n < numa->stats->count; n++) {
+        const numa_node_t *node = &numa->stats->nodes[n];
+        const cpu_percent_t *cpu = &numa->cpu[n];
+        double free_pct = node->mem_total > 0 ? (double)node->mem_free /
+                                                    node->mem_total * 100.0
+                                              : 0.0;
+
+        // One node can be full while the machine as a whole looks fine
+        printf("Node %-2d %3u cpus: " BOLD "%4.1f" RESET " us, " BOLD
+               "%4.1f" RESET " sy, " BOLD "%4.1f" RESET " id | KiB " BOLD
+               "%8llu" RESET " total, %s" BOLD "%8llu" RESET " free, " BOLD
+               "%8llu" RESET " file\n",
+               node->id, node->ncpus, cpu->us, cpu->sy, cpu->id,
+               node->mem_total, free_pct < NUMA_LOW_FREE_PERCENT ? YELLOW : "",
+               node->mem_free, node->mem_file);
+    }
+}
+
+static void print_events(const proc_events_t *ev) {
+    // Short-lived processes came and went without ever being listed
+    printf("Events: " BOLD "%lu" RESET " spawned (" BOLD "%lu" RESET
+           " short-lived), " BOLD "%lu" RESET " exited, " BOLD "%lu" RESET
+           " exec since last frame%s\n",
+           ev->forks, ev->short_lived, ev->exits, ev->execs,
+           ev->lost ? "  " YELLOW "(events lost, rescanning)" RESET : "");
+}
+
+// A device busier than this (in %) is highlighted
+#define DISK_BUSY_UTIL 90.0
+
+static void print_disk(const char *name, const disk_rate_t *r) {
+    printf("Disk %-12.12s r " BOLD "%7.1f" RESET " MB/s " BOLD "%6.0f" RESET
+           " io/s, w " BOLD "%7.1f" RESET " MB/s " BOLD "%6.0f" RESET
+           " io/s, %s" BOLD "%5.1f%%" RESET " util\n",
+           name, r->read_mbs, r->read_iops, r->write_mbs, r->write_iops,
+           r->util >= DISK_BUSY_UTIL ? YELLOW : "", r->util);
+}
+
+static void print_net(const char *name, const net_rate_t *r) {
+    printf("Net  %-12.12s rx " BOLD "%7.2f" RESET " MB/s " BOLD "%7.0f" RESET
+           " pk/s, tx " BOLD "%7.2f" RESET " MB/s " BOLD "%7.0f" RESET
+           " pk/s\n",
+           name, r->rx_mbs, r->rx_pps, r->tx_mbs, r->tx_pps);
+}
+
+/**
+ * Prints the busiest devices, then one line summing up the others.
+ *
+ * @return The number of lines printed.
+ */
+static unsigned print_iostat(const disk_view_t *disks, const net_view_t *net) {
+    unsigned lines = 0;
+    char name[32];
+
+    for (size_t i = 0; disks && i < disks->count; i++) {
+        print_disk(disks->top[i].name, &disks->top[i]);
+        lines++;
+    }
+    if (disks && disks->hidden > 0) {
+        // Only the busiest of the others counts for util
+        snprintf(name, sizeof(name), "+%zu more", disks->hidden);
+        print_disk(name, &disks->rest);
+        lines++;
+    }
+
+    for (size_t i = 0; net && i < net->count; i++) {
+        print_net(net->top[i].name, &net->top[i]);
+        lines++;
+    }
+    if (net && net->hidden > 0) {
+        snprintf(name, sizeof(name), "+%zu more", net->hidden);
+        print_net(name, &net->rest);
+        lines++;
+    }
+    return lines;
+}
+
+/**
+ * Formats a /proc/vmstat rate, highlighted if 'warn' and non-zero.
+ */
+static void fmt_vm_rate(double rate, int warn, char *buf, size_t size) {
+    snprintf(buf, size, "%s%.0f" RESET, warn && rate >= 0.5 ? YELLOW : BOLD,
+             rate);
+}
+
+static void print_vmstat(const vmstat_rate_t *vm) {
+    // Direct reclaim and swap-in stall the processes themselves
+    char majf[32], in[32], out[32], ks[32], kr[32], ds[32], dr[32], as[32];
+    fmt_vm_rate(vm->pgmajfault, 0, majf, sizeof(majf));
+    fmt_vm_rate(vm->pswpin, 1, in, sizeof(in));
+    fmt_vm_rate(vm->pswpout, 0, out, sizeof(out));
+    fmt_vm_rate(vm->pgscan_kswapd, 0, ks, sizeof(ks));
+    fmt_vm_rate(vm->pgsteal_kswapd, 0, kr, sizeof(kr));
+    fmt_vm_rate(vm->pgscan_direct, 1, ds, sizeof(ds));
+    fmt_vm_rate(vm->pgsteal_direct, 1, dr, sizeof(dr));
+    fmt_vm_rate(vm->allocstall, 1, as, sizeof(as));
+
+    printf("Paging/s: %s majflt, swap %s in %s out, kswapd %s scan %s steal, "
+           "direct %s scan %s steal, %s allocstall",
+           majf, in, out, ks, kr, ds, dr, as);
+    if (vm->oom_kill > 0) {
+        printf(", " YELLOW "%llu OOM kills" RESET, vm->oom_kill);
+    }
+    printf("\n");
+}
+
+static void print_refresh(const refresh_t *r) {
+    printf("Refresh: " BOLD "%u" RESET " ms (budget " BOLD "%.1f%%" RESET
+           ", %u-%u ms), toplite CPU: " BOLD "%.1f%%" RESET "\n",
+           r->interval_ms, r->budget, r->min_ms, r->max_ms, r->overhead);
+}
+
+static void print_sampling(const proc_sampling_t *s) {
+    printf("Sampling: " BOLD "%zu" RESET " read, " BOLD "%zu" RESET
+           " carried over (up to " BOLD "%.1f" RESET
+           " s old), all read within %u frames\n",
+           s->read, s->carried, s->oldest, s->period);
+}
+
+/**
+ * Formats a rate with a binary unit suffix so it fits in a few characters
+ * (e.g. 1536 -> "1.5K").
+ */
+static void fmt_scaled(double value, char *buf, size_t size) {
+    static const char units[] = {' ', 'K', 'M', 'G', 'T'};
+    size_t unit = 0;
+    while (value >= 1024.0 && unit < sizeof(units) - 1) {
+        value /= 1024.0;
+        unit++;
+    }
+
+    if (unit == 0) {
+        snprintf(buf, size, "%.0f", value);
+    } else {
+        snprintf(buf, size, "%.1f%c", value, units[unit]);
+    }
+}
+
+/**
+ * Formats clock ticks as CPU time like TIME+ (e.g. "12:34.56").
+ */
+static void fmt_ticks(unsigned long long ticks, char *buf, size_t size) {
+    long hz = sys_hz();
+    unsigned long long secs = ticks / hz;
+    snprintf(buf, size, "%llu:%02llu.%02llu", secs / 60, secs % 60,
+             (ticks % hz) * 100 / hz);
+}
+
+static void print_totals(const proc_cumulative_t *c) {
+    char since[16], cpu[32], rd[16], wr[16], flt[16];
+    struct tm tm;
+    localtime_r(&c->since, &tm);
+    strftime(since, sizeof(since), "%H:%M:%S", &tm);
+    fmt_ticks(c->sum.cpu_ticks, cpu, sizeof(cpu));
+    fmt_scaled((double)c->sum.read_bytes, rd, sizeof(rd));
+    fmt_scaled((double)c->sum.write_bytes, wr, sizeof(wr));
+    fmt_scaled((double)c->sum.majflt, flt, sizeof(flt));
+
+    printf("Totals since %s: CPU " BOLD "%s" RESET ", read " BOLD "%s" RESET
+           ", written " BOLD "%s" RESET ", major faults " BOLD "%s" RESET
+           "; " BOLD "%zu" RESET " exited shown, " BOLD "%zu" RESET
+           " folded\n",
+           since, cpu, rd, wr, flt, c->exited, c->folded);
+}
+
+// CPUs listed in the interrupt summary line
+#define IRQ_SUMMARY_CPUS 4
+
+static double irq_cpu_load(const irq_view_t *v, size_t cpu) {
+    return v->cpu_hard[cpu] + v->cpu_soft[cpu];
+}
+
+/**
+ * Prints the interrupt totals and the CPUs that handle the most of them.
+ */
+static void print_irqs(const irq_view_t *v) {
+    char hard[16], soft[16];
+    fmt_scaled(v->hard, hard, sizeof(hard));
+    fmt_scaled(v->soft, soft, sizeof(soft));
+    printf("Interrupts/s: " BOLD "%s" RESET " hard, " BOLD "%s" RESET " soft",
+           hard, soft);
+
+    // Busiest CPUs by hard + soft interrupts, without sorting them all
+    size_t top[IRQ_SUMMARY_CPUS];
+    size_t ntop = 0;
+    for (size_t cpu = 0; cpu < v->ncpus; cpu++) {
+        double load = irq_cpu_load(v, cpu);
+        size_t slot = ntop;
+        while (slot > 0 && irq_cpu_load(v, top[slot - 1]) < load) {
+            slot--;
+        }
+        if (load <= 0 || slot == IRQ_SUMMARY_CPUS) {
+            continue;
+        }
+        size_t last = ntop < IRQ_SUMMARY_CPUS ? ntop : IRQ_SUMMARY_CPUS - 1;
+        memmove(&top[slot + 1], &top[slot], (last - slot) * sizeof(top[0]));
+        top[slot] = cpu;
+        if (ntop < IRQ_SUMMARY_CPUS) {
+            ntop++;
+        }
+    }
+
+    printf("; busiest CPUs:");
+    for (size_t i = 0; i < ntop; i++) {
+        fmt_scaled(v->cpu_hard[top[i]], hard, sizeof(hard));
+        fmt_scaled(v->cpu_soft[top[i]], soft, sizeof(soft));
+        printf(" " BOLD "cpu%zu" RESET " (%s hard, %s soft)", top[i], hard,
+               soft);
+    }
+    printf("%s\n", ntop == 0 ? " none" : "");
+}
+
+unsigned render_header(const header_data_t *h) {
+    const cpu_percent_t *cpu = h->cpu;
+    const mem_info_t *mem = h->mem;
+    const load_avg_t *ld = h->ld;
+    const uptime_fmt_t *up = h->up;
+    const task_counts_t *tc = h->tc;
+    const cgroup_view_t *cg = h->cg;
+    unsigned lines = 0;
     char tbuf[32] = {0};
     time_t t = time(NULL);
     struct tm localtime;
@@ -45,93 +316,741 @@ void render_header(const cpu_percent_t *cpu, const mem_info_t *mem,
     printf(BOLD "%u:%02u" RESET ",  " BOLD "%d" RESET
                 " users,  load average: " BOLD "%.2f" RESET ", " BOLD
                 "%.2f" RESET ", " BOLD "%.2f" RESET "\n",
-           up->hours, up->minutes, users, ld->load1, ld->load5, ld->load15);
+           up->hours, up->minutes, h->users, ld->load1, ld->load5, ld->load15);
+    lines++;
+
+    if (cg) {
+        printf("Cgroup: " BOLD "%s" RESET " (" BOLD "%zu" RESET " procs)\n",
+               cg->path, cg->nprocs);
+        lines++;
+    }
 
     // line 2: tasks
     printf("Tasks: " BOLD "%u" RESET " total,   " BOLD "%u" RESET
            " running, " BOLD "%u" RESET " sleeping, " BOLD "%u" RESET
            " stopped, " BOLD "%u" RESET " zombie\n",
            tc->total, tc->running, tc->sleeping, tc->stopped, tc->zombie);
+    lines++;
 
     // line 3: CPU
-    printf("%%Cpu(s): " BOLD "%4.1f" RESET " us, " BOLD "%4.1f" RESET
-           " sy, " BOLD "%4.1f" RESET " ni, " BOLD "%4.1f" RESET " id, " BOLD
-           "%4.1f" RESET " wa, " BOLD "%4.1f" RESET " hi, " BOLD "%4.1f" RESET
-           " si, " BOLD "%4.1f" RESET " st\n",
-           cpu->us, cpu->sy, cpu->ni, cpu->id, cpu->wa, cpu->hi, cpu->si,
-           cpu->st);
+    if (cg && cg->stats.has_cpu) {
+        // The cgroup's own cpu.stat, normalized to the whole machine
+        printf("%%Cpu(cg): " BOLD "%4.1f" RESET " us, " BOLD "%4.1f" RESET
+               " sy, " BOLD "%5.2f" RESET " cpus busy\n",
+               cg->cpu.us, cg->cpu.sy, cg->cpu.cpus);
+    } else {
+        printf("%%Cpu(s): " BOLD "%4.1f" RESET " us, " BOLD "%4.1f" RESET
+               " sy, " BOLD "%4.1f" RESET " ni, " BOLD "%4.1f" RESET
+               " id, " BOLD "%4.1f" RESET " wa, " BOLD "%4.1f" RESET
+               " hi, " BOLD "%4.1f" RESET " si, " BOLD "%4.1f" RESET " st\n",
+               cpu->us, cpu->sy, cpu->ni, cpu->id, cpu->wa, cpu->hi, cpu->si,
+               cpu->st);
+    }
+    lines++;
 
-    print_mem(mem);
-}
+    if (cg && cg->stats.has_mem) {
+        print_cgroup_mem(cg);
+    } else {
+        print_mem(mem);
+    }
+    print_swap(mem);
+    lines += 2;
 
-void render_process_list(const proc_list_t *list, long hz,
-                         unsigned int max_rows, unsigned int term_cols) {
-    if (!list || hz <= 0 || max_rows == 0) {
-        return;
+    if (h->numa) {
+        print_numa(h->numa);
+        lines += (unsigned)h->numa->stats->count;
     }
 
-    // A correct mapping for visual columns to sort type
-    const sort_by_t column_map[] = {
-        SORT_BY_PID,    // Col 0: PID
-        SORT_BY_NONE,   // Col 1: USER
-        SORT_BY_NONE,   // Col 2: PR
-        SORT_BY_NONE,   // Col 3: NI
-        SORT_BY_NONE,   // Col 4: VIRT
-        SORT_BY_NONE,   // Col 5: RES
-        SORT_BY_NONE,   // Col 6: SHR
-        SORT_BY_NONE,   // Col 7: S
-        SORT_BY_CPU,    // Col 8: %CPU
-        SORT_BY_MEM,    // Col 9: %MEM
-        SORT_BY_TIME,   // Col 10: TIME+
-        SORT_BY_COMMAND // Col 11: COMMAND
-    };
+    if (h->psi) {
+        print_psi(h->psi, h->psi_now);
+        lines++;
+    }
 
-    // Build and print the styled, highlighted header
-    sort_by_t current_sort = sorting_get_current_column();
-    char header_buf[512] = {0};
-    int offset = 0;
+    if (h->vm) {
+        print_vmstat(h->vm);
+        lines++;
+    }
+
+    if (h->events) {
+        print_events(h->events);
+        lines++;
+    }
+
+    lines += print_iostat(h->disks, h->net);
+
+    if (h->irqs) {
+        print_irqs(h->irqs);
+        lines++;
+    }
+
+    if (h->refresh) {
+        print_refresh(h->refresh);
+        lines++;
+    }
+
+    if (h->sample) {
+        print_sampling(h->sample);
+        lines++;
+    }
 
-    // An array of column names and their widths
-    const char *cols[] = {"PID", "USER", "PR",   "NI",   "VIRT",  "RES",
-                          "SHR", "S",    "%CPU", "%MEM", "TIME+", "COMMAND"};
-    const int widths[] = {5, -8, 3, 3, 8, 8, 8, 1, 5, 5, 9, -COMMAND_WIDTH};
+    if (h->totals) {
+        print_totals(h->totals);
+        lines++;
+    }
+
+    if (h->search) {
+        printf("Search: " BOLD "%s" RESET "%s (" BOLD "%zu" RESET
+               " matches)\n",
+               h->search, h->search_editing ? "_" : "", h->search_matches);
+        lines++;
+    }
+
+    return lines;
+}
+
+/**
+ * Describes one column of a list.
+ */
+typedef struct {
+    const char *name; // Header text
+    int width;        // printf width (negative: left-aligned)
+    sort_by_t sort;   // Sort key of the column (SORT_BY_NONE if none)
+} column_t;
+
+/**
+ * Prints a styled column header, highlighting the current sort column.
+ *
+ * @param cols The columns to print.
+ * @param ncols Number of columns.
+ * @param term_cols The number of columns available in the terminal.
+ */
+static void print_column_header(const column_t cols[], int ncols,
+                                unsigned int term_cols) {
+    sort_by_t current_sort = sorting_get_current_column();
+    char header_buf[1024] = {0};
+    size_t offset = 0;
 
     // Print the header with appropriate styles
-    for (int i = 0; i < (int)(sizeof(cols) / sizeof(cols[0])); i++) {
+    for (int i = 0; i < ncols && offset < sizeof(header_buf); i++) {
         const char *style = BOLD;
 
         // Highlight if the column is sortable AND it's the current sort
-        if (column_map[i] != SORT_BY_NONE && column_map[i] == current_sort) {
+        if (cols[i].sort != SORT_BY_NONE && cols[i].sort == current_sort) {
             style = BOLD REVERSE;
         }
 
         offset += snprintf(header_buf + offset, sizeof(header_buf) - offset,
-                           "%s%*s" RESET, style, widths[i], cols[i]);
-        if (i < 11) {
-            offset +=
-                snprintf(header_buf + offset, sizeof(header_buf) - offset, " ");
-        }
+                           "%s%*s" RESET "%s", style, cols[i].width,
+                           cols[i].name, (i < ncols - 1) ? " " : "");
     }
 
     // Print the full header, padded to the screen width
     printf("%-*s\n", term_cols, header_buf);
+}
+
+// Optional column groups currently shown (column_group_t bits)
+static unsigned g_column_groups = 0;
+
+// Columns always shown before the optional ones
+static const column_t g_base_cols[] = {
+    {"PID", 5, SORT_BY_PID},   {"USER", -8, SORT_BY_NONE},
+    {"PR", 3, SORT_BY_NONE},   {"NI", 3, SORT_BY_NONE},
+    {"VIRT", 8, SORT_BY_NONE}, {"RES", 8, SORT_BY_NONE},
+    {"SHR", 8, SORT_BY_NONE},  {"S", 1, SORT_BY_NONE},
+    {"%CPU", 5, SORT_BY_CPU},  {"%MEM", 5, SORT_BY_MEM},
+    {"TIME+", 9, SORT_BY_TIME},
+};
+
+static const column_t g_command_col = {"COMMAND", -COMMAND_WIDTH,
+                                       SORT_BY_COMMAND};
+
+static const column_t g_io_cols[] = {
+    {"READ/s", 7, SORT_BY_IO_READ},
+    {"WRITE/s", 7, SORT_BY_IO_WRITE},
+    {"RDOP/s", 6, SORT_BY_NONE},
+    {"WROP/s", 6, SORT_BY_NONE},
+};
+
+static void print_io_cells(const proc_info_t *p) {
+    if (!p->io_valid) {
+        // Not readable (other user's process) or no previous sample yet
+        printf("%7s %7s %6s %6s ", "-", "-", "-", "-");
+        return;
+    }
+
+    char rd[16], wr[16], rop[16], wop[16];
+    fmt_scaled(p->io_read_rate, rd, sizeof(rd));
+    fmt_scaled(p->io_write_rate, wr, sizeof(wr));
+    fmt_scaled(p->io_syscr_rate, rop, sizeof(rop));
+    fmt_scaled(p->io_syscw_rate, wop, sizeof(wop));
+    printf("%7s %7s %6s %6s ", rd, wr, rop, wop);
+}
+
+static const column_t g_event_cols[] = {
+    {"MINF/s", 6, SORT_BY_MINFLT},
+    {"MAJF/s", 6, SORT_BY_MAJFLT},
+    {"VCSW/s", 6, SORT_BY_VCSW},
+    {"ICSW/s", 6, SORT_BY_IVCSW},
+};
+
+static void print_event_cells(const proc_info_t *p) {
+    char minf[16], majf[16], vcsw[16] = "-", ivcsw[16] = "-";
+    fmt_scaled(p->minflt_rate, minf, sizeof(minf));
+    fmt_scaled(p->majflt_rate, majf, sizeof(majf));
+    if (p->ctxsw_valid) {
+        // Not readable (other user's process) or no previous sample yet
+        fmt_scaled(p->vcsw_rate, vcsw, sizeof(vcsw));
+        fmt_scaled(p->ivcsw_rate, ivcsw, sizeof(ivcsw));
+    }
+    printf("%6s %6s %6s %6s ", minf, majf, vcsw, ivcsw);
+}
+
+static const column_t g_sched_cols[] = {
+    {"RUN%", 5, SORT_BY_SCHED_RUN},
+    {"WAIT%", 5, SORT_BY_SCHED_WAIT},
+    {"SLC/s", 6, SORT_BY_NONE},
+};
 
-    // Cut output if it exceeds the terminal size
-    size_t render_count = list->count > max_rows ? max_rows : list->count;
-    for (size_t i = 0; i < render_count; i++) {
-        const proc_info_t *p = &list->procs[i];
-
-        // Format TIME+ from clock ticks to MM:SS.ss
-        unsigned long long total_seconds = p->uptime_ticks / hz;
-        unsigned long minutes = total_seconds / 60;
-        char time_str[16] = {0};
-        snprintf(time_str, sizeof(time_str), "%lu:%02llu.%02llu", minutes,
-                 total_seconds % 60, (p->uptime_ticks % hz) * 100 / hz);
-
-        printf("%5d %-8.8s %3.3s %3ld %8lu %8lu %8lu %c %5.1f %5.1f %9s "
-               "%-.*s\n",
-               p->pid, p->user, p->priority, p->nice, p->virt_mem, p->res_mem,
-               p->shr_mem, p->state, p->cpu_percent, p->mem_percent, time_str,
-               COMMAND_WIDTH, p->command);
+static void print_sched_cells(const proc_info_t *p) {
+    if (!p->sched_valid) {
+        printf("%5s %5s %6s ", "-", "-", "-");
+        return;
+    }
+
+    char slices[16];
+    fmt_scaled(p->sched_slice_rate, slices, sizeof(slices));
+    printf("%5.1f %5.1f %6s ", p->sched_run_percent, p->sched_wait_percent,
+           slices);
+}
+
+static const column_t g_numa_cols[] = {
+    {"CPU", 4, SORT_BY_NONE},
+    {"NODE", 4, SORT_BY_NONE},
+};
+
+static void print_numa_cells(const proc_info_t *p) {
+    int node = numa_cpu_node(p->last_cpu);
+    if (node < 0) {
+        printf("%4d %4s ", p->last_cpu, "-");
+    } else {
+        printf("%4d %4d ", p->last_cpu, node);
+    }
+}
+
+/**
+ * Formats an age in seconds with a single unit (e.g. "42s", "5m", "2h").
+ */
+static void fmt_age(double secs, char *buf, size_t size) {
+    if (secs < 60) {
+        snprintf(buf, size, "%.0fs", secs);
+    } else if (secs < 3600) {
+        snprintf(buf, size, "%.0fm", secs / 60);
+    } else {
+        snprintf(buf, size, "%.0fh", secs / 3600);
+    }
+}
+
+static const column_t g_smaps_cols[] = {
+    {"PSS", 8, SORT_BY_PSS},
+    {"USS", 8, SORT_BY_NONE},
+    {"SWAP", 8, SORT_BY_NONE},
+    {"AGE", 4, SORT_BY_NONE},
+};
+
+static void print_smaps_cells(const proc_info_t *p) {
+    if (p->smaps_time == 0) {
+        // Not read yet; the budgeted refresh gets to it in a later frame
+        printf("%8s %8s %8s %4s ", "-", "-", "-", "-");
+        return;
+    }
+
+    // Values are as old as the last smaps_rollup read, shown in AGE
+    char age[16];
+    fmt_age(monotonic_seconds() - p->smaps_time, age, sizeof(age));
+    if (!p->smaps_valid) {
+        // Not readable (other user's process)
+        printf("%8s %8s %8s %4s ", "-", "-", "-", age);
+        return;
+    }
+    printf("%8lu %8lu %8lu %4s ", p->pss_mem, p->uss_mem, p->swap_mem, age);
+}
+
+/**
+ * Draws values as a sparkline of Unicode block characters, scaled so that
+ * lo is the lowest and hi the highest block. Missing values (< 0) are drawn
+ * as spaces, and the line is left-padded to 'width' cells.
+ */
+static void format_sparkline(const float *values, size_t n, float lo, float hi,
+                             size_t width, char *buf, size_t size) {
+    static const char *const blocks[] = {"\u2581", "\u2582", "\u2583",
+                                         "\u2584", "\u2585", "\u2586",
+                                         "\u2587", "\u2588"};
+    size_t len = 0;
+    buf[0] = '\0';
+    for (size_t i = n; i < width && len + 1 < size; i++) {
+        buf[len++] = ' ';
+    }
+    for (size_t i = 0; i < n && len + 4 < size; i++) {
+        if (values[i] < 0) {
+            buf[len++] = ' ';
+            continue;
+        }
+        int level = 0;
+        if (hi > lo) {
+            level = (int)((values[i] - lo) / (hi - lo) * 7.0f + 0.5f);
+            level = level < 0 ? 0 : (level > 7 ? 7 : level);
+        }
+        memcpy(buf + len, blocks[level], 3); // Every block is 3 bytes
+        len += 3;
+    }
+    buf[len] = '\0';
+}
+
+/**
+ * Extracts one value of each sample and finds its range.
+ */
+static void history_values(const history_sample_t *samples, size_t n,
+                           int field, float *values, float *lo, float *hi) {
+    *lo = 0;
+    *hi = 0;
+    int first = 1;
+    for (size_t i = 0; i < n; i++) {
+        float v = field == 0   ? samples[i].cpu
+                  : field == 1 ? (float)samples[i].res_kib
+                               : samples[i].io;
+        values[i] = v;
+        if (v < 0) {
+            continue;
+        }
+        if (first || v < *lo) {
+            *lo = v;
+        }
+        if (first || v > *hi) {
+            *hi = v;
+        }
+        first = 0;
+    }
+}
+
+static const column_t g_stale_cols[] = {
+    {"STALE", 5, SORT_BY_NONE},
+};
+
+static void print_stale_cells(const proc_info_t *p) {
+    // Read in this collection: nothing to flag
+    char age[16] = "-";
+    if (p->stale) {
+        fmt_age(monotonic_seconds() - p->sample_time, age, sizeof(age));
+    }
+    printf("%5s ", age);
+}
+
+static const column_t g_totals_cols[] = {
+    {"TCPU", 9, SORT_BY_TOTAL_CPU},
+    {"TREAD", 7, SORT_BY_TOTAL_READ},
+    {"TWRITE", 7, SORT_BY_TOTAL_WRITE},
+    {"TMINF", 6, SORT_BY_TOTAL_MINFLT},
+    {"TMAJF", 6, SORT_BY_TOTAL_MAJFLT},
+};
+
+static void print_totals_cells(const proc_info_t *p) {
+    const proc_totals_t *t = &p->totals;
+    char cpu[32], rd[16], wr[16], minf[16], majf[16];
+    fmt_ticks(t->cpu_ticks, cpu, sizeof(cpu));
+    fmt_scaled((double)t->read_bytes, rd, sizeof(rd));
+    fmt_scaled((double)t->write_bytes, wr, sizeof(wr));
+    fmt_scaled((double)t->minflt, minf, sizeof(minf));
+    fmt_scaled((double)t->majflt, majf, sizeof(majf));
+    printf("%9s %7s %7s %6s %6s ", cpu, rd, wr, minf, majf);
+}
+
+static const column_t g_history_cols[] = {
+    {"%CPU~", SPARK_COLUMN_WIDTH, SORT_BY_NONE},
+    {"RES~", SPARK_COLUMN_WIDTH, SORT_BY_NONE},
+};
+
+static void print_history_cells(const proc_info_t *p) {
+    history_sample_t samples[SPARK_COLUMN_WIDTH];
+    size_t n = history_read(p->history, samples, SPARK_COLUMN_WIDTH);
+    float values[SPARK_COLUMN_WIDTH], lo, hi;
+    char line[SPARK_COLUMN_WIDTH * 3 + 1];
+
+    // %CPU from zero so an idle process stays flat; at least 1% full scale
+    history_values(samples, n, 0, values, &lo, &hi);
+    format_sparkline(values, n, 0, hi > 1.0f ? hi : 1.0f, SPARK_COLUMN_WIDTH,
+                     line, sizeof(line));
+    printf("%s ", line);
+
+    // RES between its own minimum and maximum, so growth stands out
+    history_values(samples, n, 1, values, &lo, &hi);
+    format_sparkline(values, n, lo, hi, SPARK_COLUMN_WIDTH, line,
+                     sizeof(line));
+    printf("%s ", line);
+}
+
+/**
+ * A group of optional columns that is shown or hidden as a whole.
+ */
+typedef struct {
+    column_group_t group;                      // Bit in g_column_groups
+    const column_t *cols;                      // Header of the columns
+    int ncols;                                 // Number of columns
+    void (*print_cells)(const proc_info_t *p); // Prints the row's cells
+} column_group_def_t;
+
+// Optional column groups, in display order (between TIME+ and COMMAND)
+static const column_group_def_t g_column_group_defs[] = {
+    {COLUMNS_IO, g_io_cols, (int)(sizeof(g_io_cols) / sizeof(g_io_cols[0])),
+     print_io_cells},
+    {COLUMNS_EVENTS, g_event_cols,
+     (int)(sizeof(g_event_cols) / sizeof(g_event_cols[0])), print_event_cells},
+    {COLUMNS_SCHED, g_sched_cols,
+     (int)(sizeof(g_sched_cols) / sizeof(g_sched_cols[0])), print_sched_cells},
+    {COLUMNS_NUMA, g_numa_cols,
+     (int)(sizeof(g_numa_cols) / sizeof(g_numa_cols[0])), print_numa_cells},
+    {COLUMNS_SMAPS, g_smaps_cols,
+     (int)(sizeof(g_smaps_cols) / sizeof(g_smaps_cols[0])), print_smaps_cells},
+    {COLUMNS_STALE, g_stale_cols,
+     (int)(sizeof(g_stale_cols) / sizeof(g_stale_cols[0])), print_stale_cells},
+    {COLUMNS_TOTALS, g_totals_cols,
+     (int)(sizeof(g_totals_cols) / sizeof(g_totals_cols[0])),
+     print_totals_cells},
+    {COLUMNS_HISTORY, g_history_cols,
+     (int)(sizeof(g_history_cols) / sizeof(g_history_cols[0])),
+     print_history_cells},
+};
+
+#define COLUMN_GROUP_DEF_COUNT                                                 \
+    (sizeof(g_column_group_defs) / sizeof(g_column_group_defs[0]))
+
+void render_toggle_columns(column_group_t group) { g_column_groups ^= group; }
+
+// Search matches, indexed like the process list (NULL: no search)
+static const unsigned char *g_matches = NULL;
+
+void render_set_matches(const unsigned char *matches) { g_matches = matches; }
+
+unsigned render_get_columns(void) { return g_column_groups; }
+
+bool render_sort_column_shown(sort_by_t column) {
+    for (size_t i = 0; i < sizeof(g_base_cols) / sizeof(g_base_cols[0]); i++) {
+        if (g_base_cols[i].sort == column) {
+            return true;
+        }
+    }
+    if (g_command_col.sort == column) {
+        return true;
+    }
+    for (size_t g = 0; g < COLUMN_GROUP_DEF_COUNT; g++) {
+        const column_group_def_t *def = &g_column_group_defs[g];
+        if (!(g_column_groups & def->group)) {
+            continue;
+        }
+        for (int i = 0; i < def->ncols; i++) {
+            if (def->cols[i].sort == column) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Prints the header of the process list, including the optional columns.
+ */
+static void print_process_header(unsigned int term_cols) {
+    column_t cols[64];
+    int ncols = 0;
+
+    for (size_t i = 0; i < sizeof(g_base_cols) / sizeof(g_base_cols[0]); i++) {
+        cols[ncols++] = g_base_cols[i];
+    }
+    for (size_t g = 0; g < COLUMN_GROUP_DEF_COUNT; g++) {
+        const column_group_def_t *def = &g_column_group_defs[g];
+        if (!(g_column_groups & def->group)) {
+            continue;
+        }
+        for (int i = 0; i < def->ncols; i++) {
+            cols[ncols++] = def->cols[i];
+        }
+    }
+    cols[ncols++] = g_command_col;
+
+    print_column_header(cols, ncols, term_cols);
+}
+
+/**
+ * Prints a single process row.
+ *
+ * @param p The process to print.
+ * @param hz The system clock frequency in Hertz.
+ * @param prefix Printed in front of the command (e.g. tree indentation).
+ */
+static void print_process_row(const proc_info_t *p, long hz,
+                              const char *prefix) {
+    // Format TIME+ from clock ticks to MM:SS.ss
+    unsigned long long total_seconds = p->uptime_ticks / hz;
+    unsigned long minutes = total_seconds / 60;
+    char time_str[16] = {0};
+    snprintf(time_str, sizeof(time_str), "%lu:%02llu.%02llu", minutes,
+             total_seconds % 60, (p->uptime_ticks % hz) * 100 / hz);
+
+    printf("%5d %-8.8s %3.3s %3ld %8lu %8lu %8lu %c %5.1f %5.1f %9s ", p->pid,
+           p->user, p->priority, p->nice, p->virt_mem, p->res_mem, p->shr_mem,
+           p->state, p->cpu_percent, p->mem_percent, time_str);
+
+    for (size_t g = 0; g < COLUMN_GROUP_DEF_COUNT; g++) {
+        if (g_column_groups & g_column_group_defs[g].group) {
+            g_column_group_defs[g].print_cells(p);
+        }
+    }
+
+    printf("%s%-.*s\n", prefix, COMMAND_WIDTH, p->command);
+}
+
+unsigned render_history_panel(const proc_info_t *p) {
+    size_t n_max = history_length();
+    if (n_max == 0) {
+        printf("History is disabled (--history-samples 0)\n");
+        return 1;
+    }
+    if (n_max > SPARK_PANEL_WIDTH) {
+        n_max = SPARK_PANEL_WIDTH;
+    }
+
+    history_sample_t samples[SPARK_PANEL_WIDTH];
+    float values[SPARK_PANEL_WIDTH];
+    char line[SPARK_PANEL_WIDTH * 3 + 1];
+    size_t n = history_read(p->history, samples, n_max);
+
+    printf("History of " BOLD "%d" RESET " (%.*s): last " BOLD "%zu" RESET
+           " samples, oldest first\n",
+           p->pid, COMMAND_WIDTH, p->command, n);
+
+    static const char *const labels[] = {"%CPU", "RES ", "I/O "};
+    for (int field = 0; field < 3; field++) {
+        float lo, hi;
+        history_values(samples, n, field, values, &lo, &hi);
+
+        double sum = 0;
+        size_t known = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (values[i] >= 0) {
+                sum += values[i];
+                known++;
+            }
+        }
+        if (known == 0) {
+            printf("  %s  -\n", labels[field]);
+            continue;
+        }
+
+        format_sparkline(values, n, field == 1 ? lo : 0, hi, n_max, line,
+                         sizeof(line));
+        char s_lo[16], s_avg[16], s_hi[16];
+        if (field == 0) {
+            snprintf(s_lo, sizeof(s_lo), "%.1f", lo);
+            snprintf(s_avg, sizeof(s_avg), "%.1f", sum / known);
+            snprintf(s_hi, sizeof(s_hi), "%.1f", hi);
+        } else {
+            // RES is in KiB, I/O in bytes per second
+            double unit = field == 1 ? 1024.0 : 1.0;
+            fmt_scaled(lo * unit, s_lo, sizeof(s_lo));
+            fmt_scaled(sum / known * unit, s_avg, sizeof(s_avg));
+            fmt_scaled(hi * unit, s_hi, sizeof(s_hi));
+        }
+        printf("  %s  %s  min " BOLD "%s" RESET "  avg " BOLD "%s" RESET
+               "  max " BOLD "%s" RESET "\n",
+               labels[field], line, s_lo, s_avg, s_hi);
+    }
+    return 4;
+}
+
+/**
+ * Starts the highlighting of a row, reset with RESET after the row.
+ */
+static void print_row_style(int selected, int matched) {
+    if (selected) {
+        printf(REVERSE);
+    }
+    if (matched) {
+        printf(BOLD YELLOW);
+    }
+}
+
+void render_process_list(const proc_list_t *list, long hz,
+                         const viewport_t *vp, unsigned int term_cols) {
+    if (!list || hz <= 0 || vp->rows == 0) {
+        return;
+    }
+
+    print_process_header(term_cols);
+
+    // Only the rows inside the window are formatted
+    size_t end = list->count;
+    if (vp->first < end && end - vp->first > vp->rows) {
+        end = vp->first + vp->rows;
+    }
+    for (size_t i = vp->first; i < end; i++) {
+        print_row_style(i == vp->cursor, g_matches && g_matches[i]);
+        print_process_row(&list->procs[i], hz, "");
+        printf(RESET);
+    }
+}
+
+/**
+ * Prints a single cgroup row.
+ *
+ * @param g The group to print.
+ * @param hz The system clock frequency in Hertz.
+ * @param selected Non-zero to highlight the row.
+ */
+static void print_group_row(const cgroup_group_t *g, long hz, int selected) {
+    unsigned long long total_seconds = g->cpu_ticks / hz;
+    char time_str[32] = {0};
+    snprintf(time_str, sizeof(time_str), "%llu:%02llu.%02llu",
+             total_seconds / 60, total_seconds % 60,
+             (g->cpu_ticks % hz) * 100 / hz);
+
+    // '+' / '-' tells whether the group can be expanded or collapsed
+    printf("%s%5u %6lu %6.1f %9lu %5.1f %10s %c %-.*s" RESET "\n",
+           selected ? REVERSE : "", g->nprocs, g->ntasks, g->cpu_percent,
+           g->res_mem, g->mem_percent, time_str, g->expanded ? '-' : '+',
+           COMMAND_WIDTH, g->cgroup);
+}
+
+void render_group_list(const group_list_t *groups, const proc_list_t *list,
+                       long hz, const viewport_t *vp, unsigned int term_cols) {
+    if (!groups || !list || hz <= 0 || vp->rows == 0) {
+        return;
+    }
+
+    static const column_t cols[] = {
+        {"PROCS", 5, SORT_BY_PID},  {"TASKS", 6, SORT_BY_NONE},
+        {"%CPU", 6, SORT_BY_CPU},   {"RES", 9, SORT_BY_MEM},
+        {"%MEM", 5, SORT_BY_NONE},  {"TIME+", 10, SORT_BY_TIME},
+        {"CGROUP", -COMMAND_WIDTH, SORT_BY_COMMAND},
+    };
+    print_column_header(cols, (int)(sizeof(cols) / sizeof(cols[0])),
+                        term_cols);
+
+    // Rows above the window are counted but not formatted
+    size_t row = 0, end = vp->first + vp->rows;
+    for (size_t i = 0; i < groups->count && row < end; i++) {
+        const cgroup_group_t *g = &groups->groups[i];
+        if (row++ >= vp->first) {
+            print_group_row(g, hz, i == vp->cursor);
+        }
+        if (!g->expanded) {
+            continue;
+        }
+        if (row + g->nprocs <= vp->first) {
+            row += g->nprocs; // All members are above the window
+            continue;
+        }
+
+        // The process list is already sorted, so members come out in order
+        for (size_t j = 0; j < list->count && row < end; j++) {
+            const proc_info_t *p = &list->procs[j];
+            if (p->cgroup && strcmp(p->cgroup, g->cgroup) == 0 &&
+                row++ >= vp->first) {
+                print_process_row(p, hz, "  ");
+            }
+        }
+    }
+}
+
+void render_tree_list(const proc_tree_t *tree, const proc_list_t *list,
+                      long hz, const viewport_t *vp, unsigned int term_cols) {
+    if (!tree || !list || hz <= 0 || vp->rows == 0) {
+        return;
+    }
+
+    print_process_header(term_cols);
+
+    // Only the rows up to the end of the window are walked
+    tree_iter_t it;
+    tree_iter_begin(tree, &it);
+    for (size_t row = 0; row < vp->first && it.node >= 0; row++) {
+        tree_iter_next(tree, &it);
+    }
+    for (size_t row = vp->first; row - vp->first < vp->rows && it.node >= 0;
+         row++) {
+        const tree_node_t *node = &tree->nodes[it.node];
+        proc_info_t p = list->procs[it.node];
+
+        char prefix[2 * TREE_MAX_INDENT + 4];
+        unsigned indent =
+            it.depth > TREE_MAX_INDENT ? TREE_MAX_INDENT : it.depth;
+        int off = snprintf(prefix, sizeof(prefix), "%*s", (int)indent * 2, "");
+        if (node->collapsed && node->descendants > 0) {
+            // A collapsed subtree is shown with its totals
+            snprintf(prefix + off, sizeof(prefix) - off, "+ ");
+            p.cpu_percent = node->subtree_cpu;
+            p.mem_percent = node->subtree_mem;
+            p.res_mem = node->subtree_res;
+        } else if (it.depth > 0) {
+            snprintf(prefix + off, sizeof(prefix) - off, "`- ");
+        }
+
+        print_row_style(row == vp->cursor, g_matches && g_matches[it.node]);
+        print_process_row(&p, hz, prefix);
+        printf(RESET);
+
+        tree_iter_next(tree, &it);
+    }
+}
+
+/**
+ * Prints a single interrupt source row.
+ *
+ * @param r The source to print.
+ * @param selected Non-zero to highlight the row.
+ */
+static void print_irq_row(const irq_rate_t *r, int selected) {
+    char rate[16], cpus[64] = "-";
+    fmt_scaled(r->rate, rate, sizeof(rate));
+
+    // "CPU:share" of the busiest CPUs, e.g. "12:93% 3:5%"
+    size_t len = 0;
+    for (size_t i = 0; i < r->ntop && len < sizeof(cpus); i++) {
+        len += (size_t)snprintf(cpus + len, sizeof(cpus) - len, "%s%d:%.0f%%",
+                                i > 0 ? " " : "", r->top[i].cpu,
+                                r->top[i].rate / r->rate * 100.0);
+    }
+
+    // The device is named at the end of the description; keep it
+    const irq_source_t *src = r->source;
+    const char *desc = src->desc;
+    size_t desc_len = strlen(desc);
+    if (desc_len > COMMAND_WIDTH) {
+        desc += desc_len - COMMAND_WIDTH;
+    }
+    printf("%s%-10.10s %-4s %8s %4zu %-32.32s %s" RESET "\n",
+           selected ? REVERSE : "", src->name, src->softirq ? "soft" : "hard",
+           rate, r->busy_cpus, cpus, desc);
+}
+
+void render_irq_list(const irq_view_t *view, const viewport_t *vp,
+                     unsigned int term_cols) {
+    if (!view || vp->rows == 0) {
+        return;
+    }
+
+    static const column_t cols[] = {
+        {"SOURCE", -10, SORT_BY_NONE}, {"TYPE", -4, SORT_BY_NONE},
+        {"RATE/s", 8, SORT_BY_NONE},   {"CPUS", 4, SORT_BY_NONE},
+        {"BUSIEST CPUS", -32, SORT_BY_NONE},
+        {"DESCRIPTION", -COMMAND_WIDTH, SORT_BY_NONE},
+    };
+    print_column_header(cols, (int)(sizeof(cols) / sizeof(cols[0])),
+                        term_cols);
+
+    size_t end = view->count;
+    if (vp->first < end && end - vp->first > vp->rows) {
+        end = vp->first + vp->rows;
+    }
+    for (size_t i = vp->first; i < end; i++) {
+        print_irq_row(&view->rates[i], i == vp->cursor);
     }
 }
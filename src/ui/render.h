@@ -1,29 +1,158 @@
 // src/ui/render.h
 #pragma once
+#include "../core/cgroup.h"
+#include "../core/grouping.h"
+#include "../core/iostat.h"
+#include "../core/irqstat.h"
+#include "../core/numa.h"
+#include "../core/proc_events.h"
 #include "../core/process.h"
+#include "../core/psi.h"
+#include "../core/refresh.h"
+#include "../core/sorting.h"
 #include "../core/system.h"
+#include "../core/tree.h"
+#include "../core/vmstat.h"
+#include "viewport.h"
+#include <stdbool.h>
+
+/**
+ * Optional groups of process list columns. They can be combined as a bit
+ * mask.
+ */
+typedef enum {
+    COLUMNS_IO = 1 << 0,      // READ/s, WRITE/s, RDOP/s, WROP/s
+    COLUMNS_HISTORY = 1 << 1, // Sparklines of recent %CPU and RES
+    COLUMNS_SMAPS = 1 << 2,   // PSS, USS, SWAP and how old they are
+    COLUMNS_EVENTS = 1 << 3,  // MINF/s, MAJF/s, VCSW/s, ICSW/s
+    COLUMNS_SCHED = 1 << 4,   // RUN%, WAIT%, SLC/s from schedstat
+    COLUMNS_NUMA = 1 << 5,    // Last CPU and its NUMA node
+    COLUMNS_STALE = 1 << 6,   // Age of values carried over (sampling)
+    COLUMNS_TOTALS = 1 << 7,  // CPU, I/O and faults since the baseline
+} column_group_t;
+
+/**
+ * @brief Shows or hides a group of optional process list columns.
+ *
+ * @param group The column group to toggle.
+ */
+void render_toggle_columns(column_group_t group);
+
+/**
+ * @brief Get the optional column groups currently shown.
+ * @return A bit mask of column_group_t values.
+ */
+unsigned render_get_columns(void);
+
+/**
+ * @brief Tells whether the process list shows the column of a sort key.
+ * @details Used as the column filter of sorting_next_column().
+ *
+ * @param column The sort key.
+ * @return true if a column sorted by it is shown.
+ */
+bool render_sort_column_shown(sort_by_t column);
+
+/**
+ * @brief Highlights the processes that match a search.
+ *
+ * @param matches One flag per entry of the process list passed to the next
+ *                renders (non-zero: highlighted), or NULL for none.
+ */
+void render_set_matches(const unsigned char *matches);
+
+/**
+ * Everything shown in the summary area above the process list. Optional
+ * sections are NULL when they are disabled or unavailable.
+ */
+typedef struct {
+    const cpu_percent_t *cpu;        // CPU usage
+    const mem_info_t *mem;           // Memory and swap
+    const load_avg_t *ld;            // Load averages
+    const uptime_fmt_t *up;          // System uptime
+    int users;                       // Number of logged-in users
+    const task_counts_t *tc;         // Task counts
+    const cgroup_view_t *cg;         // Cgroup-scoped view (replaces CPU/memory)
+    const psi_stats_t *psi;          // Pressure Stall Information averages
+    const psi_percent_t *psi_now;    // Pressure since the previous frame
+    const vmstat_rate_t *vm;         // Paging and reclaim rates
+    const refresh_t *refresh;        // Adaptive refresh state
+    const proc_sampling_t *sample;   // What sampling mode read
+    const proc_cumulative_t *totals; // Cumulative mode totals
+    const numa_view_t *numa;         // Per-node CPU and memory (NULL: 1 node)
+    const proc_events_t *events;     // Process lifecycle since the last frame
+    const disk_view_t *disks;        // Busiest block devices
+    const net_view_t *net;           // Busiest network interfaces
+    const irq_view_t *irqs;          // Interrupt view: busiest CPUs
+    const char *search;              // Search text (NULL: no search)
+    size_t search_matches;           // Processes matching the search
+    int search_editing;              // The search text is being typed
+} header_data_t;
 
 /**
  * @brief Renders the header information for the system status.
  *
- * @param cpu A pointer to a cpu_percent_t structure containing CPU usage data.
- * @param mem A pointer to a mem_info_t structure containing memory data.
- * @param ld A pointer to a load_avg_t structure containing load averages.
- * @param up A pointer to an uptime_fmt_t structure containing system uptime.
- * @param users The number of users currently logged in.
- * @param tc A pointer to a task_counts_t structure containing task counts.
+ * @param h A pointer to a header_data_t structure with the data to show.
+ * @return The number of lines printed.
  */
-void render_header(const cpu_percent_t *cpu, const mem_info_t *mem,
-                   const load_avg_t *ld, const uptime_fmt_t *up, int users,
-                   const task_counts_t *tc);
+unsigned render_header(const header_data_t *h);
+
+/**
+ * @brief Renders the recent history of one process (%CPU, RES and I/O rate
+ * sparklines with their minimum, average and maximum).
+ *
+ * @param p The process to describe.
+ * @return The number of lines printed.
+ */
+unsigned render_history_panel(const proc_info_t *p);
 
 /**
  * @brief Renders the current process information for the main contents.
  *
  * @param list A pointer to a proc_list_t structure containing a process list.
  * @param hz The system clock frequency in Hertz.
- * @param max_rows The maximum number of rows to display in the terminal.
+ * @param vp The window of rows to display and the selected row (highlighted).
  * @param term_cols The number of columns available in the terminal.
  */
 void render_process_list(const proc_list_t *list, long hz,
-                         unsigned int max_rows, unsigned int term_cols);
+                         const viewport_t *vp, unsigned int term_cols);
+
+/**
+ * @brief Renders one row per cgroup, with the member processes of expanded
+ * groups listed below their group.
+ *
+ * @param groups A pointer to the (sorted) group_list_t to render.
+ * @param list A pointer to the (sorted) proc_list_t the groups were built
+ *             from.
+ * @param hz The system clock frequency in Hertz.
+ * @param vp The window of rows to display (counting member rows); its cursor
+ *           is the index of the selected group (highlighted).
+ * @param term_cols The number of columns available in the terminal.
+ */
+void render_group_list(const group_list_t *groups, const proc_list_t *list,
+                       long hz, const viewport_t *vp, unsigned int term_cols);
+
+/**
+ * @brief Renders the processes as a forest, children indented below their
+ * parent. Collapsed subtrees show their aggregated %CPU, %MEM and RES.
+ *
+ * @param tree A pointer to the proc_tree_t built from the list.
+ * @param list A pointer to the (sorted) proc_list_t.
+ * @param hz The system clock frequency in Hertz.
+ * @param vp The window of visible rows to display and the selected row
+ *           (highlighted).
+ * @param term_cols The number of columns available in the terminal.
+ */
+void render_tree_list(const proc_tree_t *tree, const proc_list_t *list,
+                      long hz, const viewport_t *vp, unsigned int term_cols);
+
+/**
+ * @brief Renders one row per interrupt source, busiest first, with the CPUs
+ * it lands on.
+ *
+ * @param view A pointer to the irq_view_t to render.
+ * @param vp The window of rows to display and the selected row (highlighted).
+ * @param term_cols The number of columns available in the terminal.
+ */
+void render_irq_list(const irq_view_t *view, const viewport_t *vp,
+                     unsigned int term_cols);
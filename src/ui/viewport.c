@@ -0,0 +1,34 @@
+// src/ui/viewport.c
+#include "viewport.h"
+
+void viewport_move(viewport_t *vp, long delta, size_t total) {
+    if (total == 0) {
+        vp->cursor = 0;
+        return;
+    }
+
+    if (delta < 0 && (size_t)-delta > vp->cursor) {
+        vp->cursor = 0;
+    } else if (delta > 0 && (size_t)delta >= total - vp->cursor) {
+        vp->cursor = total - 1;
+    } else {
+        vp->cursor = (size_t)((long)vp->cursor + delta);
+    }
+}
+
+void viewport_show(viewport_t *vp, size_t row, size_t total) {
+    if (vp->rows == 0) {
+        vp->first = 0;
+        return;
+    }
+
+    if (row < vp->first) {
+        vp->first = row;
+    } else if (row >= vp->first + vp->rows) {
+        vp->first = row - vp->rows + 1;
+    }
+
+    if (vp->first + vp->rows > total) {
+        vp->first = total > vp->rows ? total - vp->rows : 0;
+    }
+}
@@ -0,0 +1,32 @@
+// src/ui/viewport.h
+#pragma once
+#include <stddef.h>
+
+/**
+ * The window of rows of a list that is on the screen, and the selected row.
+ */
+typedef struct {
+    size_t first;  // First row on the screen
+    size_t cursor; // Selected row
+    unsigned rows; // Number of rows that fit on the screen
+} viewport_t;
+
+/**
+ * @brief Moves the cursor by a number of rows, stopping at either end.
+ *
+ * @param vp Pointer to the viewport.
+ * @param delta Rows to move (negative moves up).
+ * @param total Number of selectable rows.
+ */
+void viewport_move(viewport_t *vp, long delta, size_t total);
+
+/**
+ * @brief Scrolls the window so that a row is on the screen.
+ * @details The window is also pulled back if it reaches past the end of the
+ *          list, so a shrinking list doesn't leave empty rows.
+ *
+ * @param vp Pointer to the viewport.
+ * @param row The row to show, usually the one of the cursor.
+ * @param total Number of rows in the list.
+ */
+void viewport_show(viewport_t *vp, size_t row, size_t total);
@@ -1,9 +1,11 @@
 // src/util/util.c
 #include "util.h"
+#include <fcntl.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 bool read_text_file(const char *path, // [in]
@@ -117,3 +119,49 @@ long sys_hz(void) {
     }
     return hz;
 }
+
+long sys_ncpu(void) {
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu < 0) {
+        // Handle error if needed
+        return -1;
+    }
+    return ncpu;
+}
+
+double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+long read_file_at(int *fd, const char *path, char *buf, size_t size) {
+    if (*fd < 0) {
+        *fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (*fd < 0) {
+            return -1;
+        }
+    }
+
+    // procfs may return less than asked for, one record at a time
+    size_t used = 0;
+    while (used < size - 1) {
+        ssize_t n = pread(*fd, buf + used, size - 1 - used, (off_t)used);
+        if (n < 0) {
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        used += (size_t)n;
+    }
+
+    // Don't hand out half a line of a file that didn't fit
+    if (used == size - 1) {
+        while (used > 0 && buf[used - 1] != '\n') {
+            used--;
+        }
+    }
+    buf[used] = '\0';
+    return (long)used;
+}
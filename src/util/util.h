@@ -41,3 +41,34 @@ long sys_pagesize(void);
  * @return The number of clock ticks per second, or -1 on error.
  */
 long sys_hz(void);
+
+/**
+ * @brief Get the number of online CPUs
+ *
+ * @return The number of online CPUs, or -1 on error.
+ */
+long sys_ncpu(void);
+
+/**
+ * @brief Get the current time from a monotonic clock
+ * @details Suitable for measuring intervals; unaffected by wall clock changes.
+ *
+ * @return The monotonic time in seconds.
+ */
+double monotonic_seconds(void);
+
+/**
+ * @brief Reads a (proc) file through a file descriptor that stays open.
+ * @details The file is opened on the first call and read again from offset
+ * 0 with pread() after that, which makes the kernel regenerate a procfs
+ * file without an open()/close() pair or any allocation. The buffer is
+ * null-terminated; if the file doesn't fit, it is cut after the last
+ * complete line.
+ *
+ * @param fd Pointer to the cached descriptor (initialize it to -1).
+ * @param path The path to open on the first call.
+ * @param buf The buffer to read into.
+ * @param size Size of buf.
+ * @return The number of bytes in buf, or -1 on failure.
+ */
+long read_file_at(int *fd, const char *path, char *buf, size_t size);